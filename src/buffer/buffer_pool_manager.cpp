@@ -1,31 +1,62 @@
 #include "buffer/buffer_pool_manager.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <vector>
+
 #include "glog/logging.h"
 #include "page/bitmap_page.h"
 
 static const char EMPTY_PAGE_DATA[PAGE_SIZE] = {0};
 
-BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager)
+BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager, ReplacerType replacer_type)
     : pool_size_(pool_size), disk_manager_(disk_manager) {
-  pages_ = new Page[pool_size_];
-  replacer_ = new LRUReplacer(pool_size_);
+  frame_arena_ = new FrameArena(pool_size_);
+  // the frames are constructed in place, since each of them needs its slot of the arena
+  pages_ = static_cast<Page *>(::operator new(sizeof(Page) * pool_size_));
+  for (size_t i = 0; i < pool_size_; i++) {
+    new (&pages_[i]) Page(frame_arena_->GetFrame(i));
+  }
+  switch (replacer_type) {
+    case ReplacerType::LRU_REPLACER:
+      replacer_ = new LRUReplacer(pool_size_);
+      break;
+    case ReplacerType::CLOCK_REPLACER:
+      replacer_ = new CLOCKReplacer(pool_size_);
+      break;
+    case ReplacerType::LRU_K_REPLACER:
+      replacer_ = new LRUKReplacer(pool_size_);
+      break;
+    case ReplacerType::TWO_QUEUE_REPLACER:
+      replacer_ = new TwoQueueReplacer(pool_size_);
+      break;
+  }
   for (size_t i = 0; i < pool_size_; i++) {
     free_list_.emplace_back(i);
   }
 }
 
+BufferPoolManager::BufferPoolManager(DiskManager *disk_manager)
+    : pool_size_(0), frame_arena_(nullptr), pages_(nullptr), disk_manager_(disk_manager), replacer_(nullptr) {}
+
 BufferPoolManager::~BufferPoolManager() {
-  for (auto page : page_table_) {
-    FlushPage(page.first);
+  StopPrefetcher();
+  StopPageCleaner();
+  FlushAllPages();
+  for (size_t i = 0; i < pool_size_; i++) {
+    pages_[i].~Page();
   }
-  delete[] pages_;
+  ::operator delete(pages_);
+  delete frame_arena_;
   delete replacer_;
 }
 
 /**
  * TODO: Student Implement
  */
-Page *BufferPoolManager::FetchPage(page_id_t page_id) {
+Page *BufferPoolManager::FetchPage(page_id_t page_id, AccessType access_type) {
   // 1.     Search the page table for the requested page (P).
   // 1.1    If P exists, pin it and return it immediately.
   // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
@@ -33,32 +64,26 @@ Page *BufferPoolManager::FetchPage(page_id_t page_id) {
   // 2.     If R is dirty, write it back to the disk.
   // 3.     Delete R from the page table and insert P.
   // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
-  if(page_table_.find(page_id) != page_table_.end()) {
-    pages_[page_table_[page_id]].pin_count_++;
-    replacer_->Pin(page_table_[page_id]);
-    return &pages_[page_table_[page_id]];
-  } else {
-    frame_id_t R;
-    if(free_list_.size()) {
-      R = free_list_.front();
-      free_list_.pop_front();
-    } else {
-      if(!replacer_->Victim(&R)) {
-        return nullptr;
-      }
-    }
-    if(pages_[R].IsDirty()) {
-      disk_manager_->WritePage(pages_[R].GetPageId(), pages_[R].GetData());
-    }
-    page_table_.erase(pages_[R].page_id_);
-    //page_table_.insert(pair<page_id_t, frame_id_t>(page_id, R));
-    page_table_[page_id] = R;
-    pages_[R].page_id_ = page_id;
-    pages_[R].pin_count_ = 1;
-    pages_[R].is_dirty_ = false;
-    disk_manager_->ReadPage(page_id, pages_[R].GetData());
-    return &pages_[R];
+  scoped_lock<recursive_mutex> lock(latch_);
+  auto iter = page_table_.find(page_id);
+  if (iter != page_table_.end()) {
+    pages_[iter->second].pin_count_++;
+    replacer_->RecordAccess(iter->second, access_type);
+    replacer_->Pin(iter->second);
+    return &pages_[iter->second];
   }
+  frame_id_t R;
+  if (!TryToFindFreePage(R)) {
+    return nullptr;
+  }
+  page_table_[page_id] = R;
+  pages_[R].page_id_ = page_id;
+  pages_[R].pin_count_ = 1;
+  pages_[R].is_dirty_ = false;
+  replacer_->RecordAccess(R, access_type);
+  replacer_->Pin(R);
+  disk_manager_->ReadPage(page_id, pages_[R].GetData());
+  return &pages_[R];
 }
 
 /**
@@ -70,34 +95,56 @@ Page *BufferPoolManager::NewPage(page_id_t &page_id) {
   // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
   // 3.   Update P's metadata, zero out memory and add P to the page table.
   // 4.   Set the page ID output parameter. Return a pointer to P.
-  if(free_list_.empty() && !replacer_->Size()) {
+  scoped_lock<recursive_mutex> lock(latch_);
+  frame_id_t P;
+  if (!TryToFindFreePage(P)) {
     return nullptr;
   }
+  page_id = AllocatePage();
+  pages_[P].ResetMemory();
+  page_table_[page_id] = P;
+  pages_[P].page_id_ = page_id;
+  pages_[P].pin_count_ = 1;
+  pages_[P].is_dirty_ = false;
+  replacer_->RecordAccess(P);
+  replacer_->Pin(P);
+  return &pages_[P];
+}
+
+Page *BufferPoolManager::NewPageFrame(page_id_t page_id) {
+  scoped_lock<recursive_mutex> lock(latch_);
   frame_id_t P;
-  if(free_list_.size()) {
-    page_id = AllocatePage();
-    P = free_list_.front();
-    free_list_.pop_front();
-  } else {
-    bool flag = replacer_->Victim(&P);
-    if(!flag) {
-      return nullptr;
-    }
-    page_id = AllocatePage();
-    if(pages_[P].IsDirty()) {
-      disk_manager_->WritePage(pages_[P].GetPageId(), pages_[P].GetData());
-    }
-    page_table_.erase(pages_[P].page_id_);
+  if (!TryToFindFreePage(P)) {
+    return nullptr;
   }
-  //page_id = AllocatePage();
   pages_[P].ResetMemory();
   page_table_[page_id] = P;
   pages_[P].page_id_ = page_id;
   pages_[P].pin_count_ = 1;
   pages_[P].is_dirty_ = false;
- 
+  replacer_->RecordAccess(P);
+  replacer_->Pin(P);
   return &pages_[P];
-  
+}
+
+bool BufferPoolManager::TryToFindFreePage(frame_id_t &frame_id) {
+  if (!free_list_.empty()) {
+    frame_id = free_list_.front();
+    free_list_.pop_front();
+    return true;
+  }
+  if (!replacer_->Victim(&frame_id)) {
+    return false;
+  }
+  if (pages_[frame_id].IsDirty()) {
+    // the page cleaner is falling behind
+    if (cleaner_running_) {
+      cleaner_cv_.notify_one();
+    }
+    disk_manager_->WritePage(pages_[frame_id].GetPageId(), pages_[frame_id].GetData());
+  }
+  page_table_.erase(pages_[frame_id].page_id_);
+  return true;
 }
 
 /**
@@ -109,7 +156,10 @@ bool BufferPoolManager::DeletePage(page_id_t page_id) {
   // 1.   If P does not exist, return true.
   // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
   // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
+  scoped_lock<recursive_mutex> lock(latch_);
   if(page_table_.find(page_id) == page_table_.end()) {
+    // the page is not buffered, it is still returned to the disk manager
+    this->DeallocatePage(page_id);
     return true;
   }
   frame_id_t P = page_table_[page_id];
@@ -117,28 +167,45 @@ bool BufferPoolManager::DeletePage(page_id_t page_id) {
     return false;
   }
   page_table_.erase(page_id);
-  pages_[P].ResetMemory();
-  pages_[P].page_id_ = INVALID_PAGE_ID;
-  pages_[P].pin_count_ = 0;
-  pages_[P].is_dirty_ = false;
-  free_list_.push_back(P);
-  this->DeallocatePage(page_id);
+  if (pages_[P].being_cleaned_) {
+    // the page cleaner frees the frame once its write completes, so that the page is not reallocated before
+    pages_[P].delete_pending_ = true;
+    return true;
+  }
+  FreeFrame(P);
   return true;
 }
 
+void BufferPoolManager::FreeFrame(frame_id_t frame_id) {
+  page_id_t page_id = pages_[frame_id].page_id_;
+  replacer_->Remove(frame_id);
+  pages_[frame_id].ResetMemory();
+  pages_[frame_id].page_id_ = INVALID_PAGE_ID;
+  pages_[frame_id].pin_count_ = 0;
+  pages_[frame_id].is_dirty_ = false;
+  pages_[frame_id].delete_pending_ = false;
+  free_list_.push_back(frame_id);
+  this->DeallocatePage(page_id);
+}
+
 /**
  * TODO: Student Implement
  */
 bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
+  scoped_lock<recursive_mutex> lock(latch_);
   if(page_table_.find(page_id) == page_table_.end()) {
     return false;
   }
   frame_id_t P = page_table_[page_id];
+  if(pages_[P].pin_count_ <= 0) {
+    return false;
+  }
   pages_[P].pin_count_--;
   if(is_dirty) {
     pages_[P].is_dirty_ = true;
   }
-  if(pages_[P].pin_count_ == 0) {
+  // a page being cleaned stays unevictable until the cleaner is done with it
+  if(pages_[P].pin_count_ == 0 && !pages_[P].being_cleaned_) {
     replacer_->Unpin(P);
   }
   return true;
@@ -148,6 +215,7 @@ bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
  * TODO: Student Implement
  */
 bool BufferPoolManager::FlushPage(page_id_t page_id) {
+  scoped_lock<recursive_mutex> lock(latch_);
   if(page_table_.find(page_id) == page_table_.end()) {
     return false;
   }
@@ -170,8 +238,55 @@ bool BufferPoolManager::IsPageFree(page_id_t page_id) {
   return disk_manager_->IsPageFree(page_id);
 }
 
+void BufferPoolManager::FlushAllPages() {
+  scoped_lock<recursive_mutex> lock(latch_);
+  vector<pair<page_id_t, frame_id_t>> pages(page_table_.begin(), page_table_.end());
+  sort(pages.begin(), pages.end());
+  vector<IOHandle> handles;
+  for (auto &page : pages) {
+    handles.push_back(disk_manager_->WritePageAsync(page.first, pages_[page.second].GetData()));
+  }
+  for (size_t i = 0; i < pages.size(); i++) {
+    if (!handles[i].Wait()) {
+      disk_manager_->WritePage(pages[i].first, pages_[pages[i].second].GetData());
+    }
+    pages_[pages[i].second].is_dirty_ = false;
+  }
+}
+
+void BufferPoolManager::LoadPages(const vector<page_id_t> &page_ids) {
+  scoped_lock<recursive_mutex> lock(latch_);
+  vector<pair<frame_id_t, IOHandle>> loads;
+  for (auto page_id : page_ids) {
+    if (page_table_.find(page_id) != page_table_.end()) {
+      continue;
+    }
+    frame_id_t R;
+    if (!TryToFindFreePage(R)) {
+      break;
+    }
+    // pinned until its read completes, so that the rest of the batch cannot evict it
+    page_table_[page_id] = R;
+    pages_[R].page_id_ = page_id;
+    pages_[R].pin_count_ = 1;
+    pages_[R].is_dirty_ = false;
+    replacer_->RecordAccess(R, AccessType::SCAN_ACCESS);
+    replacer_->Pin(R);
+    loads.emplace_back(R, disk_manager_->ReadPageAsync(page_id, pages_[R].GetData()));
+  }
+  for (auto &load : loads) {
+    frame_id_t R = load.first;
+    if (!load.second.Wait()) {
+      disk_manager_->ReadPage(pages_[R].page_id_, pages_[R].GetData());
+    }
+    pages_[R].pin_count_ = 0;
+    replacer_->Unpin(R);
+  }
+}
+
 // Only used for debug
 bool BufferPoolManager::CheckAllUnpinned() {
+  scoped_lock<recursive_mutex> lock(latch_);
   bool res = true;
   for (size_t i = 0; i < pool_size_; i++) {
     if (pages_[i].pin_count_ != 0) {
@@ -180,4 +295,174 @@ bool BufferPoolManager::CheckAllUnpinned() {
     }
   }
   return res;
-}
\ No newline at end of file
+}
+
+void BufferPoolManager::StartPageCleaner(double clean_ratio) {
+  scoped_lock<recursive_mutex> lock(latch_);
+  if (cleaner_running_) {
+    return;
+  }
+  clean_ratio_ = clean_ratio;
+  cleaner_running_ = true;
+  cleaner_thread_ = thread(&BufferPoolManager::PageCleanerLoop, this);
+}
+
+void BufferPoolManager::StopPageCleaner() {
+  {
+    scoped_lock<recursive_mutex> lock(latch_);
+    if (!cleaner_running_) {
+      return;
+    }
+    cleaner_running_ = false;
+  }
+  cleaner_cv_.notify_all();
+  cleaner_thread_.join();
+}
+
+void BufferPoolManager::PageCleanerLoop() {
+  while (cleaner_running_) {
+    {
+      unique_lock<recursive_mutex> lock(latch_);
+      cleaner_cv_.wait_for(lock, chrono::milliseconds(PAGE_CLEANER_INTERVAL_MS));
+    }
+    if (cleaner_running_) {
+      CleanPages();
+    }
+  }
+}
+
+void BufferPoolManager::CleanPages() {
+  vector<frame_id_t> batch;
+  {
+    scoped_lock<recursive_mutex> lock(latch_);
+    size_t unpinned = 0;
+    for (size_t i = 0; i < pool_size_; i++) {
+      if (pages_[i].page_id_ == INVALID_PAGE_ID || pages_[i].pin_count_ != 0) {
+        continue;
+      }
+      unpinned++;
+      if (pages_[i].is_dirty_) {
+        batch.push_back(i);
+      }
+    }
+    auto clean_target = static_cast<size_t>(clean_ratio_ * unpinned);
+    size_t clean = unpinned - batch.size();
+    if (clean >= clean_target) {
+      return;
+    }
+    batch.resize(min(batch.size(), min(clean_target - clean, static_cast<size_t>(PAGE_CLEANER_BATCH_SIZE))));
+    sort(batch.begin(), batch.end(), [this](frame_id_t a, frame_id_t b) {
+      return pages_[a].page_id_ < pages_[b].page_id_;
+    });
+    // the page is marked clean before it is written, so a modification made meanwhile marks it dirty again
+    for (auto frame_id : batch) {
+      pages_[frame_id].being_cleaned_ = true;
+      replacer_->Pin(frame_id);
+      pages_[frame_id].is_dirty_ = false;
+    }
+  }
+  // the whole batch is queued at once, from copies of the pages
+  vector<char> copies(batch.size() * PAGE_SIZE);
+  vector<IOHandle> handles;
+  for (size_t i = 0; i < batch.size(); i++) {
+    char *copy = copies.data() + i * PAGE_SIZE;
+    pages_[batch[i]].RLatch();
+    memcpy(copy, pages_[batch[i]].GetData(), PAGE_SIZE);
+    pages_[batch[i]].RUnlatch();
+    handles.push_back(disk_manager_->WritePageAsync(pages_[batch[i]].page_id_, copy));
+  }
+  for (size_t i = 0; i < batch.size(); i++) {
+    if (!handles[i].Wait()) {
+      disk_manager_->WritePage(pages_[batch[i]].page_id_, copies.data() + i * PAGE_SIZE);
+    }
+  }
+  scoped_lock<recursive_mutex> lock(latch_);
+  for (auto frame_id : batch) {
+    pages_[frame_id].being_cleaned_ = false;
+    if (pages_[frame_id].delete_pending_) {
+      FreeFrame(frame_id);
+    } else if (pages_[frame_id].pin_count_ == 0) {
+      replacer_->Unpin(frame_id);
+    }
+  }
+}
+
+void BufferPoolManager::Prefetch(const vector<page_id_t> &page_ids) {
+  PrefetchRequest request;
+  request.page_ids_ = page_ids;
+  EnqueuePrefetch(std::move(request));
+}
+
+void BufferPoolManager::PrefetchChain(page_id_t first_page_id, size_t num_pages,
+                                      function<page_id_t(Page *)> next_page) {
+  if (first_page_id == INVALID_PAGE_ID || num_pages == 0) {
+    return;
+  }
+  PrefetchRequest request;
+  request.page_ids_.push_back(first_page_id);
+  request.chain_length_ = num_pages;
+  request.next_page_ = std::move(next_page);
+  EnqueuePrefetch(std::move(request));
+}
+
+void BufferPoolManager::StopPrefetcher() {
+  {
+    scoped_lock<mutex> lock(prefetch_latch_);
+    if (!prefetcher_running_) {
+      return;
+    }
+    prefetcher_running_ = false;
+  }
+  prefetch_cv_.notify_all();
+  prefetch_thread_.join();
+}
+
+void BufferPoolManager::EnqueuePrefetch(PrefetchRequest &&request) {
+  {
+    scoped_lock<mutex> lock(prefetch_latch_);
+    if (prefetch_queue_.size() >= static_cast<size_t>(PREFETCH_QUEUE_SIZE)) {
+      return;
+    }
+    prefetch_queue_.emplace_back(std::move(request));
+    if (!prefetcher_running_) {
+      prefetcher_running_ = true;
+      prefetch_thread_ = thread(&BufferPoolManager::PrefetchLoop, this);
+    }
+  }
+  prefetch_cv_.notify_one();
+}
+
+/**
+ * Prefetched pages are recorded as scan accesses, since nobody has asked for them yet. A request stops early once
+ * the pool has no frame left to hold its pages.
+ */
+void BufferPoolManager::PrefetchLoop() {
+  while (true) {
+    PrefetchRequest request;
+    {
+      unique_lock<mutex> lock(prefetch_latch_);
+      prefetch_cv_.wait(lock, [this] { return !prefetcher_running_ || !prefetch_queue_.empty(); });
+      if (prefetch_queue_.empty()) {
+        return;
+      }
+      request = std::move(prefetch_queue_.front());
+      prefetch_queue_.pop_front();
+    }
+    if (!request.next_page_) {
+      LoadPages(request.page_ids_);
+      continue;
+    }
+    page_id_t page_id = request.page_ids_.front();
+    for (size_t i = 0; i < request.chain_length_ && page_id != INVALID_PAGE_ID; i++) {
+      Page *page = FetchPage(page_id, AccessType::SCAN_ACCESS);
+      if (page == nullptr) {
+        break;
+      }
+      page->RLatch();
+      page_id_t next_page_id = request.next_page_(page);
+      page->RUnlatch();
+      UnpinPage(page_id, false);
+      page_id = next_page_id;
+    }
+  }
+}
@@ -0,0 +1,38 @@
+#include "buffer/frame_arena.h"
+
+#include <sys/mman.h>
+
+#include <new>
+
+#include "glog/logging.h"
+
+static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+FrameArena::FrameArena(size_t num_frames, bool use_huge_pages) : size_(num_frames * PAGE_SIZE) {
+  if (size_ == 0) {
+    return;
+  }
+  void *base = MAP_FAILED;
+  if (use_huge_pages && size_ % HUGE_PAGE_SIZE == 0) {
+    // only works if huge pages are reserved, which is why the regular mapping below is the usual case
+    base = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    huge_pages_ = base != MAP_FAILED;
+  }
+  if (base == MAP_FAILED) {
+    base = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+      LOG(ERROR) << "Failed to map " << size_ << " bytes for the buffer pool";
+      throw std::bad_alloc();
+    }
+    if (use_huge_pages && size_ >= HUGE_PAGE_SIZE) {
+      huge_pages_ = madvise(base, size_, MADV_HUGEPAGE) == 0;
+    }
+  }
+  base_ = reinterpret_cast<char *>(base);
+}
+
+FrameArena::~FrameArena() {
+  if (base_ != nullptr) {
+    munmap(base_, size_);
+  }
+}
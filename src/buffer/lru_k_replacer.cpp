@@ -0,0 +1,111 @@
+#include "buffer/lru_k_replacer.h"
+
+#include "common/macros.h"
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k) : k_(k), frames_(num_pages) {
+  ASSERT(k_ > 0, "LRU-K needs to remember at least one access.");
+}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+/**
+ * Frames with an infinite backward k-distance come first. Pinned frames stay in the lists so that their history
+ * survives, they are only skipped here.
+ */
+bool LRUKReplacer::Victim(frame_id_t *frame_id) {
+  if (evictable_size_ == 0) {
+    return false;
+  }
+  for (auto *candidates : {&history_list_, &cache_list_}) {
+    for (auto frame : *candidates) {
+      if (frames_[frame].evictable_) {
+        *frame_id = frame;
+        Remove(frame);
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  FrameInfo &info = frames_[frame_id];
+  if (info.tracked_ && info.evictable_) {
+    info.evictable_ = false;
+    evictable_size_--;
+  }
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  FrameInfo &info = frames_[frame_id];
+  if (!info.tracked_) {
+    RecordAccess(frame_id);
+  }
+  if (!info.evictable_) {
+    info.evictable_ = true;
+    evictable_size_++;
+  }
+}
+
+size_t LRUKReplacer::Size() {
+  return evictable_size_;
+}
+
+void LRUKReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type) {
+  ASSERT(static_cast<size_t>(frame_id) < frames_.size(), "Invalid frame id.");
+  FrameInfo &info = frames_[frame_id];
+  if (info.tracked_ && access_type == AccessType::SCAN_ACCESS) {
+    return;
+  }
+  current_timestamp_++;
+  if (!info.tracked_) {
+    info.tracked_ = true;
+    info.history_.push_back(current_timestamp_);
+    if (InHistory(info)) {
+      // the earliest access of a new frame is the latest one among all the frames
+      info.position_ = history_list_.insert(history_list_.end(), frame_id);
+    } else {
+      InsertIntoCache(frame_id);
+    }
+    return;
+  }
+  if (InHistory(info)) {
+    info.history_.push_back(current_timestamp_);
+    if (!InHistory(info)) {
+      history_list_.erase(info.position_);
+      InsertIntoCache(frame_id);
+    }
+    return;
+  }
+  info.history_.pop_front();
+  info.history_.push_back(current_timestamp_);
+  cache_list_.erase(info.position_);
+  InsertIntoCache(frame_id);
+}
+
+void LRUKReplacer::Remove(frame_id_t frame_id) {
+  FrameInfo &info = frames_[frame_id];
+  if (!info.tracked_) {
+    return;
+  }
+  if (InHistory(info)) {
+    history_list_.erase(info.position_);
+  } else {
+    cache_list_.erase(info.position_);
+  }
+  if (info.evictable_) {
+    evictable_size_--;
+  }
+  info.history_.clear();
+  info.tracked_ = false;
+  info.evictable_ = false;
+}
+
+void LRUKReplacer::InsertIntoCache(frame_id_t frame_id) {
+  size_t kth_access = frames_[frame_id].history_.front();
+  auto iter = cache_list_.end();
+  while (iter != cache_list_.begin() && frames_[*prev(iter)].history_.front() > kth_access) {
+    iter--;
+  }
+  frames_[frame_id].position_ = cache_list_.insert(iter, frame_id);
+}
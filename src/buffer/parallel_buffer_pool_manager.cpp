@@ -0,0 +1,107 @@
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include "glog/logging.h"
+
+ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size,
+                                                     DiskManager *disk_manager, ReplacerType replacer_type)
+    : BufferPoolManager(disk_manager) {
+  ASSERT(num_instances > 0, "Buffer pool needs at least one instance.");
+  size_t instance_size = pool_size / num_instances;
+  for (size_t i = 0; i < num_instances; i++) {
+    // the first instances take the remaining frames
+    size_t extra = i < pool_size % num_instances ? 1 : 0;
+    instances_.emplace_back(new BufferPoolManager(instance_size + extra, disk_manager, replacer_type));
+  }
+}
+
+ParallelBufferPoolManager::~ParallelBufferPoolManager() {
+  // the prefetcher reads through the instances
+  StopPrefetcher();
+  for (auto instance : instances_) {
+    delete instance;
+  }
+}
+
+Page *ParallelBufferPoolManager::FetchPage(page_id_t page_id, AccessType access_type) {
+  return GetInstance(page_id)->FetchPage(page_id, access_type);
+}
+
+bool ParallelBufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
+  return GetInstance(page_id)->UnpinPage(page_id, is_dirty);
+}
+
+bool ParallelBufferPoolManager::FlushPage(page_id_t page_id) {
+  return GetInstance(page_id)->FlushPage(page_id);
+}
+
+/**
+ * The page id decides which instance caches the page, so the page is allocated on disk first and handed to its
+ * instance afterwards. If that instance has every frame pinned, the allocation is rolled back.
+ */
+Page *ParallelBufferPoolManager::NewPage(page_id_t &page_id) {
+  page_id_t new_page_id = AllocatePage();
+  if (new_page_id == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+  Page *page = GetInstance(new_page_id)->NewPageFrame(new_page_id);
+  if (page == nullptr) {
+    DeallocatePage(new_page_id);
+    return nullptr;
+  }
+  page_id = new_page_id;
+  return page;
+}
+
+bool ParallelBufferPoolManager::DeletePage(page_id_t page_id) {
+  return GetInstance(page_id)->DeletePage(page_id);
+}
+
+bool ParallelBufferPoolManager::IsPageFree(page_id_t page_id) {
+  return GetInstance(page_id)->IsPageFree(page_id);
+}
+
+bool ParallelBufferPoolManager::CheckAllUnpinned() {
+  bool res = true;
+  for (auto instance : instances_) {
+    res = instance->CheckAllUnpinned() && res;
+  }
+  return res;
+}
+
+void ParallelBufferPoolManager::FlushAllPages() {
+  for (auto instance : instances_) {
+    instance->FlushAllPages();
+  }
+}
+
+void ParallelBufferPoolManager::LoadPages(const vector<page_id_t> &page_ids) {
+  std::vector<std::vector<page_id_t>> shares(instances_.size());
+  for (auto page_id : page_ids) {
+    shares[page_id % instances_.size()].push_back(page_id);
+  }
+  for (size_t i = 0; i < instances_.size(); i++) {
+    if (!shares[i].empty()) {
+      instances_[i]->LoadPages(shares[i]);
+    }
+  }
+}
+
+size_t ParallelBufferPoolManager::GetPoolSize() {
+  size_t pool_size = 0;
+  for (auto instance : instances_) {
+    pool_size += instance->GetPoolSize();
+  }
+  return pool_size;
+}
+
+void ParallelBufferPoolManager::StartPageCleaner(double clean_ratio) {
+  for (auto instance : instances_) {
+    instance->StartPageCleaner(clean_ratio);
+  }
+}
+
+void ParallelBufferPoolManager::StopPageCleaner() {
+  for (auto instance : instances_) {
+    instance->StopPageCleaner();
+  }
+}
@@ -0,0 +1,109 @@
+#include "buffer/two_queue_replacer.h"
+
+#include "common/macros.h"
+
+TwoQueueReplacer::TwoQueueReplacer(size_t num_pages, double a1_ratio)
+    : a1_capacity_(static_cast<size_t>(num_pages * a1_ratio)), frames_(num_pages) {}
+
+TwoQueueReplacer::~TwoQueueReplacer() = default;
+
+bool TwoQueueReplacer::Victim(frame_id_t *frame_id) {
+  if (evictable_size_ == 0) {
+    return false;
+  }
+  if (VictimFrom(QueueType::SCAN_QUEUE, frame_id)) {
+    return true;
+  }
+  if (a1_queue_.size() > a1_capacity_ && VictimFrom(QueueType::A1_QUEUE, frame_id)) {
+    return true;
+  }
+  return VictimFrom(QueueType::AM_QUEUE, frame_id) || VictimFrom(QueueType::A1_QUEUE, frame_id);
+}
+
+void TwoQueueReplacer::Pin(frame_id_t frame_id) {
+  FrameInfo &info = frames_[frame_id];
+  if (info.queue_ != QueueType::NONE && info.evictable_) {
+    info.evictable_ = false;
+    evictable_size_--;
+  }
+}
+
+void TwoQueueReplacer::Unpin(frame_id_t frame_id) {
+  FrameInfo &info = frames_[frame_id];
+  if (info.queue_ == QueueType::NONE) {
+    RecordAccess(frame_id);
+  }
+  if (!info.evictable_) {
+    info.evictable_ = true;
+    evictable_size_++;
+  }
+}
+
+size_t TwoQueueReplacer::Size() {
+  return evictable_size_;
+}
+
+void TwoQueueReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type) {
+  ASSERT(static_cast<size_t>(frame_id) < frames_.size(), "Invalid frame id.");
+  switch (frames_[frame_id].queue_) {
+    case QueueType::NONE:
+      MoveTo(frame_id, access_type == AccessType::SCAN_ACCESS ? QueueType::SCAN_QUEUE : QueueType::A1_QUEUE);
+      break;
+    case QueueType::SCAN_QUEUE:
+      if (access_type != AccessType::SCAN_ACCESS) {
+        MoveTo(frame_id, QueueType::A1_QUEUE);
+      }
+      break;
+    case QueueType::A1_QUEUE:
+    case QueueType::AM_QUEUE:
+      if (access_type != AccessType::SCAN_ACCESS) {
+        MoveTo(frame_id, QueueType::AM_QUEUE);
+      }
+      break;
+  }
+}
+
+void TwoQueueReplacer::Remove(frame_id_t frame_id) {
+  FrameInfo &info = frames_[frame_id];
+  if (info.queue_ == QueueType::NONE) {
+    return;
+  }
+  GetQueue(info.queue_).erase(info.position_);
+  if (info.evictable_) {
+    evictable_size_--;
+  }
+  info.queue_ = QueueType::NONE;
+  info.evictable_ = false;
+}
+
+list<frame_id_t> &TwoQueueReplacer::GetQueue(QueueType queue) {
+  switch (queue) {
+    case QueueType::SCAN_QUEUE:
+      return scan_queue_;
+    case QueueType::A1_QUEUE:
+      return a1_queue_;
+    default:
+      return am_queue_;
+  }
+}
+
+void TwoQueueReplacer::MoveTo(frame_id_t frame_id, QueueType queue) {
+  FrameInfo &info = frames_[frame_id];
+  if (info.queue_ != QueueType::NONE) {
+    GetQueue(info.queue_).erase(info.position_);
+  }
+  auto &target = GetQueue(queue);
+  info.position_ = target.insert(target.end(), frame_id);
+  info.queue_ = queue;
+}
+
+bool TwoQueueReplacer::VictimFrom(QueueType queue, frame_id_t *frame_id) {
+  for (auto frame : GetQueue(queue)) {
+    if (frames_[frame].evictable_) {
+      *frame_id = frame;
+      Remove(frame);
+      return true;
+    }
+  }
+  return false;
+}
@@ -1,5 +1,7 @@
 #include "catalog/catalog.h"
 
+#include <thread>
+
 void CatalogMeta::SerializeTo(char *buf) const {
   ASSERT(GetSerializedSize() <= PAGE_SIZE, "Failed to serialize catalog metadata to disk.");
   MACH_WRITE_UINT32(buf, CATALOG_METADATA_MAGIC_NUM);
@@ -67,7 +69,10 @@ CatalogMeta::CatalogMeta() {}
  */
 CatalogManager::CatalogManager(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager,
                                LogManager *log_manager, bool init)
-    : buffer_pool_manager_(buffer_pool_manager), lock_manager_(lock_manager), log_manager_(log_manager) {
+    : buffer_pool_manager_(buffer_pool_manager),
+      lock_manager_(lock_manager),
+      log_manager_(log_manager),
+      index_build_workers_(INDEX_BUILD_WORKERS > 0 ? INDEX_BUILD_WORKERS : std::thread::hardware_concurrency()) {
 //    ASSERT(false, "Not Implemented yet");
   if(init) {
     this->catalog_meta_ = CatalogMeta::NewInstance();
@@ -115,7 +120,9 @@ dberr_t CatalogManager::CreateTable(const string &table_name, TableSchema *schem
   next_table_id_++;
   TableHeap *table_heap = TableHeap::Create(buffer_pool_manager_, schema_copy, txn, log_manager_, lock_manager_);
   //LOG(INFO) << "create table heap" << endl;
-  TableMetadata *table_meta = TableMetadata::Create(table_id, table_name, table_heap->GetFirstPageId(), schema_copy);
+  TableMetadata *table_meta = TableMetadata::Create(table_id, table_name, table_heap->GetFirstPageId(),
+                                                    table_heap->GetFreeSpaceMapPageId(),
+                                                    table_heap->GetZoneMapPageId(), schema_copy);
   //LOG(INFO) << "create tabel meta" << endl;
   table_info = TableInfo::Create();
   //LOG(INFO) << "create table info" << endl;
@@ -134,6 +141,48 @@ dberr_t CatalogManager::CreateTable(const string &table_name, TableSchema *schem
   return DB_SUCCESS;
 }
 
+dberr_t CatalogManager::CreateIndexOrganizedTable(const string &table_name, TableSchema *schema,
+                                                  const string &key_column, const string &index_name,
+                                                  [[maybe_unused]] Txn *txn, TableInfo *&table_info) {
+  if (table_names_.find(table_name) != table_names_.end()) {
+    return DB_TABLE_ALREADY_EXIST;
+  }
+  uint32_t key_index;
+  if (schema->GetColumnIndex(key_column, key_index) != DB_SUCCESS) {
+    return DB_COLUMN_NAME_NOT_EXIST;
+  }
+  if (ClusteredIndex::GetMaxRowSize(schema) > ClusteredIndex::MAX_ROW_SIZE) {
+    return DB_FAILED;
+  }
+  TableSchema *schema_copy = Schema::DeepCopySchema(schema);
+  table_id_t table_id = next_table_id_++;
+  // no table heap, the rows go to the clustered index
+  TableMetadata *table_meta =
+      TableMetadata::Create(table_id, table_name, INVALID_PAGE_ID, INVALID_PAGE_ID, INVALID_PAGE_ID, schema_copy);
+  table_info = TableInfo::Create();
+  table_info->Init(table_meta, nullptr);
+  table_names_[table_name] = table_id;
+  tables_[table_id] = table_info;
+  page_id_t page_id;
+  Page *table_meta_page = buffer_pool_manager_->NewPage(page_id);
+  table_meta->SerializeTo(table_meta_page->GetData());
+  catalog_meta_->table_meta_pages_[table_id] = page_id;
+  buffer_pool_manager_->UnpinPage(page_id, true);
+
+  index_id_t index_id = next_index_id_++;
+  IndexMetadata *index_meta = IndexMetadata::Create(index_id, index_name, table_id, {key_index}, true);
+  IndexInfo *index_info = IndexInfo::Create();
+  index_info->Init(index_meta, table_info, buffer_pool_manager_);
+  Page *index_meta_page = buffer_pool_manager_->NewPage(page_id);
+  index_meta->SerializeTo(index_meta_page->GetData());
+  catalog_meta_->index_meta_pages_[index_id] = page_id;
+  buffer_pool_manager_->UnpinPage(page_id, true);
+  // the clustered index is reached through its table only
+  indexes_.emplace(index_id, index_info);
+  FlushCatalogMetaPage();
+  return DB_SUCCESS;
+}
+
 /**
  * TODO: Student Implement
  */
@@ -176,6 +225,10 @@ dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string
   next_index_id_++;
   table_id_t table_id = table_names_[table_name];
   TableInfo* table_info = tables_[table_id];
+  if (table_info->IsIndexOrganized()) {
+    // an index entry points to a row id, which the rows of an index-organized table do not have
+    return DB_FAILED;
+  }
   uint32_t column_index;
   std::vector<uint32_t> key_map;
   for(const auto &iter: index_keys) {
@@ -189,7 +242,6 @@ dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string
   IndexMetadata *index_meta_data = IndexMetadata::Create(index_id, index_name, table_id, key_map);
   index_info->Init(index_meta_data, table_info, buffer_pool_manager_);
 
-  auto itr = table_info->GetTableHeap()->Begin(txn);
   vector<u_int32_t> column_idx;
   vector<Column *> columns = index_info->GetIndexKeySchema()->GetColumns();
   for(auto column: columns) {
@@ -198,19 +250,54 @@ dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string
       column_idx.push_back(column_id);
     }
   }
-  for(; itr != table_info->GetTableHeap()->End(); itr++) {
-    Row tmp = *itr;
-    vector<Field> fields;
-    for(auto idx: column_idx) {
-      fields.push_back(*tmp.GetField(idx));
+  // the keys of the rows are sorted and packed into the tree bottom-up, instead of inserted one by one. The pages of a
+  // large table are split into ranges, whose keys are extracted and sorted by a thread each
+  auto table_heap = table_info->GetTableHeap();
+  uint32_t num_workers = index_build_workers_;
+  std::vector<page_id_t> pages;
+  if (num_workers > 1) {
+    pages = table_heap->GetPageDirectory();
+  }
+  std::vector<TableIterator> iterators;
+  if (pages.size() < INDEX_BUILD_MIN_PAGES) {
+    iterators.push_back(table_heap->Begin(txn));
+  } else {
+    for (uint32_t i = 0; i < num_workers; i++) {
+      size_t begin = pages.size() * i / num_workers;
+      size_t end = pages.size() * (i + 1) / num_workers;
+      // the range ends where the page list reaches the first page of the next one
+      iterators.push_back(table_heap->Begin(txn, pages[begin], end < pages.size() ? pages[end] : INVALID_PAGE_ID));
     }
-    Row index_row(fields);
-    index_info->GetIndex()->InsertEntry(index_row, tmp.GetRowId(), txn);
+  }
+  auto end = table_heap->End();
+  std::vector<BPlusTreeIndex::EntrySource> sources;
+  for (auto &itr : iterators) {
+    sources.emplace_back([&itr, &end, &column_idx](Row &key, RowId &row_id) {
+      if (itr == end) {
+        return false;
+      }
+      vector<Field> fields;
+      for (auto idx : column_idx) {
+        fields.push_back(*itr->GetField(idx));
+      }
+      key = Row(fields);
+      row_id = itr->GetRowId();
+      ++itr;
+      return true;
+    });
+  }
+  auto *index = static_cast<BPlusTreeIndex *>(index_info->GetIndex());
+  dberr_t result = index->BulkLoad(sources, txn);
+  if (result != DB_SUCCESS) {
+    index->Destroy();
+    delete index_info;
+    index_info = nullptr;
+    return result;
   }
   page_id_t page_id;
   Page* page = buffer_pool_manager_->NewPage(page_id);
   index_meta_data->SerializeTo(page->GetData());
-  buffer_pool_manager_->UnpinPage(CATALOG_META_PAGE_ID, true);
+  buffer_pool_manager_->UnpinPage(page_id, true);
 
   catalog_meta_->index_meta_pages_[index_id] = page_id;
   indexes_.emplace(index_id, index_info);
@@ -318,7 +405,12 @@ dberr_t CatalogManager::LoadTable(const table_id_t table_id, const page_id_t pag
   Page *page = buffer_pool_manager_->FetchPage(page_id);
   TableMetadata *table_meta = nullptr;
   TableMetadata::DeserializeFrom(page->GetData(), table_meta);
-  TableHeap *table_heap = TableHeap::Create(buffer_pool_manager_, table_meta->GetFirstPageId(), table_meta->GetSchema(), log_manager_, lock_manager_);
+  TableHeap *table_heap = nullptr;
+  if (!table_meta->IsIndexOrganized()) {
+    table_heap =
+        TableHeap::Create(buffer_pool_manager_, table_meta->GetFirstPageId(), table_meta->GetFreeSpaceMapPageId(),
+                          table_meta->GetZoneMapPageId(), table_meta->GetSchema(), log_manager_, lock_manager_);
+  }
   TableInfo *table_info = TableInfo::Create();
   table_info->Init(table_meta, table_heap);
   tables_[table_id] = table_info;
@@ -338,7 +430,9 @@ dberr_t CatalogManager::LoadIndex(const index_id_t index_id, const page_id_t pag
   IndexInfo* index_info = IndexInfo::Create();
   index_info->Init(index_meta, tables_[index_meta->GetTableId()], buffer_pool_manager_);
   indexes_[index_id] = index_info;
-  index_names_[tables_[index_meta->GetTableId()]->GetTableName()][index_meta->GetIndexName()] = index_id;
+  if (!index_meta->IsClustered()) {
+    index_names_[tables_[index_meta->GetTableId()]->GetTableName()][index_meta->GetIndexName()] = index_id;
+  }
   buffer_pool_manager_->UnpinPage(page_id, false);
   return DB_SUCCESS;
 }
@@ -1,12 +1,12 @@
 #include "catalog/indexes.h"
 
 IndexMetadata::IndexMetadata(const index_id_t index_id, const std::string &index_name, const table_id_t table_id,
-                             const std::vector<uint32_t> &key_map)
-    : index_id_(index_id), index_name_(index_name), table_id_(table_id), key_map_(key_map) {}
+                             const std::vector<uint32_t> &key_map, bool clustered)
+    : index_id_(index_id), index_name_(index_name), table_id_(table_id), key_map_(key_map), clustered_(clustered) {}
 
 IndexMetadata *IndexMetadata::Create(const index_id_t index_id, const string &index_name, const table_id_t table_id,
-                                     const vector<uint32_t> &key_map) {
-  return new IndexMetadata(index_id, index_name, table_id, key_map);
+                                     const vector<uint32_t> &key_map, bool clustered) {
+  return new IndexMetadata(index_id, index_name, table_id, key_map, clustered);
 }
 
 uint32_t IndexMetadata::SerializeTo(char *buf) const {
@@ -35,6 +35,9 @@ uint32_t IndexMetadata::SerializeTo(char *buf) const {
     MACH_WRITE_UINT32(buf, col_index);
     buf += 4;
   }
+  // clustered
+  MACH_WRITE_UINT32(buf, clustered_ ? 1 : 0);
+  buf += 4;
   ASSERT(buf - p == ofs, "Unexpected serialize size.");
   return ofs;
 }
@@ -43,7 +46,7 @@ uint32_t IndexMetadata::SerializeTo(char *buf) const {
  * TODO: Student Implement
  */
 uint32_t IndexMetadata::GetSerializedSize() const {
-  return sizeof(uint32_t) * 3 + index_name_.length() + sizeof(index_id_t) + sizeof(table_id_t) +
+  return sizeof(uint32_t) * 4 + index_name_.length() + sizeof(index_id_t) + sizeof(table_id_t) +
       key_map_.size() * sizeof(uint32_t);
 }
 
@@ -77,33 +80,30 @@ uint32_t IndexMetadata::DeserializeFrom(char *buf, IndexMetadata *&index_meta) {
     buf += 4;
     key_map.push_back(key_index);
   }
+  // clustered
+  bool clustered = MACH_READ_UINT32(buf) != 0;
+  buf += 4;
   // allocate space for index meta data
-  index_meta = new IndexMetadata(index_id, index_name, table_id, key_map);
+  index_meta = new IndexMetadata(index_id, index_name, table_id, key_map, clustered);
   return buf - p;
 }
 
 Index *IndexInfo::CreateIndex(BufferPoolManager *buffer_pool_manager, const string &index_type) {
-  size_t max_size = 0;
-  uint32_t column_cnt = key_schema_->GetColumns().size();
-  size_t size_bitmap = (column_cnt % 8) ? column_cnt / 8 + 1 : column_cnt / 8;
-  // column_cnt + bitmap
-  max_size += 4 + sizeof(unsigned char) * size_bitmap;
-  for (auto col : key_schema_->GetColumns()) {
-    if(col->GetType() == TypeId::kTypeChar)
-      max_size += 4;
-    max_size += col->GetLength();
-  }
+  size_t max_size = KeyManager::GetEncodedSize(key_schema_);
 
+  // the smallest key sizes are the widths with a fixed-width comparator, see KeyManager
   if (index_type == "bptree") {
     if (max_size <= 8)
+      max_size = 8;
+    else if (max_size <= 16)
       max_size = 16;
-    else if (max_size <= 24)
+    else if (max_size <= 32)
       max_size = 32;
-    else if (max_size <= 56)
+    else if (max_size <= 64)
       max_size = 64;
-    else if (max_size <= 120)
+    else if (max_size <= 128)
       max_size = 128;
-    else if (max_size <= 248)
+    else if (max_size <= 256)
       max_size = 256;
     else {
       LOG(ERROR) << "GenericKey size is too large";
@@ -3,7 +3,8 @@
 //
 #include "common/instance.h"
 
-DBStorageEngine::DBStorageEngine(std::string db_name, bool init, uint32_t buffer_pool_size)
+DBStorageEngine::DBStorageEngine(std::string db_name, bool init, uint32_t buffer_pool_size,
+                                 uint32_t buffer_pool_instances)
     : db_file_name_(std::move(db_name)), init_(init) {
   // Init database file if needed
   db_file_name_ = "./databases/" + db_file_name_;
@@ -12,7 +13,12 @@ DBStorageEngine::DBStorageEngine(std::string db_name, bool init, uint32_t buffer
   }
   // Initialize components
   disk_mgr_ = new DiskManager(db_file_name_);
-  bpm_ = new BufferPoolManager(buffer_pool_size, disk_mgr_);
+  if (buffer_pool_instances > 1) {
+    bpm_ = new ParallelBufferPoolManager(buffer_pool_instances, buffer_pool_size, disk_mgr_);
+  } else {
+    bpm_ = new BufferPoolManager(buffer_pool_size, disk_mgr_);
+  }
+  bpm_->StartPageCleaner();
 
   // Allocate static page for db storage engine
   if (init) {
@@ -13,9 +13,26 @@ void DeleteExecutor::Init() {
   exec_ctx_->GetCatalog()->GetTable(plan_->GetTableName(), table_info_);
   exec_ctx_->GetCatalog()->GetTableIndexes(table_info_->GetTableName(), index_info_);
   txn_ = exec_ctx_->GetTransaction();
+  clustered_rows_.clear();
+  collected_ = false;
+  cursor_ = 0;
 }
 
 bool DeleteExecutor::Next([[maybe_unused]] Row *row, RowId *rid) {
+  auto clustered_index = table_info_->GetClusteredIndex();
+  if (clustered_index != nullptr) {
+    if (!collected_) {
+      while (child_executor_->Next(row, rid)) {
+        clustered_rows_.push_back(*row);
+      }
+      collected_ = true;
+    }
+    if (cursor_ == clustered_rows_.size()) {
+      return false;
+    }
+    clustered_index->RemoveRow(clustered_rows_[cursor_++], txn_);
+    return true;
+  }
   if (child_executor_->Next(row, rid)) {
     if (!table_info_->GetTableHeap()->MarkDelete(*rid, txn_)) {
       return false;
@@ -138,6 +138,8 @@ dberr_t ExecuteEngine::Execute(pSyntaxNode ast) {
       return ExecuteTrxCommit(ast, context.get());
     case kNodeTrxRollback:
       return ExecuteTrxRollback(ast, context.get());
+    case kNodeVacuum:
+      return ExecuteVacuum(ast, context.get());
     case kNodeExecFile:
       return ExecuteExecfile(ast, context.get());
     case kNodeQuit:
@@ -440,7 +442,29 @@ dberr_t ExecuteEngine::ExecuteCreateTable(pSyntaxNode ast, ExecuteContext *conte
     columns.push_back(col);
   }
   Schema* schema = new Schema(columns);
-  // cout << 444 << endl;
+  if (ast->val_ != nullptr && !strcmp(ast->val_, "organization index")) {
+    // the rows are stored in the primary key index, which is the only index of the table
+    dberr_t result = DB_FAILED;
+    if (primary_keys.empty()) {
+      cout << "An index-organized table needs a primary key." << endl;
+    } else if (!unique_keys.empty()) {
+      cout << "An index-organized table cannot have unique columns." << endl;
+    } else {
+      result = db->catalog_mgr_->CreateIndexOrganizedTable(table_name, schema, primary_keys[0], table_name + "_primary",
+                                                           nullptr, table_info);
+      if (result == DB_FAILED) {
+        cout << "Table create failed, the rows of an index-organized table are limited to "
+             << ClusteredIndex::MAX_ROW_SIZE << " bytes." << endl;
+      } else if (result != DB_SUCCESS) {
+        cout << "Table create failed." << endl;
+      }
+    }
+    delete schema;
+    if (result == DB_SUCCESS) {
+      cout << "Table created." << endl;
+    }
+    return result;
+  }
   dberr_t createtable_result = db->catalog_mgr_->CreateTable(table_name, schema, nullptr, table_info);
   if (createtable_result != DB_SUCCESS){
     cout << "Table create failed." << endl;
@@ -572,6 +596,40 @@ dberr_t ExecuteEngine::ExecuteDropIndex(pSyntaxNode ast, ExecuteContext *context
   return DB_FAILED;
 }
 
+dberr_t ExecuteEngine::ExecuteVacuum(pSyntaxNode ast, [[maybe_unused]] ExecuteContext *context) {
+#ifdef ENABLE_EXECUTE_DEBUG
+  LOG(INFO) << "ExecuteVacuum" << std::endl;
+#endif
+  assert(ast->type_ == kNodeVacuum);
+  if (current_db_.empty()) {
+    cout << "No database used." << endl;
+    return DB_FAILED;
+  }
+  string table_name = ast->child_->val_;
+  auto catalog = dbs_[current_db_]->catalog_mgr_;
+  TableInfo *table_info;
+  if (catalog->GetTable(table_name, table_info) != DB_SUCCESS) {
+    return DB_TABLE_NOT_EXIST;
+  }
+  if (table_info->IsIndexOrganized()) {
+    cout << "Table is index-organized, nothing to vacuum." << endl;
+    return DB_SUCCESS;
+  }
+  vector<IndexInfo *> indexes;
+  catalog->GetTableIndexes(table_name, indexes);
+  // a moved tuple gets a new rid, its index entries are moved along
+  Row key_row;
+  size_t freed_pages = table_info->GetTableHeap()->Vacuum(nullptr, [&](const Row &row, const RowId &old_rid) {
+    for (auto index : indexes) {
+      row.GetKeyFromRow(table_info->GetSchema(), index->GetIndexKeySchema(), key_row);
+      index->GetIndex()->RemoveEntry(key_row, old_rid, nullptr);
+      index->GetIndex()->InsertEntry(key_row, row.GetRowId(), nullptr);
+    }
+  });
+  cout << "Table vacuumed, " << freed_pages << " page(s) freed." << endl;
+  return DB_SUCCESS;
+}
+
 /**
  * TODO: Student Implement
  */
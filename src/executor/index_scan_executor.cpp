@@ -10,9 +10,9 @@ IndexScanExecutor::IndexScanExecutor(ExecuteContext *exec_ctx, const IndexScanPl
 
 void IndexScanExecutor::Init() {
   exec_ctx_->GetCatalog()->GetTable(plan_->GetTableName(), table_info_);
-  auto first_row = table_info_->GetTableHeap()->Begin(nullptr);
   result_ = IndexScan(plan_->GetPredicate());
   is_schema_same_ = SchemaEqual(table_info_->GetSchema(), plan_->OutputSchema());
+  view_.SetExternalValueReader(table_info_->GetTableHeap());
 }
 
 bool IndexScanExecutor::SchemaEqual(const Schema *table_schema, const Schema *output_schema) {
@@ -32,18 +32,6 @@ bool IndexScanExecutor::SchemaEqual(const Schema *table_schema, const Schema *ou
   return true;
 }
 
-void IndexScanExecutor::TupleTransfer(const Schema *table_schema, const Schema *output_schema, const Row *row,
-                                      Row *output_row) {
-  const auto &output_columns = output_schema->GetColumns();
-  std::vector<Field> dest_row;
-  dest_row.reserve(output_columns.size());
-  for (const auto column : output_columns) {
-    auto idx = column->GetTableInd();
-    dest_row.emplace_back(*row->GetField(idx));
-  }
-  *output_row = Row(dest_row);
-}
-
 vector<RowId> IndexScanExecutor::IndexScan(AbstractExpressionRef predicate) {
   switch (predicate->GetType()) {
     case ExpressionType::LogicExpression: {
@@ -79,23 +67,26 @@ vector<RowId> IndexScanExecutor::IndexScan(AbstractExpressionRef predicate) {
 bool IndexScanExecutor::Next(Row *row, RowId *rid) {
   auto predicate = plan_->GetPredicate();
   auto table_schema = table_info_->GetSchema();
+  auto bpm = exec_ctx_->GetBufferPoolManager();
   while (cursor_ < result_.size()) {
-    auto p_row = new Row(result_[cursor_]);
-    table_info_->GetTableHeap()->GetTuple(p_row, nullptr);
-    if (plan_->need_filter_) {
-      if (!predicate->Evaluate(p_row).CompareEquals(Field(kTypeInt, 1))) {
-        cursor_++;
-        continue;
+    RowId cur_rid = result_[cursor_++];
+    auto page = reinterpret_cast<TablePage *>(bpm->FetchPage(cur_rid.GetPageId()));
+    page->RLatch();
+    bool found = page->GetTupleView(cur_rid, table_schema, &view_) &&
+                 (!plan_->need_filter_ || predicate->EvaluateView(view_).CompareEquals(Field(kTypeInt, 1)));
+    if (found) {
+      *rid = cur_rid;
+      if (is_schema_same_) {
+        view_.ToRow(row);
+      } else {
+        view_.ToRow(row, plan_->OutputSchema());
       }
     }
-    *rid = result_[cursor_];
-    if (!is_schema_same_) {
-      TupleTransfer(table_schema, plan_->OutputSchema(), p_row, row);
-    } else {
-      *row = *p_row;
+    page->RUnlatch();
+    bpm->UnpinPage(cur_rid.GetPageId(), false);
+    if (found) {
+      return true;
     }
-    cursor_++;
-    return true;
   }
   return false;
 }
@@ -4,6 +4,9 @@
 
 #include "executor/executors/insert_executor.h"
 
+#include <string>
+#include <unordered_set>
+
 InsertExecutor::InsertExecutor(ExecuteContext *exec_ctx, const InsertPlanNode *plan,
                                std::unique_ptr<AbstractExecutor> &&child_executor)
     : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
@@ -16,28 +19,77 @@ void InsertExecutor::Init() {
 }
 
 bool InsertExecutor::Next([[maybe_unused]] Row *row, RowId *rid) {
-   Row insert_row;
-    RowId insert_rid;
-    if (child_executor_->Next(&insert_row, &insert_rid)) {
-        for (auto info: index_info_) {
-            Row key_row;
-            insert_row.GetKeyFromRow(table_info_->GetSchema(), info->GetIndexKeySchema(), key_row);
-            std::vector<RowId> result;
-            if (!key_row.GetFields().empty() &&
-                info->GetIndex()->ScanKey(key_row, result, exec_ctx_->GetTransaction()) == DB_SUCCESS) {
-                std::cout << "key already exists" << std::endl;
-                return false;
-            }
-        }
-        if (table_info_->GetTableHeap()->InsertTuple(insert_row, exec_ctx_->GetTransaction())) {
-            Row key_row;
-            for (auto info: index_info_) {  // 更新索引
-                insert_row.GetKeyFromRow(schema_, info->GetIndexKeySchema(), key_row);
-                info->GetIndex()->InsertEntry(key_row, insert_row.GetRowId(), exec_ctx_->GetTransaction());
-            }
-            return true;
-        }
+  if (!inserted_) {
+    num_inserted_ = InsertAll();
+    inserted_ = true;
+  }
+  // one result per inserted row
+  if (cursor_ < num_inserted_) {
+    cursor_++;
+    return true;
+  }
+  return false;
+}
+
+size_t InsertExecutor::InsertAll() {
+  if (table_info_->GetClusteredIndex() != nullptr) {
+    return InsertAllClustered(table_info_->GetClusteredIndex());
+  }
+  std::vector<Row> rows;
+  // serialized keys of the rows of this batch, so that duplicates within the batch are found too
+  std::vector<std::unordered_set<std::string>> batch_keys(index_info_.size());
+  Row insert_row;
+  RowId insert_rid;
+  while (child_executor_->Next(&insert_row, &insert_rid)) {
+    bool duplicate = false;
+    for (size_t i = 0; i < index_info_.size() && !duplicate; i++) {
+      Row key_row;
+      insert_row.GetKeyFromRow(schema_, index_info_[i]->GetIndexKeySchema(), key_row);
+      if (key_row.GetFields().empty()) {
+        continue;
+      }
+      std::vector<RowId> result;
+      std::string key(key_row.GetSerializedSize(index_info_[i]->GetIndexKeySchema()), '\0');
+      key_row.SerializeTo(key.data(), index_info_[i]->GetIndexKeySchema());
+      duplicate = batch_keys[i].count(key) > 0 ||
+                  index_info_[i]->GetIndex()->ScanKey(key_row, result, exec_ctx_->GetTransaction()) == DB_SUCCESS;
+      batch_keys[i].insert(std::move(key));
+    }
+    if (duplicate) {
+      std::cout << "key already exists" << std::endl;
+      break;
+    }
+    rows.push_back(insert_row);
+  }
+  if (rows.empty()) {
+    return 0;
+  }
+  rows.resize(table_info_->GetTableHeap()->InsertBatch(rows, exec_ctx_->GetTransaction()));
+  for (auto &inserted_row : rows) {
+    Row key_row;
+    for (auto info : index_info_) {  // 更新索引
+      inserted_row.GetKeyFromRow(schema_, info->GetIndexKeySchema(), key_row);
+      info->GetIndex()->InsertEntry(key_row, inserted_row.GetRowId(), exec_ctx_->GetTransaction());
     }
+  }
+  return rows.size();
+}
 
-  return false;
-}
\ No newline at end of file
+size_t InsertExecutor::InsertAllClustered(ClusteredIndex *clustered_index) {
+  size_t num_inserted = 0;
+  Row insert_row;
+  RowId insert_rid;
+  while (child_executor_->Next(&insert_row, &insert_rid)) {
+    dberr_t result = clustered_index->InsertRow(insert_row, exec_ctx_->GetTransaction());
+    if (result == DB_ALREADY_EXIST) {
+      std::cout << "key already exists" << std::endl;
+      break;
+    }
+    if (result != DB_SUCCESS) {
+      std::cout << "invalid row for an index-organized table" << std::endl;
+      break;
+    }
+    num_inserted++;
+  }
+  return num_inserted;
+}
@@ -3,11 +3,15 @@
 //
 #include "executor/executors/seq_scan_executor.h"
 
+#include <algorithm>
+
+#include "planner/expressions/comparison_expression.h"
+#include "planner/expressions/logic_expression.h"
+
 SeqScanExecutor::SeqScanExecutor(ExecuteContext *exec_ctx, const SeqScanPlanNode *plan)
-    : AbstractExecutor(exec_ctx),
-      plan_(plan),
-      iterator_(nullptr, RowId(INVALID_PAGE_ID, 0), nullptr),
-      is_schema_same_(false) {}
+    : AbstractExecutor(exec_ctx), plan_(plan), iterator_(nullptr, INVALID_ROWID, nullptr), is_schema_same_(false) {}
+
+SeqScanExecutor::~SeqScanExecutor() { StopWorkers(); }
 
 bool SeqScanExecutor::SchemaEqual(const Schema *table_schema, const Schema *output_schema) {
   auto table_columns = table_schema->GetColumns();
@@ -26,45 +30,254 @@ bool SeqScanExecutor::SchemaEqual(const Schema *table_schema, const Schema *outp
   return true;
 }
 
-void SeqScanExecutor::TupleTransfer(const Schema *table_schema, const Schema *output_schema, const Row *row,
-                                    Row *output_row) {
-  const auto &output_columns = output_schema->GetColumns();
-  std::vector<Field> dest_row;
-  dest_row.reserve(output_columns.size());
-  for (const auto column : output_columns) {
-    auto idx = column->GetTableInd();
-    dest_row.emplace_back(*row->GetField(idx));
-  }
-  *output_row = Row(dest_row);
-}
-
 void SeqScanExecutor::Init() {
+  StopWorkers();
   exec_ctx_->GetCatalog()->GetTable(plan_->GetTableName(), table_info_);
-  auto first_row = table_info_->GetTableHeap()->Begin(nullptr);
-  iterator_ = (table_info_->GetTableHeap()->Begin(exec_ctx_->GetTransaction()));
   schema_ = plan_->OutputSchema();
   is_schema_same_ = SchemaEqual(table_info_->GetSchema(), schema_);
+  auto predicate = plan_->GetPredicate();
+  clustered_index_ = table_info_->GetClusteredIndex();
+  if (clustered_index_ != nullptr) {
+    parallel_ = false;
+    lower_key_.reset();
+    upper_key_.reset();
+    upper_inclusive_ = true;
+    if (predicate != nullptr) {
+      NarrowKeyRange(predicate.get());
+    }
+    index_iterator_ = lower_key_ != nullptr ? clustered_index_->GetBeginIterator(*lower_key_)
+                                            : clustered_index_->GetBeginIterator();
+    return;
+  }
+  auto table_heap = table_info_->GetTableHeap();
+  uint32_t num_workers = exec_ctx_->GetScanWorkers();
+  pages_.clear();
+  may_match_.clear();
+  page_cursor_ = 0;
+  if (predicate != nullptr) {
+    pages_ = table_heap->GetPageDirectory([&](const ZoneMapEntry &zone) { return predicate->MayMatch(zone); },
+                                          &may_match_);
+  } else if (num_workers > 1) {
+    pages_ = table_heap->GetPageDirectory(nullptr, &may_match_);
+  }
+  parallel_ = num_workers > 1 && pages_.size() >= PARALLEL_SCAN_MIN_PAGES;
+  iterator_ = table_heap->End();
+  if (pages_.empty()) {
+    iterator_ = table_heap->Begin(exec_ctx_->GetTransaction());
+  }
+  if (!parallel_) {
+    return;
+  }
+  next_morsel_ = 0;
+  stopped_ = false;
+  num_workers_ = num_workers;
+  active_workers_ = num_workers;
+  gather_queue_.clear();
+  batch_.clear();
+  batch_cursor_ = 0;
+  for (uint32_t i = 0; i < num_workers; i++) {
+    workers_.emplace_back(&SeqScanExecutor::ScanMorsels, this);
+  }
 }
 
-bool SeqScanExecutor::Next(Row *row, RowId *rid) {
+bool SeqScanExecutor::ScanNext(TableIterator &iterator, Row *row) {
   auto predicate = plan_->GetPredicate();
-  auto table_schema = table_info_->GetSchema();
-  while (iterator_ != table_info_->GetTableHeap()->End()) {
-    auto p_row = &(*iterator_);
-    if (predicate != nullptr) {
-      if (!predicate->Evaluate(p_row).CompareEquals(Field(kTypeInt, 1))) {
-        iterator_++;
-        continue;
+  bool found = iterator.SkipUntil([&](const RowView &view) {
+    if (predicate != nullptr && !predicate->EvaluateView(view).CompareEquals(Field(kTypeInt, 1))) {
+      return false;
+    }
+    if (is_schema_same_) {
+      view.ToRow(row);
+    } else {
+      view.ToRow(row, schema_);
+    }
+    return true;
+  });
+  if (found) {
+    ++iterator;
+  }
+  return found;
+}
+
+bool SeqScanExecutor::NextPageRange(size_t &cursor, size_t end, TableIterator &iterator) {
+  while (cursor < end && !may_match_[cursor]) {
+    cursor++;
+  }
+  if (cursor >= end) {
+    return false;
+  }
+  size_t range_end = cursor + 1;
+  while (range_end < end && may_match_[range_end]) {
+    range_end++;
+  }
+  // the range ends where the page list reaches the next page of the directory
+  page_id_t end_page_id = range_end < pages_.size() ? pages_[range_end] : INVALID_PAGE_ID;
+  iterator = table_info_->GetTableHeap()->Begin(exec_ctx_->GetTransaction(), pages_[cursor], end_page_id);
+  cursor = range_end;
+  return true;
+}
+
+void SeqScanExecutor::ScanMorsels() {
+  auto table_heap = table_info_->GetTableHeap();
+  std::vector<Row> batch;
+  batch.reserve(PARALLEL_SCAN_BATCH_ROWS);
+  bool stopped = false;
+  while (!stopped) {
+    size_t begin = next_morsel_.fetch_add(PARALLEL_SCAN_MORSEL_PAGES);
+    if (begin >= pages_.size()) {
+      break;
+    }
+    size_t end = std::min(begin + PARALLEL_SCAN_MORSEL_PAGES, pages_.size());
+    auto iterator = table_heap->End();
+    while (!stopped && NextPageRange(begin, end, iterator)) {
+      // rows are copied straight into the batch, which never grows past its capacity
+      batch.emplace_back();
+      while (!stopped && ScanNext(iterator, &batch.back())) {
+        if (batch.size() == PARALLEL_SCAN_BATCH_ROWS) {
+          stopped = !Gather(batch);
+        }
+        batch.emplace_back();
       }
+      batch.pop_back();
     }
-    *rid = iterator_->GetRowId();
-    if (!is_schema_same_) {
-      TupleTransfer(table_schema, schema_, p_row, row);
+  }
+  if (!stopped && !batch.empty()) {
+    Gather(batch);
+  }
+  std::scoped_lock<std::mutex> lock(gather_latch_);
+  active_workers_--;
+  gather_cv_.notify_all();
+}
+
+bool SeqScanExecutor::Gather(std::vector<Row> &batch) {
+  std::unique_lock<std::mutex> lock(gather_latch_);
+  // keep at most two batches per worker in flight
+  gather_cv_.wait(lock, [&] { return stopped_ || gather_queue_.size() < 2 * num_workers_; });
+  if (stopped_) {
+    return false;
+  }
+  gather_queue_.push_back(std::move(batch));
+  gather_cv_.notify_all();
+  batch = std::vector<Row>();
+  batch.reserve(PARALLEL_SCAN_BATCH_ROWS);
+  return true;
+}
+
+void SeqScanExecutor::StopWorkers() {
+  {
+    std::scoped_lock<std::mutex> lock(gather_latch_);
+    stopped_ = true;
+    gather_cv_.notify_all();
+  }
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+}
+
+void SeqScanExecutor::NarrowKeyRange(const AbstractExpression *predicate) {
+  auto logic = dynamic_cast<const LogicExpression *>(predicate);
+  if (logic != nullptr) {
+    // both sides of an and must hold, while either side of an or may not
+    if (logic->logic_type_ == LogicType::And) {
+      NarrowKeyRange(logic->GetChildAt(0).get());
+      NarrowKeyRange(logic->GetChildAt(1).get());
+    }
+    return;
+  }
+  auto comparison = dynamic_cast<const ComparisonExpression *>(predicate);
+  if (comparison == nullptr) {
+    return;
+  }
+  const ColumnValueExpression *column;
+  const ConstantValueExpression *constant;
+  std::string comp_type = comparison->GetColumnComparison(column, constant);
+  uint32_t key_column = clustered_index_->GetKeyColumn();
+  if (column == nullptr || constant == nullptr || column->GetColIdx() != key_column) {
+    return;
+  }
+  Field value = constant->Evaluate(nullptr);
+  if (value.IsNull() || value.GetTypeId() != table_info_->GetSchema()->GetColumn(key_column)->GetType()) {
+    return;
+  }
+  // the scan starts at the lower key, a row equal to an exclusive one is left to the predicate
+  if ((comp_type == "=" || comp_type == ">" || comp_type == ">=") &&
+      (lower_key_ == nullptr || value.CompareGreaterThan(*lower_key_) == CmpBool::kTrue)) {
+    lower_key_ = std::make_unique<Field>(value);
+  }
+  if (comp_type == "=" || comp_type == "<" || comp_type == "<=") {
+    bool inclusive = comp_type != "<";
+    if (upper_key_ == nullptr || value.CompareLessThan(*upper_key_) == CmpBool::kTrue) {
+      upper_key_ = std::make_unique<Field>(value);
+      upper_inclusive_ = inclusive;
+    } else if (value.CompareEquals(*upper_key_) == CmpBool::kTrue) {
+      upper_inclusive_ = upper_inclusive_ && inclusive;
+    }
+  }
+}
+
+bool SeqScanExecutor::ScanIndexNext(Row *row) {
+  auto predicate = plan_->GetPredicate();
+  auto end = clustered_index_->GetEndIterator();
+  for (; index_iterator_ != end; ++index_iterator_) {
+    clustered_index_->GetRowView((*index_iterator_).first, &view_);
+    if (upper_key_ != nullptr) {
+      Field key = view_.GetField(clustered_index_->GetKeyColumn());
+      CmpBool past_end =
+          upper_inclusive_ ? key.CompareGreaterThan(*upper_key_) : key.CompareGreaterThanEquals(*upper_key_);
+      if (past_end == CmpBool::kTrue) {
+        // the leaf is unpinned right away
+        index_iterator_ = clustered_index_->GetEndIterator();
+        return false;
+      }
+    }
+    if (predicate != nullptr && !predicate->EvaluateView(view_).CompareEquals(Field(kTypeInt, 1))) {
+      continue;
+    }
+    if (is_schema_same_) {
+      view_.ToRow(row);
     } else {
-      *row = *p_row;
+      view_.ToRow(row, schema_);
     }
-    iterator_++;
+    ++index_iterator_;
     return true;
   }
   return false;
 }
+
+bool SeqScanExecutor::Next(Row *row, RowId *rid) {
+  if (clustered_index_ != nullptr) {
+    if (!ScanIndexNext(row)) {
+      return false;
+    }
+    *rid = row->GetRowId();
+    return true;
+  }
+  if (!parallel_) {
+    while (!ScanNext(iterator_, row)) {
+      if (!NextPageRange(page_cursor_, pages_.size(), iterator_)) {
+        return false;
+      }
+    }
+    *rid = row->GetRowId();
+    return true;
+  }
+  while (batch_cursor_ == batch_.size()) {
+    std::unique_lock<std::mutex> lock(gather_latch_);
+    gather_cv_.wait(lock, [&] { return !gather_queue_.empty() || active_workers_ == 0; });
+    if (gather_queue_.empty()) {
+      return false;
+    }
+    batch_ = std::move(gather_queue_.front());
+    gather_queue_.pop_front();
+    batch_cursor_ = 0;
+    gather_cv_.notify_all();
+  }
+  // hand the fields of the gathered row over instead of copying them
+  Row &next = batch_[batch_cursor_++];
+  row->destroy();
+  row->GetFields().swap(next.GetFields());
+  row->SetRowId(next.GetRowId());
+  *rid = row->GetRowId();
+  return true;
+}
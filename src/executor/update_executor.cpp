@@ -13,29 +13,124 @@ void UpdateExecutor::Init() {
   exec_ctx_->GetCatalog()->GetTable(plan_->GetTableName(), table_info_);
   exec_ctx_->GetCatalog()->GetTableIndexes(table_info_->GetTableName(), index_info_);
   txn_ = exec_ctx_->GetTransaction();
+  // only the indexes on a column set by the update may see their keys change
+  const auto &update_attrs = plan_->GetUpdateAttr();
+  updated_index_info_.clear();
+  for (auto info : index_info_) {
+    for (auto column : info->GetIndexKeySchema()->GetColumns()) {
+      if (update_attrs.count(column->GetTableInd()) > 0) {
+        updated_index_info_.push_back(info);
+        break;
+      }
+    }
+  }
+  moved_rids_.clear();
+  updated_ = false;
+  num_updated_ = 0;
+  cursor_ = 0;
 }
 
 bool UpdateExecutor::Next([[maybe_unused]] Row *row, RowId *rid) {
+  auto clustered_index = table_info_->GetClusteredIndex();
+  if (clustered_index != nullptr) {
+    if (!updated_) {
+      num_updated_ = UpdateAllClustered(clustered_index);
+      updated_ = true;
+    }
+    // one result per updated row
+    if (cursor_ < num_updated_) {
+      cursor_++;
+      return true;
+    }
+    return false;
+  }
   Row src_row;
   RowId src_rid;
-  if (child_executor_->Next(&src_row, &src_rid)) {
+  while (child_executor_->Next(&src_row, &src_rid)) {
+    // a row moved by this update may be met again by the scan, it is not updated twice
+    if (moved_rids_.count(src_rid) > 0) {
+      continue;
+    }
     Row dest_row = GenerateUpdatedTuple(src_row);
-    if (!table_info_->GetTableHeap()->UpdateTuple(dest_row, src_rid, txn_)) {
+    auto table_heap = table_info_->GetTableHeap();
+    // the new version stays at the same rid when it fits in the page, so an index changes only if its key does
+    if (table_heap->UpdateTuple(dest_row, src_rid, txn_)) {
+      for (auto info : updated_index_info_) {
+        UpdateIndex(info, src_row, src_rid, dest_row, src_rid);
+      }
+      return true;
+    }
+    // otherwise it moves to another page and every index follows it
+    if (!table_heap->MarkDelete(src_rid, txn_)) {
+      return false;
+    }
+    if (!table_heap->InsertTuple(dest_row, txn_)) {
+      // the old version is kept, the indexes still point to it
+      table_heap->RollbackDelete(src_rid, txn_);
       return false;
     }
-    Row src_key_row;
-    Row dest_key_row;
-    for (auto info : index_info_) {  // 更新索引
-      src_row.GetKeyFromRow(table_info_->GetSchema(), info->GetIndexKeySchema(), src_key_row);
-      dest_row.GetKeyFromRow(table_info_->GetSchema(), info->GetIndexKeySchema(), dest_key_row);
-      info->GetIndex()->RemoveEntry(src_key_row, src_rid, txn_);
-      info->GetIndex()->InsertEntry(dest_key_row, src_rid, txn_);
+    moved_rids_.insert(dest_row.GetRowId());
+    for (auto info : index_info_) {
+      UpdateIndex(info, src_row, src_rid, dest_row, dest_row.GetRowId());
     }
     return true;
   }
   return false;
 }
 
+void UpdateExecutor::UpdateIndex(IndexInfo *info, const Row &src_row, const RowId &src_rid, const Row &dest_row,
+                                 const RowId &dest_rid) {
+  Row src_key_row;
+  Row dest_key_row;
+  src_row.GetKeyFromRow(table_info_->GetSchema(), info->GetIndexKeySchema(), src_key_row);
+  dest_row.GetKeyFromRow(table_info_->GetSchema(), info->GetIndexKeySchema(), dest_key_row);
+  if (src_rid == dest_rid) {
+    bool same_key = true;
+    for (uint32_t i = 0; i < src_key_row.GetFieldCount() && same_key; i++) {
+      Field *src_field = src_key_row.GetField(i);
+      Field *dest_field = dest_key_row.GetField(i);
+      same_key = src_field->IsNull() ? dest_field->IsNull()
+                                     : !dest_field->IsNull() && src_field->CompareEquals(*dest_field) == CmpBool::kTrue;
+    }
+    if (same_key) {
+      return;
+    }
+  }
+  info->GetIndex()->RemoveEntry(src_key_row, src_rid, txn_);
+  info->GetIndex()->InsertEntry(dest_key_row, dest_rid, txn_);
+}
+
+size_t UpdateExecutor::UpdateAllClustered(ClusteredIndex *clustered_index) {
+  // the child scans the clustered index, which is only changed once it is done
+  std::vector<Row> src_rows;
+  Row src_row;
+  RowId src_rid;
+  while (child_executor_->Next(&src_row, &src_rid)) {
+    src_rows.push_back(src_row);
+  }
+  for (auto &row : src_rows) {
+    clustered_index->RemoveRow(row, txn_);
+  }
+  for (size_t i = 0; i < src_rows.size(); i++) {
+    Row dest_row = GenerateUpdatedTuple(src_rows[i]);
+    dberr_t result = clustered_index->InsertRow(dest_row, txn_);
+    if (result == DB_SUCCESS) {
+      continue;
+    }
+    std::cout << (result == DB_ALREADY_EXIST ? "key already exists" : "invalid row for an index-organized table")
+              << std::endl;
+    // put the old versions back in place of the new ones
+    for (size_t j = 0; j < i; j++) {
+      clustered_index->RemoveRow(GenerateUpdatedTuple(src_rows[j]), txn_);
+    }
+    for (auto &row : src_rows) {
+      clustered_index->InsertRow(row, txn_);
+    }
+    return 0;
+  }
+  return src_rows.size();
+}
+
 Row UpdateExecutor::GenerateUpdatedTuple(const Row &src_row) {
   const auto update_attrs = plan_->GetUpdateAttr();
   Schema *schema = table_info_->GetSchema();
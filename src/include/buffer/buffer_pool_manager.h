@@ -1,38 +1,125 @@
 #ifndef MINISQL_BUFFER_POOL_MANAGER_H
 #define MINISQL_BUFFER_POOL_MANAGER_H
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <list>
 #include <mutex>
+#include <thread>
 #include <unordered_map>
 
+#include "buffer/clock_replacer.h"
+#include "buffer/frame_arena.h"
+#include "buffer/lru_k_replacer.h"
 #include "buffer/lru_replacer.h"
+#include "buffer/two_queue_replacer.h"
 #include "page/disk_file_meta_page.h"
 #include "page/page.h"
 #include "storage/disk_manager.h"
 
 using namespace std;
 
+/**
+ * Detects that an iterator walks a page chain sequentially and tells it when to read ahead.
+ */
+class ReadAheadState {
+ public:
+  /**
+   * Called whenever the iterator moves on to the next page of the chain.
+   * @return true if the next READ_AHEAD_PAGES pages should be prefetched now
+   */
+  bool OnPageHop() {
+    hops_++;
+    if (hops_ < READ_AHEAD_TRIGGER || hops_ < next_read_ahead_) {
+      return false;
+    }
+    // the window is refilled once half of it has been consumed
+    next_read_ahead_ = hops_ + READ_AHEAD_PAGES / 2;
+    return true;
+  }
+
+ private:
+  uint32_t hops_{0};
+  uint32_t next_read_ahead_{0};
+};
+
 class BufferPoolManager {
+  // The parallel buffer pool routes pages that it allocated itself into its instances.
+  friend class ParallelBufferPoolManager;
+
  public:
-  explicit BufferPoolManager(size_t pool_size, DiskManager *disk_manager);
+  /**
+   * @param replacer_type the policy used to pick the frame to evict once the free list is exhausted
+   */
+  explicit BufferPoolManager(size_t pool_size, DiskManager *disk_manager,
+                             ReplacerType replacer_type = ReplacerType::LRU_K_REPLACER);
 
-  ~BufferPoolManager();
+  virtual ~BufferPoolManager();
 
-  Page *FetchPage(page_id_t page_id);
+  /**
+   * @param access_type lets the replacer tell pages read by sequential scans from the others
+   */
+  virtual Page *FetchPage(page_id_t page_id, AccessType access_type = AccessType::DEFAULT_ACCESS);
 
-  bool UnpinPage(page_id_t page_id, bool is_dirty);
+  virtual bool UnpinPage(page_id_t page_id, bool is_dirty);
 
-  bool FlushPage(page_id_t page_id);
+  virtual bool FlushPage(page_id_t page_id);
 
-  Page *NewPage(page_id_t &page_id);
+  virtual Page *NewPage(page_id_t &page_id);
 
-  bool DeletePage(page_id_t page_id);
+  virtual bool DeletePage(page_id_t page_id);
 
-  bool IsPageFree(page_id_t page_id);
+  virtual bool IsPageFree(page_id_t page_id);
 
-  bool CheckAllUnpinned();
+  virtual bool CheckAllUnpinned();
+
+  /**
+   * Write every cached page back, all the writes are queued before waiting for any of them.
+   */
+  virtual void FlushAllPages();
+
+  /** @return the number of frames managed by this buffer pool */
+  virtual size_t GetPoolSize() { return pool_size_; }
+
+  /**
+   * Start a background thread which writes dirty unpinned pages back in batches ordered by page id, so that a victim
+   * picked on a cache miss is usually clean and the miss only has to read.
+   * @param clean_ratio the share of unpinned frames the cleaner tries to keep clean
+   */
+  virtual void StartPageCleaner(double clean_ratio = DEFAULT_CLEAN_FRAME_RATIO);
+
+  /**
+   * Stop the page cleaner and wait for its current batch to be written.
+   */
+  virtual void StopPageCleaner();
+
+  /**
+   * Asynchronously bring pages into the pool without pinning them. Pages already cached are left alone, and the
+   * request is dropped if PREFETCH_QUEUE_SIZE requests are already waiting.
+   */
+  void Prefetch(const vector<page_id_t> &page_ids);
+
+  /**
+   * Asynchronously bring a chain of pages into the pool, such as the pages of a table heap or the leaves of a B+ tree.
+   * @param first_page_id the first page of the chain to read
+   * @param num_pages the maximum number of pages to read
+   * @param next_page returns the id of the page that follows a page, it is called with the page read latched
+   */
+  void PrefetchChain(page_id_t first_page_id, size_t num_pages, function<page_id_t(Page *)> next_page);
+
+  /**
+   * Stop the prefetcher once the queued requests are done.
+   */
+  void StopPrefetcher();
+
+ protected:
+  /**
+   * Used by subclasses which do not own any frame themselves.
+   */
+  explicit BufferPoolManager(DiskManager *disk_manager);
 
- private:
   /**
    * Allocate new page (operations like create index/table) For now just keep an increasing counter
    */
@@ -43,16 +130,80 @@ class BufferPoolManager {
    */
   void DeallocatePage(page_id_t page_id);
 
-  frame_id_t TryToFindFreePage();
+  /**
+   * Bring the pages which are not cached into the pool without pinning them. All the reads are queued at once and the
+   * pool latch is held until they complete, as on any miss.
+   */
+  virtual void LoadPages(const vector<page_id_t> &page_ids);
+
+ private:
+  /**
+   * Bring a page which is already allocated on disk into an empty frame, without reading its content.
+   * @return nullptr if all the frames are pinned
+   */
+  Page *NewPageFrame(page_id_t page_id);
+
+  /**
+   * Find a frame to hold a new page, from the free list first and then from the replacer. The old content of the
+   * frame is written back if dirty and removed from the page table.
+   * @return false if all the frames are pinned
+   */
+  bool TryToFindFreePage(frame_id_t &frame_id);
+
+  /**
+   * Return the frame of a deleted page to the free list and deallocate the page.
+   */
+  void FreeFrame(frame_id_t frame_id);
+
+  /**
+   * Body of the page cleaner thread.
+   */
+  void PageCleanerLoop();
+
+  /**
+   * Write back enough dirty unpinned pages to bring the clean share back to clean_ratio_, at most one batch. The
+   * pages are marked as being cleaned while they are written, which keeps them from being evicted without pinning
+   * them, so that a caller can still delete one, and the pool latch is released during I/O.
+   * Each page is copied under its read latch and written from the copy, so that the cleaner never waits for a page
+   * latch while holding another one, which would deadlock with a thread latching several pages, e.g. a B+ tree.
+   */
+  void CleanPages();
+
+  struct PrefetchRequest {
+    vector<page_id_t> page_ids_;            // pages to read, or the first page of a chain
+    size_t chain_length_{0};                // number of pages of the chain to read
+    function<page_id_t(Page *)> next_page_;  // follows the chain, empty for a plain list of pages
+  };
+
+  /**
+   * Queue a prefetch request, starting the prefetcher if needed.
+   */
+  void EnqueuePrefetch(PrefetchRequest &&request);
+
+  /**
+   * Body of the prefetcher thread. Pages are read through LoadPages and FetchPage, so a subclass routes them to where
+   * they belong.
+   */
+  void PrefetchLoop();
 
  private:
   size_t pool_size_;                                 // number of pages in buffer pool
+  FrameArena *frame_arena_;                          // page aligned memory of the frames
   Page *pages_;                                      // array of pages
   DiskManager *disk_manager_;                        // pointer to the disk manager.
   unordered_map<page_id_t, frame_id_t> page_table_;  // to keep track of pages
   Replacer *replacer_;                               // to find an unpinned page for replacement
   list<frame_id_t> free_list_;                       // to find a free page for replacement
   recursive_mutex latch_;                            // to protect shared data structure
+  thread cleaner_thread_;                            // writes dirty pages back in the background
+  atomic<bool> cleaner_running_{false};              // tells the page cleaner to keep running
+  condition_variable_any cleaner_cv_;                // wakes the page cleaner up
+  double clean_ratio_{DEFAULT_CLEAN_FRAME_RATIO};    // share of unpinned frames kept clean
+  thread prefetch_thread_;                           // reads pages ahead of the scans
+  deque<PrefetchRequest> prefetch_queue_;            // pending prefetch requests
+  mutex prefetch_latch_;                             // protects the prefetch queue
+  condition_variable prefetch_cv_;                   // wakes the prefetcher up
+  bool prefetcher_running_{false};                   // tells the prefetcher to keep running
 };
 
 #endif  // MINISQL_BUFFER_POOL_MANAGER_H
@@ -0,0 +1,38 @@
+#ifndef MINISQL_FRAME_ARENA_H
+#define MINISQL_FRAME_ARENA_H
+
+#include <cstddef>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+/**
+ * FrameArena is the one block of memory holding the data of every frame of a buffer pool. The block is mapped
+ * anonymously, so every frame is aligned to PAGE_SIZE as O_DIRECT requires, and the pool owns exactly
+ * pool_size * PAGE_SIZE bytes of page memory. Large arenas ask for transparent huge pages.
+ */
+class FrameArena {
+ public:
+  /**
+   * @param num_frames number of PAGE_SIZE frames in the arena
+   * @param use_huge_pages whether the arena should be backed by huge pages when it is large enough
+   */
+  explicit FrameArena(size_t num_frames, bool use_huge_pages = BUFFER_POOL_HUGE_PAGES);
+
+  ~FrameArena();
+
+  DISALLOW_COPY(FrameArena)
+
+  /** @return the data of a frame */
+  inline char *GetFrame(size_t frame_id) { return base_ + frame_id * PAGE_SIZE; }
+
+  /** @return true if the arena is backed by huge pages */
+  inline bool IsHugePageBacked() const { return huge_pages_; }
+
+ private:
+  char *base_{nullptr};
+  size_t size_{0};
+  bool huge_pages_{false};
+};
+
+#endif  // MINISQL_FRAME_ARENA_H
@@ -0,0 +1,79 @@
+#ifndef MINISQL_LRU_K_REPLACER_H
+#define MINISQL_LRU_K_REPLACER_H
+
+#include <deque>
+#include <list>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+using namespace std;
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy.
+ *
+ * The victim is the evictable frame with the largest backward k-distance, i.e. the one whose k-th most recent access
+ * is the oldest. Frames with less than k recorded accesses have an infinite distance and are evicted first, in the
+ * order of their earliest access. Repeated scan accesses to a frame are correlated and are not recorded, so pages
+ * brought in by a sequential scan keep an infinite distance.
+ *
+ * Frames are kept in two lists ordered by eviction priority, and every frame remembers its position, so Pin, Unpin
+ * and Size only flip a flag. An access moves a frame to its new position searching from the tail, which is where a
+ * re-referenced frame almost always lands.
+ */
+class LRUKReplacer : public Replacer {
+ public:
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_pages the maximum number of pages the LRUKReplacer will be required to store
+   * @param k the number of accesses remembered for every frame
+   */
+  explicit LRUKReplacer(size_t num_pages, size_t k = DEFAULT_LRU_K);
+
+  /**
+   * Destroys the LRUKReplacer.
+   */
+  ~LRUKReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  /**
+   * Make a frame evictable. A frame the replacer has never seen is treated as accessed right now.
+   */
+  void Unpin(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::DEFAULT_ACCESS) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+ private:
+  struct FrameInfo {
+    deque<size_t> history_;               // timestamps of the last k accesses, oldest first
+    list<frame_id_t>::iterator position_;  // position in history_list_ or cache_list_
+    bool tracked_{false};
+    bool evictable_{false};
+  };
+
+  /** @return true if the frame has less than k accesses and thus lives in history_list_ */
+  inline bool InHistory(const FrameInfo &info) const { return info.history_.size() < k_; }
+
+  /**
+   * Insert a frame with k accesses into cache_list_, which is ordered by the k-th most recent access.
+   */
+  void InsertIntoCache(frame_id_t frame_id);
+
+ private:
+  size_t k_;
+  size_t current_timestamp_{0};
+  size_t evictable_size_{0};
+  vector<FrameInfo> frames_;
+  list<frame_id_t> history_list_;  // frames with less than k accesses, ordered by the earliest access
+  list<frame_id_t> cache_list_;    // frames with k accesses, ordered by the k-th most recent access
+};
+
+#endif  // MINISQL_LRU_K_REPLACER_H
@@ -0,0 +1,67 @@
+#ifndef MINISQL_PARALLEL_BUFFER_POOL_MANAGER_H
+#define MINISQL_PARALLEL_BUFFER_POOL_MANAGER_H
+
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+
+/**
+ * ParallelBufferPoolManager shards the buffer pool into several independent BufferPoolManager instances. Each
+ * instance owns its frames, replacer, free list and latch, and a page is always cached by the instance that
+ * page_id % num_instances points to. Operations on pages in different instances never contend on the same latch.
+ */
+class ParallelBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * @param num_instances number of buffer pool instances
+   * @param pool_size total number of frames, split evenly among the instances
+   * @param replacer_type the replacement policy of every instance
+   */
+  explicit ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                                     ReplacerType replacer_type = ReplacerType::LRU_K_REPLACER);
+
+  ~ParallelBufferPoolManager() override;
+
+  Page *FetchPage(page_id_t page_id, AccessType access_type = AccessType::DEFAULT_ACCESS) override;
+
+  bool UnpinPage(page_id_t page_id, bool is_dirty) override;
+
+  bool FlushPage(page_id_t page_id) override;
+
+  Page *NewPage(page_id_t &page_id) override;
+
+  bool DeletePage(page_id_t page_id) override;
+
+  bool IsPageFree(page_id_t page_id) override;
+
+  bool CheckAllUnpinned() override;
+
+  void FlushAllPages() override;
+
+  size_t GetPoolSize() override;
+
+  /**
+   * Every instance runs its own page cleaner over its own frames.
+   */
+  void StartPageCleaner(double clean_ratio = DEFAULT_CLEAN_FRAME_RATIO) override;
+
+  void StopPageCleaner() override;
+
+  /** @return the number of buffer pool instances */
+  inline size_t GetNumInstances() const { return instances_.size(); }
+
+ protected:
+  /**
+   * The pages are split by instance, every instance loads its share as one batch.
+   */
+  void LoadPages(const vector<page_id_t> &page_ids) override;
+
+ private:
+  /** @return the instance responsible for page_id */
+  inline BufferPoolManager *GetInstance(page_id_t page_id) { return instances_[page_id % instances_.size()]; }
+
+ private:
+  std::vector<BufferPoolManager *> instances_;
+};
+
+#endif  // MINISQL_PARALLEL_BUFFER_POOL_MANAGER_H
@@ -5,6 +5,17 @@
 
 #include "common/config.h"
 
+/**
+ * Replacement policies the buffer pool manager can be constructed with.
+ */
+enum class ReplacerType { LRU_REPLACER = 0, CLOCK_REPLACER, LRU_K_REPLACER, TWO_QUEUE_REPLACER };
+
+/**
+ * How a page is accessed. Pages touched by a sequential scan are unlikely to be needed again soon, so scan-resistant
+ * policies evict them before the others.
+ */
+enum class AccessType { DEFAULT_ACCESS = 0, SCAN_ACCESS };
+
 /**
  * Replacer is an abstract class that tracks page usage.
  */
@@ -35,6 +46,19 @@ class Replacer {
 
   /** @return the number of elements in the replacer that can be victimized */
   virtual size_t Size() = 0;
+
+  /**
+   * Records that the page held in a frame has been accessed. Policies which only track unpinned frames ignore it.
+   * @param frame_id the id of the accessed frame
+   * @param access_type how the page is accessed
+   */
+  virtual void RecordAccess(frame_id_t /* frame_id */, AccessType /* access_type */ = AccessType::DEFAULT_ACCESS) {}
+
+  /**
+   * Drops everything the replacer knows about a frame, called when the page in the frame is deleted.
+   * @param frame_id the id of the frame to forget
+   */
+  virtual void Remove(frame_id_t frame_id) { Pin(frame_id); }
 };
 
 #endif  // MINISQL_REPLACER_H
@@ -0,0 +1,77 @@
+#ifndef MINISQL_TWO_QUEUE_REPLACER_H
+#define MINISQL_TWO_QUEUE_REPLACER_H
+
+#include <list>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+using namespace std;
+
+/**
+ * TwoQueueReplacer implements a scan-resistant 2Q replacement policy.
+ *
+ * A frame seen once waits in the FIFO queue A1 and only moves to the LRU queue Am when it is referenced again, so a
+ * burst of pages touched once cannot push the re-referenced pages out. Victims come from A1 while it holds more than
+ * its share of the frames, and from Am otherwise.
+ *
+ * Frames fetched by a sequential scan go to a third FIFO queue which is always emptied first. A scan access never
+ * promotes a frame, and a frame that is already hot stays where it is when a scan touches it.
+ */
+class TwoQueueReplacer : public Replacer {
+ public:
+  /**
+   * Create a new TwoQueueReplacer.
+   * @param num_pages the maximum number of pages the TwoQueueReplacer will be required to store
+   * @param a1_ratio the share of frames A1 can hold before its frames are evicted first
+   */
+  explicit TwoQueueReplacer(size_t num_pages, double a1_ratio = 0.25);
+
+  /**
+   * Destroys the TwoQueueReplacer.
+   */
+  ~TwoQueueReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  /**
+   * Make a frame evictable. A frame the replacer has never seen is treated as accessed right now.
+   */
+  void Unpin(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::DEFAULT_ACCESS) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+ private:
+  enum class QueueType { NONE = 0, SCAN_QUEUE, A1_QUEUE, AM_QUEUE };
+
+  struct FrameInfo {
+    QueueType queue_{QueueType::NONE};
+    list<frame_id_t>::iterator position_;
+    bool evictable_{false};
+  };
+
+  list<frame_id_t> &GetQueue(QueueType queue);
+
+  /** Move a frame to the tail of a queue, taking it out of its current queue first */
+  void MoveTo(frame_id_t frame_id, QueueType queue);
+
+  /** Take the first evictable frame out of a queue */
+  bool VictimFrom(QueueType queue, frame_id_t *frame_id);
+
+ private:
+  size_t a1_capacity_;
+  size_t evictable_size_{0};
+  vector<FrameInfo> frames_;
+  list<frame_id_t> scan_queue_;  // frames only touched by sequential scans, in FIFO order
+  list<frame_id_t> a1_queue_;    // frames referenced once, in FIFO order
+  list<frame_id_t> am_queue_;    // frames referenced more than once, in LRU order
+};
+
+#endif  // MINISQL_TWO_QUEUE_REPLACER_H
@@ -78,6 +78,15 @@ class CatalogManager {
 
   dberr_t CreateTable(const std::string &table_name, TableSchema *schema, Txn *txn, TableInfo *&table_info);
 
+  /**
+   * Create an index-organized table, whose rows are stored in a clustered index on the key column instead of a table
+   * heap, see ClusteredIndex. The clustered index is named index_name, it is not listed among the indexes of the
+   * table, and the table takes no other index.
+   * @return DB_FAILED if the rows of the schema are too large for a clustered index
+   */
+  dberr_t CreateIndexOrganizedTable(const std::string &table_name, TableSchema *schema, const std::string &key_column,
+                                    const std::string &index_name, Txn *txn, TableInfo *&table_info);
+
   dberr_t GetTable(const std::string &table_name, TableInfo *&table_info);
 
   dberr_t GetTables(std::vector<TableInfo *> &tables) const;
@@ -94,6 +103,11 @@ class CatalogManager {
 
   dberr_t DropIndex(const std::string &table_name, const std::string &index_name);
 
+  /** @return the number of threads that extract and sort the keys of a large table in CreateIndex */
+  uint32_t GetIndexBuildWorkers() const { return index_build_workers_; }
+
+  void SetIndexBuildWorkers(uint32_t index_build_workers) { index_build_workers_ = index_build_workers; }
+
  private:
   dberr_t DropTable(table_id_t table_id);
 
@@ -118,6 +132,8 @@ class CatalogManager {
   // map for indexes: table_name->index_name->indexes
   std::unordered_map<std::string, std::unordered_map<std::string, index_id_t>> index_names_;
   std::unordered_map<index_id_t, IndexInfo *> indexes_;
+  // threads of an index build, 1 to build serially
+  uint32_t index_build_workers_;
 };
 
 #endif  // MINISQL_CATALOG_H
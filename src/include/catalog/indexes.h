@@ -7,6 +7,7 @@
 #include "common/macros.h"
 #include "common/rowid.h"
 #include "index/b_plus_tree_index.h"
+#include "index/clustered_index.h"
 #include "index/generic_key.h"
 #include "record/schema.h"
 
@@ -14,8 +15,11 @@ class IndexMetadata {
   friend class IndexInfo;
 
  public:
+  /**
+   * @param clustered whether the index is the clustered index of an index-organized table, see ClusteredIndex
+   */
   static IndexMetadata *Create(const index_id_t index_id, const std::string &index_name, const table_id_t table_id,
-                               const std::vector<uint32_t> &key_map);
+                               const std::vector<uint32_t> &key_map, bool clustered = false);
 
   uint32_t SerializeTo(char *buf) const;
 
@@ -33,18 +37,21 @@ class IndexMetadata {
 
   inline index_id_t GetIndexId() const { return index_id_; }
 
+  inline bool IsClustered() const { return clustered_; }
+
  private:
   IndexMetadata() = delete;
 
   explicit IndexMetadata(const index_id_t index_id, const std::string &index_name, const table_id_t table_id,
-                         const std::vector<uint32_t> &key_map);
+                         const std::vector<uint32_t> &key_map, bool clustered);
 
  private:
-  static constexpr uint32_t INDEX_METADATA_MAGIC_NUM = 344528;
+  static constexpr uint32_t INDEX_METADATA_MAGIC_NUM = 344530;  // bumped for the clustered flag
   index_id_t index_id_;
   std::string index_name_;
   table_id_t table_id_;
   std::vector<uint32_t> key_map_; /** The mapping of index key to tuple key */
+  bool clustered_;
 };
 
 /**
@@ -70,11 +77,21 @@ class IndexInfo {
     //ASSERT(false, "Not Implemented yet.");
     this->meta_data_ = meta_data;
     key_schema_ = Schema::ShallowCopySchema(table_info->GetSchema(), meta_data->GetKeyMapping());
+    if (meta_data->IsClustered()) {
+      // the rows of the table are the entries of the index
+      auto index = new ClusteredIndex(meta_data->GetIndexId(), key_schema_, table_info->GetSchema(),
+                                      meta_data->GetKeyMapping()[0], buffer_pool_manager);
+      table_info->SetClusteredIndex(index);
+      index_ = index;
+      return;
+    }
     index_ = CreateIndex(buffer_pool_manager, "bptree");
   }
 
   inline Index *GetIndex() { return index_; }
 
+  inline bool IsClustered() const { return meta_data_->IsClustered(); }
+
   std::string GetIndexName() { return meta_data_->GetIndexName(); }
 
   IndexSchema *GetIndexKeySchema() { return key_schema_; }
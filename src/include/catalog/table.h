@@ -7,6 +7,8 @@
 #include "record/schema.h"
 #include "storage/table_heap.h"
 
+class ClusteredIndex;
+
 class TableMetadata {
   friend class TableInfo;
 
@@ -23,7 +25,7 @@ class TableMetadata {
    * will create new table schema and owned by mem heap
    */
   static TableMetadata *Create(table_id_t table_id, std::string table_name, page_id_t root_page_id,
-                               TableSchema *schema);
+                               page_id_t fsm_page_id, page_id_t zone_map_page_id, TableSchema *schema);
 
   inline table_id_t GetTableId() const { return table_id_; }
 
@@ -31,18 +33,28 @@ class TableMetadata {
 
   inline uint32_t GetFirstPageId() const { return root_page_id_; }
 
+  /** An index-organized table has no table heap, its rows are stored in its clustered index. */
+  inline bool IsIndexOrganized() const { return root_page_id_ == INVALID_PAGE_ID; }
+
+  inline page_id_t GetFreeSpaceMapPageId() const { return fsm_page_id_; }
+
+  inline page_id_t GetZoneMapPageId() const { return zone_map_page_id_; }
+
   inline Schema *GetSchema() const { return schema_; }
 
  private:
   TableMetadata() = delete;
 
-  TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, TableSchema *schema);
+  TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, page_id_t fsm_page_id,
+                page_id_t zone_map_page_id, TableSchema *schema);
 
  private:
-  static constexpr uint32_t TABLE_METADATA_MAGIC_NUM = 344528;
+  static constexpr uint32_t TABLE_METADATA_MAGIC_NUM = 344529;  // bumped for the free-space and zone map pages
   table_id_t table_id_;
   std::string table_name_;
   page_id_t root_page_id_;
+  page_id_t fsm_page_id_;
+  page_id_t zone_map_page_id_;
   Schema *schema_;
 };
 
@@ -63,8 +75,17 @@ class TableInfo {
     table_heap_ = table_heap;
   }
 
+  /** @return the table heap, nullptr for an index-organized table */
   inline TableHeap *GetTableHeap() const { return table_heap_; }
 
+  inline bool IsIndexOrganized() const { return table_meta_->IsIndexOrganized(); }
+
+  /** @return the index which stores the rows of an index-organized table, nullptr for a heap table */
+  inline ClusteredIndex *GetClusteredIndex() const { return clustered_index_; }
+
+  /** Set by the clustered index when it is created or loaded, it is owned by its IndexInfo. */
+  inline void SetClusteredIndex(ClusteredIndex *clustered_index) { clustered_index_ = clustered_index; }
+
   inline table_id_t GetTableId() const { return table_meta_->table_id_; }
 
   inline std::string GetTableName() const { return table_meta_->table_name_; }
@@ -79,6 +100,7 @@ class TableInfo {
  private:
   TableMetadata *table_meta_;
   TableHeap *table_heap_;
+  ClusteredIndex *clustered_index_{nullptr};
 };
 
 #endif  // MINISQL_TABLE_H
@@ -13,11 +13,34 @@ static constexpr int META_PAGE_ID = 0;          // physical page id of the disk
 static constexpr int CATALOG_META_PAGE_ID = 0;  // logical page id of the catalog meta data
 static constexpr int INDEX_ROOTS_PAGE_ID = 1;   // logical page id of the index roots
 
-static constexpr int PAGE_SIZE = 4096;                  // size of a data page in byte
-static constexpr int DEFAULT_BUFFER_POOL_SIZE = 20480;  // default size of buffer pool
+static constexpr int PAGE_SIZE = 4096;                   // size of a data page in byte
+static constexpr int DEFAULT_BUFFER_POOL_SIZE = 20480;   // default size of buffer pool
+static constexpr int DEFAULT_BUFFER_POOL_INSTANCES = 8;  // default number of buffer pool instances
+static constexpr int DEFAULT_LRU_K = 2;                  // default number of accesses tracked by LRU-K
+static constexpr bool BUFFER_POOL_HUGE_PAGES = true;     // back large buffer pools with huge pages
+
+static constexpr double DEFAULT_CLEAN_FRAME_RATIO = 0.25;  // share of unpinned frames the page cleaner keeps clean
+static constexpr int PAGE_CLEANER_INTERVAL_MS = 10;        // how often the page cleaner wakes up by itself
+static constexpr int PAGE_CLEANER_BATCH_SIZE = 64;         // max number of pages the page cleaner writes per round
+
+static constexpr int READ_AHEAD_TRIGGER = 2;    // page hops in a row before a scan is considered sequential
+static constexpr int READ_AHEAD_PAGES = 8;      // number of pages a sequential scan reads ahead
+static constexpr int PREFETCH_QUEUE_SIZE = 32;  // max number of pending prefetch requests
+static constexpr int IO_URING_QUEUE_DEPTH = 64;  // number of submission queue entries of the io_uring backend
+
+static constexpr int PARALLEL_SCAN_WORKERS = 0;        // worker threads of a parallel scan, 0 for one per core
+static constexpr int PARALLEL_SCAN_MIN_PAGES = 64;     // smaller tables are scanned by a single thread
+static constexpr int PARALLEL_SCAN_MORSEL_PAGES = 16;  // number of pages a scan worker claims at a time
+static constexpr int PARALLEL_SCAN_BATCH_ROWS = 256;   // rows a scan worker hands over at a time
+
+static constexpr double INDEX_BUILD_FILL_FACTOR = 0.9;               // share of a page a bulk load fills
+static constexpr size_t INDEX_BUILD_SORT_MEMORY = 64 * 1024 * 1024;  // bytes of entries sorted in memory per run
+static constexpr int INDEX_BUILD_WORKERS = 0;                        // threads of an index build, 0 for one per core
+static constexpr int INDEX_BUILD_MIN_PAGES = 64;                     // smaller tables are indexed by a single thread
 
 static constexpr uint32_t FIELD_NULL_LEN = UINT32_MAX;
-static constexpr uint32_t VARCHAR_MAX_LEN = PAGE_SIZE / 2;  // max length of varchar
+static constexpr uint32_t VARCHAR_MAX_LEN = 64 * PAGE_SIZE;  // max length of varchar, long ones are stored out of line
+static constexpr uint32_t EXTERNAL_THRESHOLD = PAGE_SIZE / 8;  // longer char values are stored out of line
 
 // static std::string DB_META_FILE = "minisql.meta.db";
 
@@ -5,6 +5,8 @@
 #ifndef MINISQL_EXECUTE_CONTEXT_H
 #define MINISQL_EXECUTE_CONTEXT_H
 
+#include <thread>
+
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/catalog.h"
 #include "common/macros.h"
@@ -19,7 +21,10 @@ class ExecuteContext {
    * @param bpm The buffer pool manager that the executor uses
    */
   ExecuteContext(Txn *transaction, CatalogManager *catalog, BufferPoolManager *bpm)
-      : transaction_(transaction), catalog_{catalog}, bpm_{bpm} {}
+      : transaction_(transaction),
+        catalog_{catalog},
+        bpm_{bpm},
+        scan_workers_(PARALLEL_SCAN_WORKERS > 0 ? PARALLEL_SCAN_WORKERS : std::thread::hardware_concurrency()) {}
 
   ~ExecuteContext() = default;
 
@@ -34,6 +39,11 @@ class ExecuteContext {
   /** @return the buffer pool manager */
   BufferPoolManager *GetBufferPoolManager() { return bpm_; }
 
+  /** @return the number of threads a sequential scan may use */
+  uint32_t GetScanWorkers() const { return scan_workers_; }
+
+  void SetScanWorkers(uint32_t scan_workers) { scan_workers_ = scan_workers; }
+
  private:
   /** The recovery context associated with this executor context */
   Txn *transaction_;
@@ -41,6 +51,8 @@ class ExecuteContext {
   CatalogManager *catalog_;
   /** The buffer pool manager associated with this executor context */
   BufferPoolManager *bpm_;
+  /** The number of threads of a parallel sequential scan, 1 to scan serially */
+  uint32_t scan_workers_;
 };
 
 #endif  // MINISQL_EXECUTE_CONTEXT_H
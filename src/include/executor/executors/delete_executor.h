@@ -14,6 +14,9 @@
 /**
  * DeletedExecutor executes a delete on a table.
  * Deleted values are always pulled from a child.
+ *
+ * The rows of an index-organized table are all pulled on the first call to Next before any is removed from the
+ * clustered index, which the child scans.
  */
 class DeleteExecutor : public AbstractExecutor {
  public:
@@ -49,6 +52,10 @@ class DeleteExecutor : public AbstractExecutor {
   TableInfo *table_info_{};
   Txn *txn_;
   std::vector<IndexInfo *> index_info_;
+  /** The rows to remove from the clustered index of an index-organized table */
+  std::vector<Row> clustered_rows_;
+  bool collected_{false};
+  size_t cursor_{0};
   /** The child executor from which RIDs for deleted rows are pulled */
   std::unique_ptr<AbstractExecutor> child_executor_;
 };
@@ -5,6 +5,7 @@
 #include "executor/execute_context.h"
 #include "executor/executors/abstract_executor.h"
 #include "executor/plans/index_scan_plan.h"
+#include "page/table_page.h"
 #include "planner/expressions/column_value_expression.h"
 #include "planner/expressions/comparison_expression.h"
 
@@ -36,8 +37,6 @@ class IndexScanExecutor : public AbstractExecutor {
 
   bool SchemaEqual(const Schema *table_schema, const Schema *output_schema);
 
-  void TupleTransfer(const Schema *table_schema, const Schema *output_schema, const Row *row, Row *output_row);
-
  private:
   vector<RowId> IndexScan(AbstractExpressionRef predicate);
 
@@ -46,5 +45,7 @@ class IndexScanExecutor : public AbstractExecutor {
   TableInfo *table_info_{};
   vector<RowId> result_;
   size_t cursor_ = 0;
+  // rows are filtered in their page before they are copied out
+  RowView view_;
   bool is_schema_same_;
 };
\ No newline at end of file
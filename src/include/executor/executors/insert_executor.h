@@ -12,7 +12,8 @@
 /**
  * InsertExecutor executes an insert on a table.
  *
- * Inserted values are always pulled from a child executor.
+ * Inserted values are always pulled from a child executor. They are all pulled on the first call to Next and
+ * appended to the table heap as one batch, then the index entries are added.
  */
 class InsertExecutor : public AbstractExecutor {
  public:
@@ -41,6 +42,20 @@ class InsertExecutor : public AbstractExecutor {
   /** @return The output schema for the insert */
   const Schema *GetOutputSchema() const override { return plan_->OutputSchema(); }
 
+ private:
+  /**
+   * Pull every row from the child, stopping before the first one whose key already exists, and insert them.
+   * @return number of rows inserted
+   */
+  size_t InsertAll();
+
+  /**
+   * Pull every row from the child into the clustered index of an index-organized table, stopping at the first one
+   * whose key already exists.
+   * @return number of rows inserted
+   */
+  size_t InsertAllClustered(ClusteredIndex *clustered_index);
+
  private:
   /** The insert plan node to be executed*/
   const InsertPlanNode *plan_;
@@ -48,6 +63,9 @@ class InsertExecutor : public AbstractExecutor {
   TableInfo *table_info_{};
   const Schema *schema_{};
   std::vector<IndexInfo *> index_info_;
+  bool inserted_{false};
+  size_t num_inserted_{0};
+  size_t cursor_{0};
 };
 
 #endif  // MINISQL_INSERT_EXECUTOR_H
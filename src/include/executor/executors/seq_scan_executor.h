@@ -5,14 +5,34 @@
 #ifndef MINISQL_SEQ_SCAN_EXECUTOR_H
 #define MINISQL_SEQ_SCAN_EXECUTOR_H
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 #include "executor/execute_context.h"
 #include "executor/executors/abstract_executor.h"
 #include "executor/plans/seq_scan_plan.h"
+#include "index/clustered_index.h"
 
 /**
  * The SeqScanExecutor executor executes a sequential table scan.
+ *
+ * The predicate is evaluated on a view of each tuple in its page, only the rows that pass it are copied out.
+ *
+ * A large table is scanned in parallel when the context allows more than one worker: the page directory of the table
+ * is split into morsels of PARALLEL_SCAN_MORSEL_PAGES pages, which the workers claim one at a time, filter and hand
+ * over in batches to Next, which gathers them. The rows are then produced in no particular order.
+ *
+ * With a predicate, the zone maps of the table pages are checked first and the pages which cannot hold a matching
+ * tuple are not read at all.
+ *
+ * An index-organized table is scanned in key order through the leaves of its clustered index. The comparisons of the
+ * key column with a constant which the predicate requires narrow the scan to a range of keys, so that a lookup by key
+ * only reads the pages on the path to its leaf.
  */
 class SeqScanExecutor : public AbstractExecutor {
  public:
@@ -23,6 +43,8 @@ class SeqScanExecutor : public AbstractExecutor {
    */
   SeqScanExecutor(ExecuteContext *exec_ctx, const SeqScanPlanNode *plan);
 
+  ~SeqScanExecutor() override;
+
   /** Initialize the sequential scan */
   void Init() override;
 
@@ -39,15 +61,76 @@ class SeqScanExecutor : public AbstractExecutor {
 
   bool SchemaEqual(const Schema *table_schema, const Schema *output_schema);
 
-  void TupleTransfer(const Schema *table_schema, const Schema *output_schema, const Row *row, Row *output_row);
-
  private:
+  /**
+   * Move the iterator to the next row that passes the predicate and copy it out.
+   * @return false at the end of the iterator
+   */
+  bool ScanNext(TableIterator &iterator, Row *row);
+
+  /**
+   * Point the iterator to the next run of pages of the directory, in [cursor, end), which the zone maps do not rule
+   * out, and move the cursor past it.
+   * @return false if there is no such page left
+   */
+  bool NextPageRange(size_t &cursor, size_t end, TableIterator &iterator);
+
+  /** Body of a worker of a parallel scan, which filters morsels until there are none left. */
+  void ScanMorsels();
+
+  /**
+   * Hand over a batch of rows from a worker, waiting while the queue is full.
+   * @return false if the scan is stopped
+   */
+  bool Gather(std::vector<Row> &batch);
+
+  /** Stop the workers of a parallel scan and wait for them. */
+  void StopWorkers();
+
+  /** Narrow the key range of an index-organized table to the keys the predicate may accept. */
+  void NarrowKeyRange(const AbstractExpression *predicate);
+
+  /**
+   * Move the iterator of an index-organized table to the next row in the key range that passes the predicate and copy
+   * it out.
+   * @return false at the end of the range
+   */
+  bool ScanIndexNext(Row *row);
+
   /** The sequential scan plan node to be executed */
   const SeqScanPlanNode *plan_;
   TableInfo *table_info_{};
   TableIterator iterator_;
   const Schema *schema_{};
   bool is_schema_same_;
+
+  // page directory of the table, empty if the scan follows the page list
+  std::vector<page_id_t> pages_;
+  std::vector<bool> may_match_;
+  // next page of the directory for a serial scan
+  size_t page_cursor_{0};
+
+  // state of a parallel scan
+  bool parallel_{false};
+  std::atomic<size_t> next_morsel_{0};
+  std::vector<std::thread> workers_;
+  std::mutex gather_latch_;
+  std::condition_variable gather_cv_;
+  std::deque<std::vector<Row>> gather_queue_;
+  size_t num_workers_{0};
+  size_t active_workers_{0};
+  bool stopped_{false};
+  // the batch being consumed by Next
+  std::vector<Row> batch_;
+  size_t batch_cursor_{0};
+
+  // state of the scan of an index-organized table, the key range is open on a side without a key
+  ClusteredIndex *clustered_index_{nullptr};
+  IndexIterator index_iterator_;
+  RowView view_;
+  std::unique_ptr<Field> lower_key_;
+  std::unique_ptr<Field> upper_key_;
+  bool upper_inclusive_{true};
 };
 
 #endif  // MINISQL_SEQ_SCAN_EXECUTOR_H
@@ -5,6 +5,8 @@
 #ifndef MINISQL_UPDATE_EXECUTOR_H
 #define MINISQL_UPDATE_EXECUTOR_H
 
+#include <unordered_set>
+
 #include "executor/execute_context.h"
 #include "executor/executors/abstract_executor.h"
 #include "executor/plans/update_plan.h"
@@ -12,6 +14,10 @@
 /**
  * UpdateExecutor executes an update on a table.
  * Updated values are always pulled from a child.
+ *
+ * The rows of an index-organized table are all pulled and updated on the first call to Next: the old versions are
+ * removed from the clustered index before the new ones are inserted, so that keys may be shifted, e.g. by id = id + 1.
+ * If a new key collides, the update is undone as a whole.
  */
 class UpdateExecutor : public AbstractExecutor {
   friend class UpdatePlanNode;
@@ -51,12 +57,32 @@ class UpdateExecutor : public AbstractExecutor {
    */
   Row GenerateUpdatedTuple(const Row &src_row);
 
+  /**
+   * Move the entry of a row in an index to its new version, nothing is done if both the key and the rid are the same.
+   */
+  void UpdateIndex(IndexInfo *info, const Row &src_row, const RowId &src_rid, const Row &dest_row,
+                   const RowId &dest_rid);
+
+  /**
+   * Update every row of an index-organized table pulled from the child.
+   * @return number of rows updated, 0 if the update is undone
+   */
+  size_t UpdateAllClustered(ClusteredIndex *clustered_index);
+
   /** The update plan node to be executed */
   const UpdatePlanNode *plan_;
   /** Metadata identifying the table that should be updated */
   TableInfo *table_info_;
   Txn *txn_;
   std::vector<IndexInfo *> index_info_;
+  /** The indexes with a key column set by the update */
+  std::vector<IndexInfo *> updated_index_info_;
+  /** Rids of the new versions which moved to another page */
+  std::unordered_set<RowId> moved_rids_;
+  /** Progress of the update of an index-organized table */
+  bool updated_{false};
+  size_t num_updated_{0};
+  size_t cursor_{0};
   /** The child executor to obtain value from */
   std::unique_ptr<AbstractExecutor> child_executor_;
 };
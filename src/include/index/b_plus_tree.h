@@ -1,10 +1,13 @@
 #ifndef MINISQL_B_PLUS_TREE_H
 #define MINISQL_B_PLUS_TREE_H
 
+#include <fstream>
+#include <functional>
 #include <queue>
 #include <string>
 #include <vector>
 
+#include "common/rwlatch.h"
 #include "concurrency/txn.h"
 #include "index/index_iterator.h"
 #include "page/b_plus_tree_internal_page.h"
@@ -20,11 +23,39 @@
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ *
+ * The tree is safe to use from several threads, with latch crabbing on the page latches:
+ * - A lookup read latches each page of the path down to its leaf, and releases a page once its child is latched.
+ * - A writer first descends optimistically the same way, but write latches the leaf. If the leaf would split or
+ *   underflow, it releases everything and restarts with write latches on the path, releasing the latched ancestors
+ *   whenever it reaches a page that cannot split or underflow with the change.
+ * The root page id is protected by a root latch, held like the latch of a parent of the root. A page is latched while
+ * its parent is held, or by a thread that then waits for no other latch. Siblings, on either side of a page, are only
+ * latched by a writer that holds their parent, so a thread holding one of them without the parent releases it without
+ * waiting, whatever order the writer latches them in.
+ *
+ * A writer that splits, merges or redistributes pages rewrites the parent page id of children it has not latched. The
+ * parent page id of a page is therefore only read with the latch of its parent held, or the root latch for the root,
+ * and an optimistic writer tells whether its leaf is the root from its descent instead.
+ *
+ * Iterators are not safe against concurrent writers: the entry of an iterator is read without a latch, so a scan must
+ * not run while the tree is being written.
  */
 class BPlusTree {
   using InternalPage = BPlusTreeInternalPage;
   using LeafPage = BPlusTreeLeafPage;
 
+  /** The operations that descend the tree, to know whether a page is safe for them. */
+  enum class Operation { kFind, kInsert, kRemove };
+
+  /** The pages of a level of a bulk load that are not in their parent yet, they are pinned. */
+  struct BulkLoadLevel {
+    // the last full page, added to its parent with the next one
+    Page *full{nullptr};
+    // the page being filled
+    Page *open{nullptr};
+  };
+
  public:
   explicit BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager, const KeyManager &comparator,
                      int leaf_max_size = UNDEFINED_SIZE, int internal_max_size = UNDEFINED_SIZE);
@@ -35,6 +66,16 @@ class BPlusTree {
   // Insert a key-value pair into this B+ tree.
   bool Insert(GenericKey *key, const RowId &value, Txn *transaction = nullptr);
 
+  /**
+   * Build the empty tree bottom-up from entries in key order, instead of inserting them one by one. The pages of each
+   * level are filled to fill_factor of their capacity from left to right, and an entry with the same key as the one
+   * before it is skipped, as Insert would reject it.
+   * @param next_entry reads the next entry, returns false after the last one
+   * @return false if the tree is not empty
+   */
+  bool BulkLoad(const std::function<bool(GenericKey *&key, RowId &value)> &next_entry,
+                double fill_factor = INDEX_BUILD_FILL_FACTOR);
+
   // Remove a key and its value from this B+ tree.
   void Remove(const GenericKey *key, Txn *transaction = nullptr);
 
@@ -47,7 +88,7 @@ class BPlusTree {
 
   IndexIterator End();
 
-  // expose for test purpose
+  // expose for test purpose, the leaf is pinned but not latched
   Page *FindLeafPage(const GenericKey *key, page_id_t page_id = INVALID_PAGE_ID, bool leftMost = false);
 
   // used to check whether all pages are unpinned
@@ -68,9 +109,46 @@ class BPlusTree {
   }
 
  private:
+  /**
+   * Descend to the leaf of a key, or the leftmost one, with read latches on the path.
+   * @param write_leaf whether the leaf is write latched instead, for an optimistic writer
+   * @param[out] is_root whether the leaf is the root, which stays true while it is latched
+   * @return the latched and pinned leaf, nullptr if the tree is empty
+   */
+  Page *FindLeafPageOptimistic(const GenericKey *key, bool left_most, bool write_leaf, bool *is_root = nullptr);
+
+  /**
+   * Descend to the leaf of a key with write latches on the path, with the root latch write latched by the caller. The
+   * ancestors of a page safe for the operation are released on the way.
+   * @param latched_pages the latched and pinned pages that are kept, from the top down to the leaf
+   * @param root_latched whether the root latch is still held
+   */
+  Page *FindLeafPagePessimistic(const GenericKey *key, Operation operation, std::vector<Page *> &latched_pages,
+                                bool &root_latched);
+
+  /** Release the pages and the root latch kept by FindLeafPagePessimistic. */
+  void ReleaseLatchedPages(std::vector<Page *> &latched_pages, bool &root_latched);
+
+  /**
+   * @param is_root whether the page is the root, see the class comment for reading it from the page
+   * @return whether the operation cannot split or underflow the page, so that its ancestors are not changed
+   */
+  bool IsSafe(const BPlusTreePage *node, Operation operation, bool is_root) const;
+
   void StartNewTree(GenericKey *key, const RowId &value);
 
-  bool InsertIntoLeaf(GenericKey *key, const RowId &value, Txn *transaction = nullptr);
+  /** @return the number of entries a bulk load puts in a page */
+  int BulkLoadFill(int max_size, int min_entries, double fill_factor) const;
+
+  Page *BulkLoadNewPage(bool is_leaf);
+
+  /** Add a full page to the internal page being filled at a level of a bulk load, and unpin it. */
+  void BulkLoadAddChild(std::vector<BulkLoadLevel> &levels, size_t level, Page *child, int internal_fill);
+
+  /** Add the last pages of each level of a bulk load to their parents, and set the root. */
+  void BulkLoadFinish(std::vector<BulkLoadLevel> &levels, int internal_fill);
+
+  bool InsertIntoLeaf(LeafPage *leaf_page, GenericKey *key, const RowId &value, Txn *transaction = nullptr);
 
   void InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlusTreePage *new_node, Txn *transaction = nullptr);
 
@@ -102,6 +180,8 @@ class BPlusTree {
 
   // member variable
   index_id_t index_id_;
+  // protects root_page_id_
+  ReaderWriterLatch root_latch_;
   page_id_t root_page_id_{INVALID_PAGE_ID};
   BufferPoolManager *buffer_pool_manager_;
   KeyManager processor_;
@@ -1,13 +1,19 @@
 #ifndef MINISQL_B_PLUS_TREE_INDEX_H
 #define MINISQL_B_PLUS_TREE_INDEX_H
 
+#include <functional>
+
 #include "index/b_plus_tree.h"
 #include "index/generic_key.h"
 #include "index/index.h"
 
 class BPlusTreeIndex : public Index {
  public:
-  BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size, BufferPoolManager *buffer_pool_manager);
+  /**
+   * @param has_payload whether the keys carry a payload after their encoding, see KeyManager
+   */
+  BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size, BufferPoolManager *buffer_pool_manager,
+                 bool has_payload = false);
 
   dberr_t InsertEntry(const Row &key, RowId row_id, Txn *txn) override;
 
@@ -17,6 +23,22 @@ class BPlusTreeIndex : public Index {
 
   dberr_t Destroy() override;
 
+  /** A source of entries of a bulk load, which reads the key and the row id of the next one, false after the last. */
+  using EntrySource = std::function<bool(Row &key, RowId &row_id)>;
+
+  /**
+   * Build the empty index bottom-up, see BPlusTree::BulkLoad. The entries are sorted first by a KeySorter, which
+   * spills sorted runs to temporary files past sort_memory bytes.
+   *
+   * With several sources, e.g. the page ranges of a table, each one is read and sorted by its own thread with an even
+   * share of the memory, and the sorted runs of all of them are merged into the tree. The entries of a source come
+   * before the ones of the sources after it when their keys are equal.
+   * @param sources the entries, in any order
+   * @return DB_FAILED if the index is not empty
+   */
+  dberr_t BulkLoad(const std::vector<EntrySource> &sources, Txn *txn, size_t sort_memory = INDEX_BUILD_SORT_MEMORY,
+                   double fill_factor = INDEX_BUILD_FILL_FACTOR);
+
   IndexIterator GetBeginIterator();
 
   IndexIterator GetBeginIterator(GenericKey *key);
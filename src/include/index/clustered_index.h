@@ -0,0 +1,72 @@
+#ifndef MINISQL_CLUSTERED_INDEX_H
+#define MINISQL_CLUSTERED_INDEX_H
+
+#include "index/b_plus_tree_index.h"
+#include "record/row_view.h"
+
+/**
+ * A clustered index stores the rows of an index-organized table in the leaves of its B+ tree, ordered by the key
+ * column, instead of pointing into a table heap. A lookup or a range scan on the key then only reads index pages.
+ *
+ * The key of an entry is the encoded key column, see KeyManager, followed by the whole serialized row as its payload,
+ * see Row for the format, and the row id of the entry is unused. A search key is the encoded key alone.
+ *
+ * The entries of the tree have a fixed size, made for the largest row of the schema, so the rows of an index-organized
+ * table are limited to MAX_ROW_SIZE bytes, which keeps several of them in a page.
+ */
+class ClusteredIndex : public BPlusTreeIndex {
+ public:
+  /**
+   * @param key_schema the schema of the key column
+   * @param table_schema the schema of the rows
+   */
+  ClusteredIndex(index_id_t index_id, IndexSchema *key_schema, Schema *table_schema, uint32_t key_column,
+                 BufferPoolManager *buffer_pool_manager);
+
+  /** @return the serialized size of the largest row of the schema */
+  static uint32_t GetMaxRowSize(const Schema *schema);
+
+  /**
+   * Insert a row.
+   * @return DB_ALREADY_EXIST if there is a row with the same key, DB_FAILED if the key is null or the row too large
+   */
+  dberr_t InsertRow(const Row &row, Txn *txn);
+
+  /** Remove the row with the key of the given row, if any. */
+  dberr_t RemoveRow(const Row &row, Txn *txn);
+
+  /**
+   * Look up the row with the given key.
+   * @return DB_KEY_NOT_FOUND if there is none
+   */
+  dberr_t GetRow(const Field &key, Row *row);
+
+  using BPlusTreeIndex::GetBeginIterator;
+
+  /**
+   * @return an iterator at the first row whose key is not less than the given one, or at the first row if the value
+   * cannot be a key of the index
+   */
+  IndexIterator GetBeginIterator(const Field &key);
+
+  /** Point the view to the row of an entry of the tree, it is valid as long as the leaf stays pinned. */
+  void GetRowView(const GenericKey *entry, RowView *view) const;
+
+  inline uint32_t GetKeyColumn() const { return key_column_; }
+
+  static constexpr uint32_t MAX_ROW_SIZE = PAGE_SIZE / 8;
+
+ private:
+  /**
+   * Serialize the search key for a value of the key column.
+   * @return false if the value cannot be a key of the index
+   */
+  bool MakeSearchKey(const Field &key, GenericKey *key_buf) const;
+
+  Schema *table_schema_;
+  uint32_t key_column_;
+  // offset of the row in an entry
+  uint32_t row_offset_;
+};
+
+#endif  // MINISQL_CLUSTERED_INDEX_H
@@ -3,6 +3,7 @@
 
 #include <cstring>
 
+#include "index/basic_comparator.h"
 #include "record/field.h"
 #include "record/row.h"
 
@@ -11,50 +12,99 @@ class GenericKey {
   char data[0];
 };
 
+/**
+ * Compares keys of exactly N bytes as big-endian words, which inlines into a few loads and compares, e.g. a single
+ * BasicComparator<uint64_t> for an int or float key of width 8.
+ */
+template <size_t N>
+class FixedWidthComparator {
+  static_assert(N % sizeof(uint64_t) == 0, "Fixed key width must be a multiple of 8.");
+
+ public:
+  inline int operator()(const GenericKey *lhs, const GenericKey *rhs) const;
+
+ private:
+  static inline uint64_t LoadWord(const char *buf) {
+    uint64_t word;
+    memcpy(&word, buf, sizeof(uint64_t));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    word = __builtin_bswap64(word);
+#endif
+    return word;
+  }
+
+  BasicComparator<uint64_t> word_comparator_;
+};
+
+/** Compares the encoded part of keys of any width. */
+class VariableWidthComparator {
+ public:
+  explicit VariableWidthComparator(uint32_t encoded_size) : encoded_size_(encoded_size) {}
+
+  inline int operator()(const GenericKey *lhs, const GenericKey *rhs) const;
+
+ private:
+  uint32_t encoded_size_;
+};
+
+/**
+ * KeyManager encodes the keys of an index so that two keys compare like their bytes, and the B+ tree pages search
+ * them with a plain memcmp, without decoding or allocating anything.
+ *
+ * Each column of the key schema takes a fixed number of bytes, in the order of the schema:
+ *  - a null flag byte, 0 for null, which sorts before any value, and 1 otherwise
+ *  - int: the value with its sign bit flipped, big-endian (4 bytes)
+ *  - float: the bits of the value, all of them flipped for a negative one and only the sign bit otherwise, big-endian
+ *    (4 bytes)
+ *  - char(n): the chars padded with zeros to n bytes, then the length, big-endian (n + 4 bytes)
+ * The value bytes of a null are zeros. The encoding is followed by zeros up to the key size, or by the payload of the
+ * index, e.g. the row in a clustered index, which is not compared.
+ *
+ * Without a payload, a key of one of the FIXED_KEY_WIDTHS compares all of its bytes with a FixedWidthComparator, and
+ * the searches of the B+ tree pages are compiled for each of these widths, see WithComparator.
+ */
 class KeyManager {
  public: /**/
   [[nodiscard]] inline GenericKey *InitKey() const {
     return (GenericKey *)malloc(key_size_);  // remember delete
   }
 
-  inline void SerializeFromKey(GenericKey *key_buf, const Row &key, Schema *schema) const {
-    // initialize to 0
-    [[maybe_unused]] uint32_t size = key.GetSerializedSize(schema);
-    // std::cout << size << std::endl;
-    ASSERT(key.GetFieldCount() == schema->GetColumnCount(), "field nums not match.");
-    ASSERT(size <= (uint32_t)key_size_, "Index key size exceed max key size.");
-    memset(key_buf->data, 0, key_size_);
-    key.SerializeTo(key_buf->data, schema);
-  }
+  void SerializeFromKey(GenericKey *key_buf, const Row &key, Schema *schema) const;
 
-  inline void DeserializeToKey(const GenericKey *key_buf, Row &key, Schema *schema) const {
-    [[maybe_unused]] uint32_t ofs = key.DeserializeFrom(const_cast<char *>(key_buf->data), schema);
-    ASSERT(ofs <= (uint32_t)key_size_, "Index key size exceed max key size.");
+  void DeserializeToKey(const GenericKey *key_buf, Row &key, Schema *schema) const;
+
+  /** @return the size of the encoding of a key of the schema */
+  static uint32_t GetEncodedSize(const Schema *key_schema);
+
+  /** The bytes of the key, its payload starts at GetEncodedSize. */
+  static inline char *GetKeyData(GenericKey *key_buf) { return key_buf->data; }
+
+  static inline const char *GetKeyData(const GenericKey *key_buf) { return key_buf->data; }
+
+  /**
+   * Call fn with the comparator of the keys, a FixedWidthComparator if the key has one of the fixed widths and no
+   * payload, a VariableWidthComparator otherwise. A generic lambda is then instantiated once per width, so the search
+   * loop inside it compares keys inline.
+   */
+  template <typename Fn>
+  inline auto WithComparator(Fn &&fn) const {
+    switch (fixed_width_) {
+      case 8:
+        return fn(FixedWidthComparator<8>());
+      case 16:
+        return fn(FixedWidthComparator<16>());
+      case 32:
+        return fn(FixedWidthComparator<32>());
+      case 64:
+        return fn(FixedWidthComparator<64>());
+      default:
+        return fn(VariableWidthComparator(encoded_size_));
+    }
   }
 
   // compare
   [[nodiscard]] inline int CompareKeys(const GenericKey *lhs, const GenericKey *rhs) const {
-    //    ASSERT(malloc_usable_size((void *)&lhs) == malloc_usable_size((void *)&rhs), "key size not match.");
-    uint32_t column_count = key_schema_->GetColumnCount();
-    Row lhs_key(INVALID_ROWID);
-    Row rhs_key(INVALID_ROWID);
-    DeserializeToKey(lhs, lhs_key, key_schema_);
-    DeserializeToKey(rhs, rhs_key, key_schema_);
-
-    for (uint32_t i = 0; i < column_count; i++) {
-      Field *lhs_value = lhs_key.GetField(i);
-      Field *rhs_value = rhs_key.GetField(i);
-
-      if (lhs_value->CompareLessThan(*rhs_value) == CmpBool::kTrue) {
-        return -1;
-      }
-
-      if (lhs_value->CompareGreaterThan(*rhs_value) == CmpBool::kTrue) {
-        return 1;
-      }
-    }
-    // equals
-    return 0;
+    return WithComparator([lhs, rhs](auto comparator) { return comparator(lhs, rhs); });
   }
 
   inline int GetKeySize() const { return key_size_; }
@@ -62,14 +112,48 @@ class KeyManager {
   KeyManager(const KeyManager &other) {
     this->key_schema_ = other.key_schema_;
     this->key_size_ = other.key_size_;
+    this->encoded_size_ = other.encoded_size_;
+    this->fixed_width_ = other.fixed_width_;
   }
 
-  // constructor
-  KeyManager(Schema *key_schema, size_t key_size) : key_size_(key_size), key_schema_(key_schema) {}
+  /**
+   * @param has_payload whether the keys carry a payload after their encoding, which must not be compared
+   */
+  KeyManager(Schema *key_schema, size_t key_size, bool has_payload = false)
+      : key_size_(key_size), key_schema_(key_schema), encoded_size_(GetEncodedSize(key_schema)) {
+    ASSERT(encoded_size_ <= static_cast<uint32_t>(key_size_), "Index key size exceed max key size.");
+    fixed_width_ = 0;
+    for (auto width : FIXED_KEY_WIDTHS) {
+      fixed_width_ = !has_payload && key_size == width ? width : fixed_width_;
+    }
+  }
+
+  /** The key widths with a FixedWidthComparator, the smallest key sizes of an index. */
+  static constexpr uint32_t FIXED_KEY_WIDTHS[] = {8, 16, 32, 64};
 
  private:
   int key_size_;
   Schema *key_schema_;
+  uint32_t encoded_size_;
+  // width of the FixedWidthComparator of the keys, 0 if they have none
+  uint32_t fixed_width_;
 };
 
+template <size_t N>
+inline int FixedWidthComparator<N>::operator()(const GenericKey *lhs, const GenericKey *rhs) const {
+  const char *l = KeyManager::GetKeyData(lhs);
+  const char *r = KeyManager::GetKeyData(rhs);
+  for (size_t i = 0; i < N; i += sizeof(uint64_t)) {
+    int res = word_comparator_(LoadWord(l + i), LoadWord(r + i));
+    if (res != 0) {
+      return res;
+    }
+  }
+  return 0;
+}
+
+inline int VariableWidthComparator::operator()(const GenericKey *lhs, const GenericKey *rhs) const {
+  return memcmp(KeyManager::GetKeyData(lhs), KeyManager::GetKeyData(rhs), encoded_size_);
+}
+
 #endif  // MINISQL_GENERIC_KEY_H
@@ -14,6 +14,18 @@ class IndexIterator {
 
   ~IndexIterator();
 
+  /**
+   * An iterator keeps its leaf pinned, so it can be moved but not copied. It holds no latch between calls and reads
+   * its entry without a latch, so it must not be used while the tree is being written, see BPlusTree.
+   */
+  IndexIterator(IndexIterator &&other) noexcept;
+
+  IndexIterator &operator=(IndexIterator &&other) noexcept;
+
+  IndexIterator(const IndexIterator &other) = delete;
+
+  IndexIterator &operator=(const IndexIterator &other) = delete;
+
   /** Return the key/value pair this iterator is currently pointing at. */
   std::pair<GenericKey *, RowId> operator*();
 
@@ -28,9 +40,11 @@ class IndexIterator {
 
  private:
   page_id_t current_page_id{INVALID_PAGE_ID};
+  Page *frame{nullptr};
   LeafPage *page{nullptr};
   int item_index{0};
   BufferPoolManager *buffer_pool_manager{nullptr};
+  ReadAheadState read_ahead_;
   // add your own private member variables here
 };
 
@@ -0,0 +1,102 @@
+#ifndef MINISQL_KEY_SORTER_H
+#define MINISQL_KEY_SORTER_H
+
+#include <cstdio>
+#include <vector>
+
+#include "common/config.h"
+#include "common/rowid.h"
+#include "index/generic_key.h"
+
+/**
+ * External sort of index entries, the (key, row id) pairs of a bulk load, see BPlusTree::BulkLoad.
+ *
+ * The entries are buffered in memory up to the memory budget. A full buffer is sorted and spilled to a temporary file
+ * as a sorted run, and Finish sorts the last buffer, which stays in memory. The entries are then read back in key
+ * order with a k-way merge of the runs. Entries with equal keys come out in the order they were added, so the first
+ * one wins when the tree skips duplicates.
+ *
+ * Several sorters can be filled in parallel, one per thread, and their runs moved into one of them with TakeRuns to be
+ * merged together.
+ */
+class KeySorter {
+ public:
+  /**
+   * @param memory_budget the bytes of entries buffered before a run is spilled
+   */
+  explicit KeySorter(const KeyManager &KM, size_t memory_budget = INDEX_BUILD_SORT_MEMORY);
+
+  ~KeySorter();
+
+  KeySorter(const KeySorter &other) = delete;
+
+  KeySorter &operator=(const KeySorter &other) = delete;
+
+  void Add(const GenericKey *key, const RowId &row_id);
+
+  /** Sort the buffered entries into a run kept in memory. */
+  void SortRun();
+
+  /**
+   * Move the runs of another sorter after the runs of this one, its entries then come after the ones added here when
+   * their keys are equal. The buffered entries of the other sorter must be sorted by SortRun first.
+   */
+  void TakeRuns(KeySorter &other);
+
+  /** Sort the buffered entries and start the merge, no entry can be added after. */
+  void Finish();
+
+  /**
+   * Read the next entry in key order, the key is valid until the next call.
+   * @return false after the last entry
+   */
+  bool Next(GenericKey *&key, RowId &row_id);
+
+  /** @return the number of entries added */
+  inline size_t GetSize() const { return size_; }
+
+  /** @return the number of sorted runs spilled to temporary files */
+  size_t GetSpilledRuns() const;
+
+ private:
+  /** A sorted run, in a temporary file or in memory. */
+  struct Run {
+    FILE *file{nullptr};
+    // the entries of an in-memory run, or the current entry of a spilled one
+    std::vector<char> entries;
+    size_t offset{0};
+  };
+
+  /** Sort the buffered entries into a new run, which is spilled to a temporary file if spill is set. */
+  void SortBuffer(bool spill);
+
+  /**
+   * Step to the next entry of a run.
+   * @return false at the end of the run
+   */
+  bool ReadHead(Run &run);
+
+  inline const char *Head(size_t run) const {
+    return runs_[run].file == nullptr ? runs_[run].entries.data() + runs_[run].offset : runs_[run].entries.data();
+  }
+
+  /** @return whether the head of run lhs comes after the head of run rhs */
+  bool HeadAfter(size_t lhs, size_t rhs) const;
+
+  KeyManager processor_;
+  // size of an entry, the key followed by its row id
+  size_t entry_size_;
+  // max number of entries buffered in memory
+  size_t max_buffered_;
+  size_t size_{0};
+  // entries of the current run, in the order they were added
+  std::vector<char> buffer_;
+  // sorted runs, in the order their entries were added
+  std::vector<Run> runs_;
+  // runs that have entries left, a heap on their heads
+  std::vector<size_t> merge_heap_;
+  // the entry returned by Next
+  std::vector<char> current_;
+};
+
+#endif  // MINISQL_KEY_SORTER_H
@@ -2,6 +2,7 @@
 #define MINISQL_BITMAP_PAGE_H
 
 #include <bitset>
+#include <cstring>
 
 #include "common/config.h"
 #include "common/macros.h"
@@ -30,7 +31,27 @@ class BitmapPage {
    */
   bool IsPageFree(uint32_t page_offset) const;
 
+  /**
+   * Count the allocated pages from the bits themselves rather than trusting page_allocated_.
+   */
+  uint32_t CountAllocatedPages() const;
+
  private:
+  /**
+   * Find the first free page, looking at a whole word of the bitmap at a time.
+   *
+   * @param word_index the word to start from
+   * @return the offset of the first free page, GetMaxSupportedSize() if the extent is full
+   */
+  uint32_t FindFreePage(uint32_t word_index) const;
+
+  /** @return the word_index-th 64 bits of the bitmap, page_offset i is bit i % 64 on a little endian machine */
+  uint64_t GetWord(uint32_t word_index) const {
+    uint64_t word;
+    memcpy(&word, bytes + word_index * sizeof(uint64_t), sizeof(uint64_t));
+    return word;
+  }
+
   /**
    * check a bit(byte_index, bit_index) in bytes is free(value 0).
    *
@@ -42,6 +63,9 @@ class BitmapPage {
 
   /** Note: need to update if modify page structure. */
   static constexpr size_t MAX_CHARS = PageSize - 2 * sizeof(uint32_t);
+  static constexpr uint32_t BITS_PER_WORD = 64;
+  static constexpr uint32_t NUM_WORDS = MAX_CHARS / sizeof(uint64_t);
+  static_assert(MAX_CHARS % sizeof(uint64_t) == 0, "The bitmap must be made of whole words.");
 
  private:
   /** The space occupied by all members of the class should be equal to the PageSize */
@@ -5,8 +5,15 @@
 
 #include "page/bitmap_page.h"
 
-static constexpr page_id_t MAX_VALID_PAGE_ID = (PAGE_SIZE - 8) / 4 * BitmapPage<PAGE_SIZE>::GetMaxSupportedSize();
-
+// each data file records the used page count of this many extents in its meta page, the last word is kept for the
+// number of data files
+static constexpr uint32_t MAX_EXTENTS_PER_FILE = (PAGE_SIZE - 12) / 4;
+// max number of pages of a single data file
+static constexpr page_id_t MAX_VALID_PAGE_ID = MAX_EXTENTS_PER_FILE * BitmapPage<PAGE_SIZE>::GetMaxSupportedSize();
+
+/**
+ * Meta page at the beginning of every data file. The counts describe the extents of the file only.
+ */
 class DiskFileMetaPage {
  public:
   uint32_t GetExtentNums() { return num_extents_; }
@@ -20,6 +27,14 @@ class DiskFileMetaPage {
     return extent_used_page_[extent_id];
   }
 
+  /**
+   * Number of data files of the tablespace, recorded in the meta page of the first file. It is stored in the last
+   * word of the page, so that a file written before tablespaces existed reads as 0, i.e. not initialized.
+   */
+  uint32_t GetDataFileNums() { return extent_used_page_[MAX_EXTENTS_PER_FILE]; }
+
+  void SetDataFileNums(uint32_t num_data_files) { extent_used_page_[MAX_EXTENTS_PER_FILE] = num_data_files; }
+
  public:
   uint32_t num_allocated_pages_{0};
   uint32_t num_extents_{0};  // each extent consists with a bit map and BIT_MAP_SIZE pages
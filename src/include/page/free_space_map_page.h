@@ -0,0 +1,70 @@
+#ifndef MINISQL_FREE_SPACE_MAP_PAGE_H
+#define MINISQL_FREE_SPACE_MAP_PAGE_H
+
+#include <cstdint>
+
+#include "common/config.h"
+
+/**
+ * A page of the free space map of a table heap. It records how much room is left in up to MAX_ENTRIES table pages,
+ * rounded down to a multiple of CATEGORY_BYTES so that it fits in a byte, and keeps a max tree over these categories
+ * to find a page with enough room in log time. The pages of a map are chained, the table pages are recorded in the
+ * order they were added to the heap.
+ *
+ * Format (size in byte):
+ *  ---------------------------------------------------------------------------------------------
+ * | NextPageId (4) | EntryCount (4) | PageId_1 (4) | ... | PageId_n (4) | Tree (2 * MAX_ENTRIES) |
+ *  ---------------------------------------------------------------------------------------------
+ */
+class FreeSpaceMapPage {
+ public:
+  void Init(page_id_t next_page_id = INVALID_PAGE_ID);
+
+  page_id_t GetNextPageId() const { return next_page_id_; }
+
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+  uint32_t GetEntryCount() const { return count_; }
+
+  bool IsFull() const { return count_ == MAX_ENTRIES; }
+
+  page_id_t GetPageId(uint32_t slot) const { return page_ids_[slot]; }
+
+  /**
+   * Record a new table page.
+   * @return slot of the page in this map page
+   */
+  uint32_t Append(page_id_t page_id, uint32_t free_space);
+
+  void Update(uint32_t slot, uint32_t free_space);
+
+  /**
+   * @return slot of the first table page with at least free_space bytes left, -1 if there is none
+   */
+  int Search(uint32_t free_space) const;
+
+  /** @return the largest category of the table pages of this map page */
+  uint8_t GetMaxCategory() const { return tree_[1]; }
+
+  /** @return category of a page with free_space bytes left, rounded down */
+  static uint8_t ToCategory(uint32_t free_space) {
+    return free_space / CATEGORY_BYTES > UINT8_MAX ? UINT8_MAX : free_space / CATEGORY_BYTES;
+  }
+
+  /** @return smallest category which guarantees free_space bytes, rounded up */
+  static uint32_t ToRequiredCategory(uint32_t free_space) { return (free_space + CATEGORY_BYTES - 1) / CATEGORY_BYTES; }
+
+  static constexpr uint32_t CATEGORY_BYTES = 16;
+  static constexpr uint32_t MAX_ENTRIES = 512;
+
+ private:
+  page_id_t next_page_id_;
+  uint32_t count_;
+  page_id_t page_ids_[MAX_ENTRIES];
+  // tree_[1] is the root, the children of node i are 2i and 2i + 1, the leaf of slot i is tree_[MAX_ENTRIES + i]
+  uint8_t tree_[2 * MAX_ENTRIES];
+};
+
+static_assert(sizeof(FreeSpaceMapPage) <= PAGE_SIZE, "Free space map page does not fit in a page.");
+
+#endif  // MINISQL_FREE_SPACE_MAP_PAGE_H
@@ -0,0 +1,44 @@
+#ifndef MINISQL_OVERFLOW_PAGE_H
+#define MINISQL_OVERFLOW_PAGE_H
+
+#include <cstdint>
+
+#include "common/config.h"
+
+/**
+ * A page of the chain which holds a char value stored out of line, see TableHeap. The value is split into pieces of
+ * up to MAX_DATA_SIZE bytes, one per page, in the order of the chain.
+ *
+ * Format (size in byte):
+ *  -----------------------------------------------------
+ * | NextPageId (4) | DataSize (4) | Data (MAX_DATA_SIZE) |
+ *  -----------------------------------------------------
+ */
+class OverflowPage {
+ public:
+  void Init(page_id_t next_page_id = INVALID_PAGE_ID);
+
+  page_id_t GetNextPageId() const { return next_page_id_; }
+
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+  uint32_t GetDataSize() const { return data_size_; }
+
+  const char *GetData() const { return data_; }
+
+  /**
+   * Store a piece of a value, replacing the one stored before.
+   */
+  void SetData(const char *data, uint32_t size);
+
+  static constexpr uint32_t MAX_DATA_SIZE = PAGE_SIZE - 2 * sizeof(uint32_t);
+
+ private:
+  page_id_t next_page_id_;
+  uint32_t data_size_;
+  char data_[MAX_DATA_SIZE];
+};
+
+static_assert(sizeof(OverflowPage) == PAGE_SIZE, "Overflow page does not fill a page.");
+
+#endif  // MINISQL_OVERFLOW_PAGE_H
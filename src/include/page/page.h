@@ -1,6 +1,7 @@
 #ifndef MINISQL_PAGE_H
 #define MINISQL_PAGE_H
 
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
 #include <shared_mutex>
@@ -20,11 +21,17 @@ class Page {
  public:
   DISALLOW_COPY(Page)
 
-  /** Constructor. Zeros out the page data. */
-  Page() { ResetMemory(); }
+  /** Constructor. Zeros out the page data, which the page allocates and owns. */
+  Page() : data_(static_cast<char *>(aligned_alloc(PAGE_SIZE, PAGE_SIZE))), owns_data_(true) { ResetMemory(); }
 
-  /** Default destructor. */
-  ~Page() = default;
+  /** Constructor of a buffer pool frame. Zeros out the page data, which lives in the frame arena of the pool. */
+  explicit Page(char *data) : data_(data) { ResetMemory(); }
+
+  ~Page() {
+    if (owns_data_) {
+      free(data_);
+    }
+  }
 
   /** @return the actual data contained within this page */
   inline char *GetData() { return data_; }
@@ -68,14 +75,20 @@ class Page {
   /** Zeroes out the data that is held within the page. */
   inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }
 
-  /** The actual data that is stored within a page. */
-  char data_[PAGE_SIZE]{};
+  /** The actual data that is stored within a page, aligned to PAGE_SIZE. */
+  char *data_;
+  /** True if data_ was allocated by the page itself. */
+  bool owns_data_ = false;
   /** The ID of this page. */
   page_id_t page_id_ = INVALID_PAGE_ID;
   /** The pin count of this page. */
   int pin_count_ = 0;
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
   bool is_dirty_ = false;
+  /** True while the page cleaner writes the page back, the frame is then neither evicted nor reused. */
+  bool being_cleaned_ = false;
+  /** True if the page was deleted while being cleaned, its frame is freed once the write completes. */
+  bool delete_pending_ = false;
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
 };
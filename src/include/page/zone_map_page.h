@@ -0,0 +1,127 @@
+#ifndef MINISQL_ZONE_MAP_PAGE_H
+#define MINISQL_ZONE_MAP_PAGE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "common/config.h"
+#include "record/field.h"
+#include "record/row.h"
+#include "record/schema.h"
+
+/**
+ * The columns of a table which have zone maps: its int and float columns, up to MAX_COLUMNS of them.
+ */
+class ZoneMapLayout {
+ public:
+  explicit ZoneMapLayout(const Schema *schema);
+
+  uint32_t GetColumnCount() const { return static_cast<uint32_t>(columns_.size()); }
+
+  /** @return index of the zone of a table column, -1 if the column has none */
+  int GetZoneIndex(uint32_t column) const { return column < zone_index_.size() ? zone_index_[column] : -1; }
+
+  uint32_t GetTableColumn(uint32_t zone_index) const { return columns_[zone_index]; }
+
+  TypeId GetType(uint32_t zone_index) const { return types_[zone_index]; }
+
+  /** @return size in byte of the zone map of a table page */
+  uint32_t GetEntrySize() const { return sizeof(uint32_t) + 2 * sizeof(uint32_t) * GetColumnCount(); }
+
+  static constexpr uint32_t MAX_COLUMNS = 32;
+
+ private:
+  std::vector<uint32_t> columns_;
+  std::vector<TypeId> types_;
+  std::vector<int> zone_index_;
+};
+
+/**
+ * The zone map of a table page, i.e. the smallest and the largest value of each column of the layout among the
+ * tuples of the page, nulls aside. The bounds only ever widen while the page is in use, a deleted value is not
+ * taken out of them, so they may be looser than the tuples of the page but never tighter.
+ *
+ * Format (size in byte):
+ *  ------------------------------------------------------------------------
+ * | ValueMask (4) | Min_1 (4) | Max_1 (4) | ... | Min_n (4) | Max_n (4) |
+ *  ------------------------------------------------------------------------
+ * Bit i of the mask is set once zone i has seen a non-null value.
+ */
+class ZoneMapEntry {
+ public:
+  ZoneMapEntry(char *data, const ZoneMapLayout *layout) : data_(data), layout_(layout) {}
+
+  /** @return true if the table column has a zone map */
+  bool HasZone(uint32_t column) const { return layout_->GetZoneIndex(column) >= 0; }
+
+  /** @return true if some tuple of the page has a non-null value in the table column, which must have a zone */
+  bool HasValues(uint32_t column) const;
+
+  Field GetMin(uint32_t column) const;
+
+  Field GetMax(uint32_t column) const;
+
+  /** Forget all the values, e.g. once the page is empty. */
+  void Clear();
+
+  /** Widen the bounds to the values of a row of the table. */
+  void Widen(const Row &row);
+
+  /** Widen the bounds to those of another zone map of the same layout. */
+  void Widen(const ZoneMapEntry &other);
+
+ private:
+  void WidenZone(uint32_t zone_index, const char *min, const char *max);
+
+  char *GetBound(uint32_t zone_index, bool is_max) const {
+    return data_ + sizeof(uint32_t) + (2 * zone_index + is_max) * sizeof(uint32_t);
+  }
+
+  Field ReadBound(uint32_t column, bool is_max) const;
+
+  char *data_;
+  const ZoneMapLayout *layout_;
+};
+
+/**
+ * A page of the zone maps of a table heap. The zone maps are kept in the order in which the free space map records
+ * the table pages, so that the position of a table page in the map locates its zone map too.
+ *
+ * Format (size in byte):
+ *  -----------------------------------------------------------------
+ * | NextPageId (4) | EntryCount (4) | Entry_1 | ... | Entry_n |
+ *  -----------------------------------------------------------------
+ */
+class ZoneMapPage {
+ public:
+  void Init(page_id_t next_page_id = INVALID_PAGE_ID);
+
+  page_id_t GetNextPageId() const { return next_page_id_; }
+
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+  uint32_t GetEntryCount() const { return count_; }
+
+  bool IsFull(const ZoneMapLayout &layout) const { return count_ == GetMaxEntries(layout); }
+
+  /**
+   * Add the zone map of a new table page, without any value.
+   * @return slot of the zone map in this page
+   */
+  uint32_t Append(const ZoneMapLayout &layout);
+
+  ZoneMapEntry GetEntry(uint32_t slot, const ZoneMapLayout &layout) {
+    return ZoneMapEntry(entries_ + slot * layout.GetEntrySize(), &layout);
+  }
+
+  static uint32_t GetMaxEntries(const ZoneMapLayout &layout) {
+    return (PAGE_SIZE - 2 * sizeof(uint32_t)) / layout.GetEntrySize();
+  }
+
+ private:
+  page_id_t next_page_id_;
+  uint32_t count_;
+  char entries_[0];
+};
+
+#endif  // MINISQL_ZONE_MAP_PAGE_H
@@ -1,5 +1,6 @@
 %{
   #include <stdio.h>
+  #include <string.h>
   #include "parser/parser.h"
 
   extern char *yytext;
@@ -7,6 +8,8 @@
   int yyerror(char* error);
 %}
 
+%define api.header.include {"parser/minisql_yacc.h"}
+
 %union {
 	pSyntaxNode syntax_node;
 }
@@ -27,7 +30,7 @@
 %type <syntax_node> sql_select select_columns column_values column_value operator
 %type <syntax_node> connector where_conditions where_condition
 %type <syntax_node> sql_insert sql_delete sql_update update_values update_value
-%type <syntax_node> sql_quit sql_exec_file
+%type <syntax_node> sql_quit sql_exec_file sql_vacuum
 
 %%
 
@@ -58,6 +61,7 @@ sql:
   | sql_trx_rollback { $$ = $1; }
   | sql_quit { $$ = $1; }
   | sql_exec_file { $$ = $1; }
+  | sql_vacuum { $$ = $1; }
   ;
 
 sql_create_database:
@@ -101,6 +105,18 @@ sql_create_table:
     SyntaxNodeAddChildren($$, $3);
     SyntaxNodeAddChildren($$, list_node);
   }
+  /* organization is not a reserved word, an index-organized table is marked by the value of its node */
+  | CREATE TABLE IDENTIFIER '(' column_definition_list ')' IDENTIFIER INDEX {
+    if (strcmp($7->val_, "organization") != 0) {
+      yyerror("syntax error");
+      YYABORT;
+    }
+    $$ = CreateSyntaxNode(kNodeCreateTable, "organization index");
+    pSyntaxNode list_node = CreateSyntaxNode(kNodeColumnDefinitionList, NULL);
+    SyntaxNodeAddChildren(list_node, $5);
+    SyntaxNodeAddChildren($$, $3);
+    SyntaxNodeAddChildren($$, list_node);
+  }
   ;
 
 column_list:
@@ -393,6 +409,18 @@ sql_exec_file:
   }
   ;
 
+/* vacuum is not a reserved word, it is only recognized in front of a table name */
+sql_vacuum:
+  IDENTIFIER IDENTIFIER {
+    if (strcmp($1->val_, "vacuum") != 0) {
+      yyerror("syntax error");
+      YYABORT;
+    }
+    $$ = CreateSyntaxNode(kNodeVacuum, NULL);
+    SyntaxNodeAddChildren($$, $2);
+  }
+  ;
+
 %%
 int yyerror(char* error) {
 	MinisqlParserSetError(error);
@@ -8,7 +8,9 @@
 #include <utility>
 #include <vector>
 
+#include "page/zone_map_page.h"
 #include "record/row.h"
+#include "record/row_view.h"
 #include "record/schema.h"
 
 class AbstractExpression;
@@ -36,6 +38,12 @@ class AbstractExpression {
   /** @return The field obtained by evaluating the row */
   virtual Field Evaluate(const Row *row) const = 0;
 
+  /**
+   * Evaluate the expression on a row read in place. Char fields of the result may point into the row.
+   * @return The field obtained by evaluating the row
+   */
+  virtual Field EvaluateView(const RowView &row) const = 0;
+
   /**
    * Returns the field obtained by evaluating a JOIN.
    * @param left_row The left row
@@ -44,6 +52,12 @@ class AbstractExpression {
    */
   virtual Field EvaluateJoin(const Row *left_row, const Row *right_row) const = 0;
 
+  /**
+   * Check a predicate against the zone map of a table page.
+   * @return false only if no tuple of the page can satisfy the predicate
+   */
+  virtual bool MayMatch(const ZoneMapEntry &) const { return true; }
+
   /** @return the child_idx'th child of this expression */
   const AbstractExpressionRef &GetChildAt(uint32_t child_idx) const { return children_[child_idx]; }
 
@@ -8,6 +8,8 @@
 #include <utility>
 
 #include "abstract_expression.h"
+#include "column_value_expression.h"
+#include "constant_value_expression.h"
 #include "record/schema.h"
 
 /**
@@ -27,14 +29,83 @@ class ComparisonExpression : public AbstractExpression {
     return Field(kTypeInt, PerformComparison(lhs, rhs));
   }
 
+  Field EvaluateView(const RowView &row) const override {
+    Field lhs = GetChildAt(0)->EvaluateView(row);
+    Field rhs = GetChildAt(1)->EvaluateView(row);
+    return Field(kTypeInt, PerformComparison(lhs, rhs));
+  }
+
   Field EvaluateJoin(const Row *left_row, const Row *right_row) const override {
     Field lhs = GetChildAt(0)->EvaluateJoin(left_row, right_row);
     Field rhs = GetChildAt(1)->EvaluateJoin(left_row, right_row);
     return Field(kTypeInt, PerformComparison(lhs, rhs));
   }
 
+  /** A comparison of a column with a constant is checked against the bounds of the column in the zone map. */
+  bool MayMatch(const ZoneMapEntry &zone) const override {
+    const ColumnValueExpression *column;
+    const ConstantValueExpression *constant;
+    std::string comp_type = GetColumnComparison(column, constant);
+    if (column == nullptr || !zone.HasZone(column->GetColIdx()) || comp_type == "is") {
+      return true;
+    }
+    if (!zone.HasValues(column->GetColIdx())) {
+      // the page only has nulls in the column, if any tuple
+      return false;
+    }
+    if (comp_type == "not") {
+      return true;
+    }
+    if (constant == nullptr) {
+      return true;
+    }
+    Field value = constant->Evaluate(nullptr);
+    Field min = zone.GetMin(column->GetColIdx());
+    Field max = zone.GetMax(column->GetColIdx());
+    if (value.IsNull() || !min.CheckComparable(value)) {
+      return true;
+    }
+    if (comp_type == "=") {
+      return min.CompareLessThanEquals(value) == CmpBool::kTrue && max.CompareGreaterThanEquals(value) == CmpBool::kTrue;
+    } else if (comp_type == "<>") {
+      return min.CompareNotEquals(value) == CmpBool::kTrue || max.CompareNotEquals(value) == CmpBool::kTrue;
+    } else if (comp_type == "<") {
+      return min.CompareLessThan(value) == CmpBool::kTrue;
+    } else if (comp_type == "<=") {
+      return min.CompareLessThanEquals(value) == CmpBool::kTrue;
+    } else if (comp_type == ">") {
+      return max.CompareGreaterThan(value) == CmpBool::kTrue;
+    } else if (comp_type == ">=") {
+      return max.CompareGreaterThanEquals(value) == CmpBool::kTrue;
+    }
+    return true;
+  }
+
   std::string GetComparisonType() { return comp_type_; }
 
+  /**
+   * Look at the comparison from the side of its column, a comparison constant op column is turned around.
+   * @param[out] column the column compared, nullptr if neither side is a column
+   * @param[out] constant the constant the column is compared with, nullptr if the other side is not a constant
+   * @return the comparison type seen from the column
+   */
+  std::string GetColumnComparison(const ColumnValueExpression *&column,
+                                  const ConstantValueExpression *&constant) const {
+    column = dynamic_cast<const ColumnValueExpression *>(GetChildAt(0).get());
+    constant = dynamic_cast<const ConstantValueExpression *>(GetChildAt(1).get());
+    std::string comp_type = comp_type_;
+    if (column == nullptr && constant == nullptr) {
+      column = dynamic_cast<const ColumnValueExpression *>(GetChildAt(1).get());
+      constant = dynamic_cast<const ConstantValueExpression *>(GetChildAt(0).get());
+      if (comp_type == "<" || comp_type == ">") {
+        comp_type = comp_type == "<" ? ">" : "<";
+      } else if (comp_type == "<=" || comp_type == ">=") {
+        comp_type = comp_type == "<=" ? ">=" : "<=";
+      }
+    }
+    return comp_type;
+  }
+
  private:
   CmpBool PerformComparison(const Field &lhs, const Field &rhs) const {
     if (comp_type_ == "=")
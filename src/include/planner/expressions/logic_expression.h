@@ -31,12 +31,24 @@ class LogicExpression : public AbstractExpression {
     return Field(kTypeInt, PerformComputation(lhs, rhs));
   }
 
+  Field EvaluateView(const RowView &row) const override {
+    Field lhs = GetChildAt(0)->EvaluateView(row);
+    Field rhs = GetChildAt(1)->EvaluateView(row);
+    return Field(kTypeInt, PerformComputation(lhs, rhs));
+  }
+
   Field EvaluateJoin(const Row *left_row, const Row *right_row) const override {
     Field lhs = GetChildAt(0)->EvaluateJoin(left_row, right_row);
     Field rhs = GetChildAt(1)->EvaluateJoin(left_row, right_row);
     return Field(kTypeInt, PerformComputation(lhs, rhs));
   }
 
+  bool MayMatch(const ZoneMapEntry &zone) const override {
+    bool lhs = GetChildAt(0)->MayMatch(zone);
+    bool rhs = GetChildAt(1)->MayMatch(zone);
+    return logic_type_ == LogicType::And ? lhs && rhs : lhs || rhs;
+  }
+
   static LogicType Char2Type(char *val) {
     if (!strcmp(val, "and"))
       return LogicType::And;
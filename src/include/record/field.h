@@ -9,6 +9,14 @@
 #include "record/type_id.h"
 #include "record/types.h"
 
+/**
+ * Pointer to a char value stored out of line, in a chain of overflow pages, see TableHeap.
+ */
+struct ExternalValue {
+  page_id_t first_page_id_;
+  uint32_t length_;
+};
+
 class Field {
   friend class Type;
 
@@ -61,12 +69,21 @@ class Field {
     }
   }
 
+  // char stored out of line, the field holds the pointer to the value
+  explicit Field(TypeId type, const ExternalValue &value) : type_id_(type), manage_data_(true), is_external_(true) {
+    ASSERT(type == TypeId::kTypeChar, "Invalid type.");
+    value_.chars_ = new char[sizeof(ExternalValue)];
+    memcpy(value_.chars_, &value, sizeof(ExternalValue));
+    len_ = sizeof(ExternalValue);
+  }
+
   // copy constructor
   explicit Field(const Field &other) {
     type_id_ = other.type_id_;
     len_ = other.len_;
     is_null_ = other.is_null_;
     manage_data_ = other.manage_data_;
+    is_external_ = other.is_external_;
     if (type_id_ == TypeId::kTypeChar && !is_null_ && manage_data_) {
       value_.chars_ = new char[len_];
       memcpy(value_.chars_, other.value_.chars_, len_);
@@ -83,6 +100,16 @@ class Field {
 
   inline bool IsNull() const { return is_null_; }
 
+  /** @return true if the field holds the pointer to a char value stored out of line instead of the value */
+  inline bool IsExternal() const { return is_external_; }
+
+  inline ExternalValue GetExternalValue() const {
+    ASSERT(is_external_, "Field is not stored out of line.");
+    ExternalValue value;
+    memcpy(&value, value_.chars_, sizeof(ExternalValue));
+    return value;
+  }
+
   inline uint32_t GetLength() const { return Type::GetInstance(type_id_)->GetLength(*this); }
 
   inline TypeId GetTypeId() const { return type_id_; }
@@ -127,6 +154,7 @@ class Field {
     std::swap(first.len_, second.len_);
     std::swap(first.is_null_, second.is_null_);
     std::swap(first.manage_data_, second.manage_data_);
+    std::swap(first.is_external_, second.is_external_);
   }
 
   std::string toString() {
@@ -154,6 +182,11 @@ class Field {
   uint32_t len_;
   bool is_null_{false};
   bool manage_data_{false};
+  bool is_external_{false};
+
+ public:
+  // set in the serialized length of a char field which holds the pointer to a value stored out of line
+  static constexpr uint32_t EXTERNAL_FLAG = 1U << 31;
 };
 
 #endif  // MINISQL_FIELD_H
@@ -0,0 +1,102 @@
+#ifndef MINISQL_ROW_VIEW_H
+#define MINISQL_ROW_VIEW_H
+
+#include <vector>
+
+#include "common/macros.h"
+#include "common/rowid.h"
+#include "record/field.h"
+#include "record/row.h"
+#include "record/schema.h"
+
+/**
+ * Reads the char values a table stores out of line, see TableHeap.
+ */
+class ExternalValueReader {
+ public:
+  virtual ~ExternalValueReader() = default;
+
+  /**
+   * Copy a value stored out of line into buf, which has room for value.length_ bytes.
+   */
+  virtual void ReadExternalValue(const ExternalValue &value, char *buf) const = 0;
+};
+
+/**
+ * RowView reads a serialized row in place, e.g. a tuple of a pinned table page, see Row for the format.
+ *
+ * Nothing is copied or allocated when a view is set: fields are decoded on demand, and the offset of every field up to
+ * the last one asked for is remembered, so a predicate on the first columns never looks at the rest of the row. The
+ * fields handed out point into the serialized row for chars, so they, like the view itself, are only valid as long as
+ * the page stays pinned and latched. ToRow copies the row out.
+ *
+ * A view can be reset to another row without reallocating, a scan should reuse one view for all its rows.
+ *
+ * A char value stored out of line is read through the external value reader of the view and copied, the field then
+ * owns its data. Without a reader, the field holds the pointer to the value, see Field::IsExternal.
+ */
+class RowView {
+ public:
+  RowView() = default;
+
+  RowView(const char *data, const Schema *schema, RowId rid) { Reset(data, schema, rid); }
+
+  /**
+   * Point the view to another serialized row.
+   */
+  void Reset(const char *data, const Schema *schema, RowId rid);
+
+  /**
+   * Set the reader of the char values stored out of line, it is kept when the view is reset.
+   */
+  inline void SetExternalValueReader(const ExternalValueReader *reader) { reader_ = reader; }
+
+  inline RowId GetRowId() const { return rid_; }
+
+  inline size_t GetFieldCount() const { return field_count_; }
+
+  /** @return true if the field is null, the field is not decoded */
+  bool IsNull(uint32_t idx) const;
+
+  /** @return true if the field is a char value stored out of line, the value is not read */
+  bool IsExternal(uint32_t idx) const;
+
+  /** @return pointer to the value of a field stored out of line */
+  ExternalValue GetExternalValue(uint32_t idx) const;
+
+  /**
+   * Decode a field. A char field does not own its data, it points into the serialized row.
+   */
+  Field GetField(uint32_t idx) const;
+
+  /**
+   * Copy the whole row out of the view.
+   */
+  void ToRow(Row *row) const;
+
+  /**
+   * Copy the columns of output_schema out of the view, the columns are found by their index in the table.
+   */
+  void ToRow(Row *row, const Schema *output_schema) const;
+
+ private:
+  /** @return offset of the field from the beginning of the row, decoding the lengths of the fields before it */
+  uint32_t GetFieldOffset(uint32_t idx) const;
+
+  /** @return a field which owns its data */
+  Field *CopyField(uint32_t idx) const;
+
+  /** @return a field which owns the value of a field stored out of line, or its pointer if there is no reader */
+  Field *CopyExternalField(uint32_t idx) const;
+
+ private:
+  const char *data_{nullptr};
+  const Schema *schema_{nullptr};
+  RowId rid_{};
+  const ExternalValueReader *reader_{nullptr};
+  uint32_t field_count_{0};
+  // offsets_[i] is the offset of field i, known for the first offsets_.size() fields
+  mutable std::vector<uint32_t> offsets_;
+};
+
+#endif  // MINISQL_ROW_VIEW_H
@@ -1,16 +1,20 @@
 #ifndef DISK_MGR_H
 #define DISK_MGR_H
 
+#include <sys/types.h>
+
 #include <atomic>
-#include <fstream>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include "common/config.h"
 #include "common/macros.h"
 #include "page/bitmap_page.h"
 #include "page/disk_file_meta_page.h"
+#include "storage/io_uring.h"
 
 /**
  * DiskManager takes care of the allocation and de allocation of pages within a database. It performs the reading and
@@ -19,10 +23,38 @@
  * Disk page storage format: (Free Page BitMap Size = PAGE_SIZE * 8, we note it as N)
  * | Meta Page | Free Page BitMap 1 | Page 1 | Page 2 | ....
  *      | Page N | Free Page BitMap 2 | Page N+1 | ... | Page 2N | ... |
+ *
+ * Pages are read and written with pread/pwrite on a raw file descriptor, so page I/O needs no latch and several pages
+ * can be read or written at the same time. Only page allocation is serialized. Writes are not flushed one by one,
+ * Sync makes them durable.
+ *
+ * ReadPageAsync and WritePageAsync queue page I/O on an io_uring so that many pages can be in flight at once. When
+ * io_uring is disabled or not supported by the kernel they fall back to synchronous I/O and return completed handles.
+ *
+ * In direct I/O mode the file is opened with O_DIRECT, so pages are cached by the buffer pool only and not a second
+ * time by the kernel. Page buffers should then be aligned to PAGE_SIZE, as the frames of the buffer pool are; other
+ * buffers go through an aligned bounce buffer.
+ *
+ * The bitmap pages are cached once read, and a bit per extent records which extents still have free pages, so page
+ * allocation does no I/O. Dirty bitmaps and the meta page are written back by FlushMetadata or Close.
+ *
+ * A database may be a tablespace of several data files, e.g. on different disks. Extents are spread over the files
+ * round robin, extent i living in file i % n, so the pages of a large table or index are read from all the files in
+ * parallel. Every file has the layout above with its own meta page, and the first file records the number of files.
+ * Offsets within a file are 64 bit.
  */
 class DiskManager {
  public:
-  explicit DiskManager(const std::string &db_file);
+  /**
+   * @param use_io_uring whether asynchronous page I/O should go through io_uring
+   * @param direct_io whether the file should bypass the kernel page cache, ignored if the file system refuses it
+   */
+  explicit DiskManager(const std::string &db_file, bool use_io_uring = true, bool direct_io = false);
+
+  /**
+   * Open a tablespace. The data files must be given in the same order every time the tablespace is opened.
+   */
+  explicit DiskManager(const std::vector<std::string> &data_files, bool use_io_uring = true, bool direct_io = false);
 
   ~DiskManager() {
     if (!closed) {
@@ -42,6 +74,30 @@ class DiskManager {
    */
   void WritePage(page_id_t logical_page_id, const char *page_data);
 
+  /**
+   * Queue a page read. page_data must stay valid until the returned handle completes.
+   */
+  IOHandle ReadPageAsync(page_id_t logical_page_id, char *page_data);
+
+  /**
+   * Queue a page write. page_data must stay valid and unchanged until the returned handle completes.
+   */
+  IOHandle WritePageAsync(page_id_t logical_page_id, const char *page_data);
+
+  /** @return true if asynchronous page I/O really is asynchronous */
+  inline bool IsAsyncIOEnabled() const { return io_uring_ != nullptr; }
+
+  /** @return true if the file bypasses the kernel page cache */
+  inline bool IsDirectIOEnabled() const { return direct_io_; }
+
+  /** @return number of data files of the tablespace */
+  inline uint32_t GetDataFileNums() const { return data_files_.size(); }
+
+  /** @return index of the data file holding a page */
+  inline uint32_t GetDataFileId(page_id_t logical_page_id) const {
+    return logical_page_id / BITMAP_SIZE % data_files_.size();
+  }
+
   /**
    * Get next free page from disk
    * @return logical page id of allocated page
@@ -58,48 +114,124 @@ class DiskManager {
    */
   bool IsPageFree(page_id_t logical_page_id);
 
+  /**
+   * Write the dirty bitmap pages and the meta page back, e.g. at a checkpoint.
+   */
+  void FlushMetadata();
+
+  /**
+   * Make every page written so far durable.
+   */
+  void Sync();
+
   /**
    * Shut down the disk manager and close all the file resources.
    */
   void Close();
 
   /**
-   * Get Meta Page
+   * Get Meta Page of a data file
    * Note: Used only for debug
    */
-  char *GetMetaData() { return meta_data_; }
+  char *GetMetaData(uint32_t data_file_id = 0) { return data_files_[data_file_id]->meta_data_; }
 
   static constexpr size_t BITMAP_SIZE = BitmapPage<PAGE_SIZE>::GetMaxSupportedSize();
+  // logical page ids of all the extents must fit in page_id_t
+  static constexpr uint32_t MAX_DATA_FILES = 64;
 
  private:
+  struct DataFile {
+    int fd_{-1};
+    std::string file_name_;
+    // size of the file, cached so that a read does not need to stat the file
+    std::atomic<off_t> file_size_{0};
+    alignas(PAGE_SIZE) char meta_data_[PAGE_SIZE];
+  };
+
+  struct ExtentBitmap {
+    alignas(PAGE_SIZE) char data_[PAGE_SIZE];
+    bool dirty_{false};
+  };
+
   /**
    * Helper function to get disk file size
    */
-  int GetFileSize(const std::string &file_name);
+  static off_t GetFileSize(int fd);
+
+  /**
+   * Open or create a data file, throws if it cannot be opened
+   */
+  std::unique_ptr<DataFile> OpenDataFile(const std::string &file_name, bool direct_io);
 
   /**
    * Read physical page from disk
    */
-  void ReadPhysicalPage(page_id_t physical_page_id, char *page_data);
+  void ReadPhysicalPage(DataFile *file, page_id_t physical_page_id, char *page_data);
 
   /**
    * Write data to physical page in disk
    */
-  void WritePhysicalPage(page_id_t physical_page_id, const char *page_data);
+  void WritePhysicalPage(DataFile *file, page_id_t physical_page_id, const char *page_data);
+
+  /**
+   * @return true if the buffer cannot be handed to the kernel as is
+   */
+  inline bool NeedsBounceBuffer(const char *page_data) const {
+    return direct_io_ && reinterpret_cast<uintptr_t>(page_data) % PAGE_SIZE != 0;
+  }
+
+  /**
+   * Raise the cached file size to end, other writers may be extending the file at the same time
+   */
+  static void ExtendFileSize(DataFile *file, off_t end);
 
   /**
-   * Map logical page id to physical page id
+   * Map logical page id to physical page id within its data file
    */
   page_id_t MapPageId(page_id_t logical_page_id);
 
+  /** @return the data file holding an extent */
+  inline DataFile *GetExtentFile(uint32_t extent_id) { return data_files_[extent_id % data_files_.size()].get(); }
+
+  /** @return meta page of the data file holding an extent */
+  inline DiskFileMetaPage *GetExtentMeta(uint32_t extent_id) {
+    return reinterpret_cast<DiskFileMetaPage *>(GetExtentFile(extent_id)->meta_data_);
+  }
+
+  /** @return index of an extent among the extents of its data file */
+  inline uint32_t GetLocalExtentId(uint32_t extent_id) const { return extent_id / data_files_.size(); }
+
+  /** @return physical page id of the bitmap page of an extent within its data file */
+  inline page_id_t GetBitmapPhysicalPageId(uint32_t extent_id) const {
+    return 1 + GetLocalExtentId(extent_id) * (BITMAP_SIZE + 1);
+  }
+
+  /**
+   * @return the cached bitmap of an extent, read from disk the first time
+   */
+  BitmapPage<PAGE_SIZE> *GetExtentBitmap(uint32_t extent_id);
+
+  /**
+   * @return the first extent with a free page, max_extents_ if the tablespace is full
+   */
+  uint32_t FindFreeExtent() const;
+
+  void SetExtentFree(uint32_t extent_id, bool has_free_page);
+
  private:
-  // stream to write db file
-  std::fstream db_io_;
-  std::string file_name_;
-  // with multiple buffer pool instances, need to protect file access
+  std::vector<std::unique_ptr<DataFile>> data_files_;
+  // number of extents the tablespace can hold
+  uint32_t max_extents_{0};
+  bool direct_io_{false};
+  // asynchronous page I/O, nullptr if not available
+  std::unique_ptr<IOUring> io_uring_;
+  // protects page allocation, page I/O itself is not latched
   std::recursive_mutex db_io_latch_;
   bool closed{false};
-  char meta_data_[PAGE_SIZE];
+  // bitmap pages read so far, indexed by extent id
+  std::vector<std::unique_ptr<ExtentBitmap>> bitmaps_;
+  // bit i is set if extent i has a free page
+  std::vector<uint64_t> free_extents_;
 };
 
 #endif
\ No newline at end of file
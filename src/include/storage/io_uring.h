@@ -0,0 +1,107 @@
+#ifndef MINISQL_IO_URING_H
+#define MINISQL_IO_URING_H
+
+#include <linux/io_uring.h>
+#include <sys/types.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+/**
+ * State of one asynchronous read or write, shared by the ring and the handle of the request.
+ */
+struct IORequest {
+  std::atomic<bool> done_{false};
+  // bytes transferred, or -errno
+  ssize_t result_{0};
+  // the tail of a short read is zeroed, as reading past the end of file returns a zeroed page
+  char *read_buffer_{nullptr};
+  size_t length_{0};
+};
+
+class IOUring;
+
+/**
+ * Completion handle returned by the asynchronous page I/O calls of DiskManager.
+ */
+class IOHandle {
+ public:
+  /** A handle of an I/O which completed synchronously. */
+  explicit IOHandle(ssize_t result = 0);
+
+  IOHandle(std::shared_ptr<IORequest> request, IOUring *ring);
+
+  /** @return true if the I/O has completed */
+  bool IsDone() const { return request_->done_.load(std::memory_order_acquire); }
+
+  /**
+   * Block until the I/O completes.
+   * @return true if the I/O succeeded, a read past the end of file succeeds with the missing part zeroed
+   */
+  bool Wait();
+
+ private:
+  std::shared_ptr<IORequest> request_;
+  IOUring *ring_{nullptr};
+};
+
+/**
+ * A minimal io_uring built directly on the system calls, so that no library is needed. Requests are submitted as
+ * soon as they are queued, and completions are reaped by whichever thread waits for one.
+ */
+class IOUring {
+ public:
+  /**
+   * @param queue_depth number of entries of the submission queue
+   * @return nullptr if io_uring is not available, so that the caller can fall back to synchronous I/O
+   */
+  static std::unique_ptr<IOUring> Create(unsigned queue_depth);
+
+  /**
+   * Waits for all the requests in flight before tearing the ring down.
+   */
+  ~IOUring();
+
+  IOHandle Read(int fd, char *buffer, size_t length, off_t offset);
+
+  IOHandle Write(int fd, const char *buffer, size_t length, off_t offset);
+
+  /**
+   * Reap completions until the request is done.
+   */
+  void Wait(IORequest *request);
+
+ private:
+  IOUring() = default;
+
+  IOHandle Submit(uint8_t opcode, int fd, char *buffer, size_t length, off_t offset);
+
+  /** Complete every request found in the completion queue, called with complete_latch_ held */
+  void ReapCompletions();
+
+ private:
+  int ring_fd_{-1};
+  unsigned sq_entries_{0};
+  void *ring_ptr_{nullptr};
+  size_t ring_size_{0};
+  io_uring_sqe *sqes_{nullptr};
+  size_t sqes_size_{0};
+  // submission queue
+  unsigned *sq_head_{nullptr};
+  unsigned *sq_tail_{nullptr};
+  unsigned *sq_mask_{nullptr};
+  unsigned *sq_array_{nullptr};
+  // completion queue
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned *cq_mask_{nullptr};
+  io_uring_cqe *cqes_{nullptr};
+  // keeps the requests alive until the kernel is done with them
+  std::unordered_map<IORequest *, std::shared_ptr<IORequest>> in_flight_;
+  std::mutex submit_latch_;
+  std::mutex complete_latch_;
+};
+
+#endif  // MINISQL_IO_URING_H
@@ -1,14 +1,36 @@
 #ifndef MINISQL_TABLE_HEAP_H
 #define MINISQL_TABLE_HEAP_H
 
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
 #include "concurrency/lock_manager.h"
+#include "page/free_space_map_page.h"
 #include "page/header_page.h"
+#include "page/overflow_page.h"
 #include "page/table_page.h"
+#include "page/zone_map_page.h"
 #include "recovery/log_manager.h"
 #include "storage/table_iterator.h"
 
-class TableHeap {
+/**
+ * A table heap is a doubly linked list of table pages. A free space map, stored in its own chain of pages, records
+ * how much room is left in every table page, so an insert goes straight to a page where the tuple fits instead of
+ * walking the list. The map is a hint: it is updated after the table page is released and an insert that finds the
+ * page full tries again with the actual free space recorded.
+ *
+ * A zone map, the bounds of the int and float columns of every table page, is kept next to the free space map in the
+ * same order, so that a scan can skip the pages which cannot satisfy its predicate.
+ *
+ * A char value longer than the external threshold is stored out of line, in a chain of overflow pages of its own, and
+ * the tuple only keeps a pointer to it, so that the table pages stay dense for the other columns. So are all the char
+ * values of a row which would not fit in a page otherwise. The values are read back when a row is copied out of the
+ * heap, and the chains are freed with the tuples which point to them.
+ */
+class TableHeap : public ExternalValueReader {
   friend class TableIterator;
 
  public:
@@ -17,12 +39,14 @@ class TableHeap {
     return new TableHeap(buffer_pool_manager, schema, txn, log_manager, lock_manager);
   }
 
-  static TableHeap *Create(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, Schema *schema,
-                           LogManager *log_manager, LockManager *lock_manager) {
-    return new TableHeap(buffer_pool_manager, first_page_id, schema, log_manager, lock_manager);
+  static TableHeap *Create(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, page_id_t fsm_page_id,
+                           page_id_t zone_map_page_id, Schema *schema, LogManager *log_manager,
+                           LockManager *lock_manager) {
+    return new TableHeap(buffer_pool_manager, first_page_id, fsm_page_id, zone_map_page_id, schema, log_manager,
+                         lock_manager);
   }
 
-  ~TableHeap() {}
+  ~TableHeap() override {}
 
   /**
    * Insert a tuple into the table. If the tuple is too large (>= page_size), return false.
@@ -32,6 +56,16 @@ class TableHeap {
    */
   bool InsertTuple(Row &row, Txn *txn);
 
+  /**
+   * Append rows to the end of the table, e.g. for a bulk load. Each page is filled to capacity with one pin and one
+   * latch, and fresh pages are allocated back to back as the previous one fills up. Room left in the middle of the
+   * table is not used.
+   * @param[in/out] rows Rows to insert, the rids of the inserted tuples are wrapped in the rows in order
+   * @param[in] txn The transaction performing the insert
+   * @return number of rows inserted, less than all of them only if a row is too large or a page cannot be allocated
+   */
+  size_t InsertBatch(std::vector<Row> &rows, Txn *txn);
+
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
    * @param[in] rid Resource id of the tuple of delete
@@ -67,9 +101,10 @@ class TableHeap {
    * Read a tuple from the table.
    * @param[in/out] row Output variable for the tuple, row id of the tuple is wrapped in row
    * @param[in] txn recovery performing the read
+   * @param[in] access_type tells the buffer pool whether the read is part of a sequential scan
    * @return true if the read was successful (i.e. the tuple exists)
    */
-  bool GetTuple(Row *row, Txn *txn);
+  bool GetTuple(Row *row, Txn *txn, AccessType access_type = AccessType::DEFAULT_ACCESS);
 
   void FreeTableHeap() {
     auto next_page_id = first_page_id_;
@@ -78,11 +113,26 @@ class TableHeap {
       auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(old_page_id));
       assert(page != nullptr);
       next_page_id = page->GetNextPageId();
+      std::vector<ExternalValue> values;
+      GetExternalValues(page, false, &values);
       buffer_pool_manager_->UnpinPage(old_page_id, false);
       buffer_pool_manager_->DeletePage(old_page_id);
+      FreeExternalValues(values);
     }
+    FreeFreeSpaceMap();
   }
 
+  /**
+   * Reclaim the room of deleted tuples. Every page is compacted, then the tuples of the last pages are moved into the
+   * room left in the first ones and the pages emptied this way are unlinked from the list and returned to the disk
+   * manager. The free space map and the zone map are written again for the pages left.
+   * @param txn The transaction performing the vacuum
+   * @param on_move if given, called with every moved tuple, which holds its new rid, and its old rid, e.g. to update
+   * the indexes of the table
+   * @return number of pages returned to the disk manager
+   */
+  size_t Vacuum(Txn *txn, const std::function<void(const Row &, const RowId &)> &on_move = nullptr);
+
   /**
    * Free table heap and release storage in disk file
    */
@@ -93,6 +143,11 @@ class TableHeap {
    */
   TableIterator Begin(Txn *txn);
 
+  /**
+   * @return an iterator over the pages of the page list from begin_page_id up to, not including, end_page_id
+   */
+  TableIterator Begin(Txn *txn, page_id_t begin_page_id, page_id_t end_page_id);
+
   /**
    * @return the end iterator of this table
    */
@@ -103,6 +158,35 @@ class TableHeap {
    */
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
+  /**
+   * @return the id of the first page of the free space map of this table
+   */
+  inline page_id_t GetFreeSpaceMapPageId() const { return fsm_page_id_; }
+
+  /**
+   * @return the id of the first page of the zone map of this table
+   */
+  inline page_id_t GetZoneMapPageId() const { return zone_map_page_id_; }
+
+  /**
+   * The page directory of the table, read from the free space map, which records the table pages in the order of the
+   * page list. Unlike the list, it can be split into page ranges, e.g. to scan them in parallel.
+   * @param filter if given, called with the zone map of every page
+   * @param[out] may_match whether each page may hold a tuple accepted by the filter, all of them without a filter
+   * @return ids of the table pages in the order of the page list
+   */
+  std::vector<page_id_t> GetPageDirectory(const std::function<bool(const ZoneMapEntry &)> &filter = nullptr,
+                                          std::vector<bool> *may_match = nullptr);
+
+  /**
+   * Char values longer than threshold bytes are stored out of line by the next inserts and updates.
+   */
+  inline void SetExternalThreshold(uint32_t threshold) { external_threshold_ = threshold; }
+
+  inline uint32_t GetExternalThreshold() const { return external_threshold_; }
+
+  void ReadExternalValue(const ExternalValue &value, char *buf) const override;
+
  private:
   /**
    * create table heap and initialize first page
@@ -111,26 +195,132 @@ class TableHeap {
                      LockManager *lock_manager)
       : buffer_pool_manager_(buffer_pool_manager),
         schema_(schema),
+        zone_layout_(schema),
         log_manager_(log_manager),
         lock_manager_(lock_manager) {
     //ASSERT(false, "Not implemented yet.");
     auto page = reinterpret_cast<TablePage *>(buffer_pool_manager->NewPage(first_page_id_));
-    page->Init(first_page_id_,PAGE_SIZE,log_manager,txn);
+    page->Init(first_page_id_,INVALID_PAGE_ID,log_manager,txn);
+    uint32_t free_space = page->GetFreeSpaceRemaining();
     buffer_pool_manager->UnpinPage(first_page_id_, true);
+    auto fsm_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager->NewPage(fsm_page_id_)->GetData());
+    fsm_page->Init();
+    buffer_pool_manager->UnpinPage(fsm_page_id_, true);
+    auto zone_map_page = reinterpret_cast<ZoneMapPage *>(buffer_pool_manager->NewPage(zone_map_page_id_)->GetData());
+    zone_map_page->Init();
+    buffer_pool_manager->UnpinPage(zone_map_page_id_, true);
+    fsm_loaded_ = true;
+    RegisterPage(first_page_id_, free_space);
   };
 
-  explicit TableHeap(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, Schema *schema,
-                     LogManager *log_manager, LockManager *lock_manager)
+  explicit TableHeap(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, page_id_t fsm_page_id,
+                     page_id_t zone_map_page_id, Schema *schema, LogManager *log_manager, LockManager *lock_manager)
       : buffer_pool_manager_(buffer_pool_manager),
         first_page_id_(first_page_id),
+        fsm_page_id_(fsm_page_id),
+        zone_map_page_id_(zone_map_page_id),
         schema_(schema),
+        zone_layout_(schema),
         log_manager_(log_manager),
         lock_manager_(lock_manager) {}
 
+  /**
+   * Read the chains of free space map and zone map pages into memory, called with fsm_latch_ held
+   */
+  void LoadFreeSpaceMap();
+
+  /**
+   * Find a page with at least free_space bytes left, appending a new page to the heap if there is none.
+   * @return INVALID_PAGE_ID if no page can be allocated
+   */
+  page_id_t GetPageForInsert(uint32_t free_space, Txn *txn);
+
+  /**
+   * Record a new table page in the free space map and give it an empty zone map, called with fsm_latch_ held
+   */
+  void RegisterPage(page_id_t page_id, uint32_t free_space);
+
+  /**
+   * Record the free space left in a table page after it changed.
+   * @param row if given, a row written to the page, its values widen the zone map of the page
+   * @param is_empty true if the page has no tuple left, its zone map is then cleared
+   */
+  void UpdateFreeSpace(page_id_t page_id, uint32_t free_space, const Row *row = nullptr, bool is_empty = false);
+
+  /**
+   * UpdateFreeSpace, called with fsm_latch_ held
+   */
+  void SetFreeSpace(page_id_t page_id, uint32_t free_space);
+
+  /**
+   * Apply a change to the zone map of a table page, called with fsm_latch_ held
+   */
+  void UpdateZoneMap(page_id_t page_id, const std::function<void(ZoneMapEntry &)> &update);
+
+  /**
+   * Write the free space map and the zone map again for the given table pages, in the order given, keeping the first
+   * page of each map. Called with fsm_latch_ held.
+   */
+  void RebuildFreeSpaceMap(const std::vector<page_id_t> &page_ids, Txn *txn);
+
+  /**
+   * Delete the pages of the free space map and of the zone map
+   */
+  void FreeFreeSpaceMap();
+
+  /**
+   * Store the char values of a row which go out of line.
+   * @param[out] stored_row the row with pointers in place of these values, left empty if there is none
+   * @return the row to write to the table page, i.e. stored_row or row itself, nullptr if a value cannot be stored
+   */
+  Row *StoreExternalValues(Row &row, Row *stored_row, Txn *txn);
+
+  /**
+   * Write a value to a new chain of overflow pages.
+   * @return pointer to the value, with an invalid page id if a page cannot be allocated
+   */
+  ExternalValue StoreExternalValue(const char *data, uint32_t length, Txn *txn);
+
+  /**
+   * Replace the pointers of a row read from a table page by the values they point to
+   */
+  void LoadExternalValues(Row *row) const;
+
+  /**
+   * Find the values a tuple stores out of line
+   */
+  static void GetExternalValues(const Row &row, std::vector<ExternalValue> *values);
+
+  /**
+   * Find the values the tuples of a table page store out of line, called with the page latched.
+   * @param deleted_only whether only the tuples marked as deleted are looked at
+   */
+  void GetExternalValues(TablePage *page, bool deleted_only, std::vector<ExternalValue> *values);
+
+  /**
+   * Delete the chains of overflow pages of the values
+   */
+  void FreeExternalValues(const std::vector<ExternalValue> &values);
+
  private:
   BufferPoolManager *buffer_pool_manager_;
   page_id_t first_page_id_;
+  page_id_t fsm_page_id_{INVALID_PAGE_ID};
+  // the free space map is read lazily, the state below mirrors it
+  std::mutex fsm_latch_;
+  bool fsm_loaded_{false};
+  page_id_t last_page_id_{INVALID_PAGE_ID};
+  std::vector<page_id_t> fsm_pages_;
+  // largest free space category of every page of the map, to skip the map pages without a fitting table page
+  std::vector<uint8_t> fsm_max_category_;
+  // position of every table page in the map, i.e. index of its map page * MAX_ENTRIES + slot
+  std::unordered_map<page_id_t, uint32_t> fsm_slots_;
+  // the zone map of the table page at position i of the free space map is in zone_map_pages_[i / entries per page]
+  page_id_t zone_map_page_id_{INVALID_PAGE_ID};
+  std::vector<page_id_t> zone_map_pages_;
   Schema *schema_;
+  ZoneMapLayout zone_layout_;
+  uint32_t external_threshold_{EXTERNAL_THRESHOLD};
   [[maybe_unused]] LogManager *log_manager_;
   [[maybe_unused]] LockManager *lock_manager_;
 };
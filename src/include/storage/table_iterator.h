@@ -1,18 +1,35 @@
 #ifndef MINISQL_TABLE_ITERATOR_H
 #define MINISQL_TABLE_ITERATOR_H
 
+#include <functional>
+
+#include "buffer/buffer_pool_manager.h"
 #include "common/rowid.h"
 #include "concurrency/txn.h"
+#include "page/table_page.h"
 #include "record/row.h"
+#include "record/row_view.h"
 
 class TableHeap;
 
+/**
+ * Iterator over the tuples of a table heap.
+ *
+ * The page of the current tuple stays pinned until the iterator moves past its last tuple, the slots are walked in
+ * the page itself, so stepping to the next tuple does not go through the buffer pool. The page is only latched while
+ * the iterator reads it. The row is copied out of the page the first time it is dereferenced.
+ */
 class TableIterator {
-public:
- // you may define your own constructor based on your member variables
- explicit TableIterator(TableHeap *tableHeap, RowId rid, Txn *txn);
+ public:
+  /**
+   * An iterator at the first tuple at or after rid, an invalid rid gives the end of the heap.
+   * @param end_page_id the iterator ends when it reaches this page, to scan a part of the page list
+   */
+  explicit TableIterator(TableHeap *table_heap, RowId rid, Txn *txn, page_id_t end_page_id = INVALID_PAGE_ID);
+
+  TableIterator(const TableIterator &other);
 
- explicit TableIterator(const TableIterator &other);
+  TableIterator(TableIterator &&other) noexcept;
 
   virtual ~TableIterator();
 
@@ -24,16 +41,39 @@ public:
 
   Row *operator->();
 
-  TableIterator &operator=(const TableIterator &itr) noexcept;
+  TableIterator &operator=(const TableIterator &itr);
+
+  TableIterator &operator=(TableIterator &&itr) noexcept;
 
   TableIterator &operator++();
 
   TableIterator operator++(int);
 
-private:
-  // add your own private member variables here
-  TableHeap* table_heap_;
-  Row* row_;
+  /**
+   * Move forward to the first tuple, starting from the current one, which is accepted. The callback is given a view
+   * of each tuple while its page is latched, e.g. to test a predicate and copy out the tuples it accepts.
+   * @return false if the end of the heap is reached
+   */
+  bool SkipUntil(const std::function<bool(const RowView &)> &accept);
+
+ private:
+  /** Move to the next tuple after rid_, going down the page list. */
+  void MoveToNextTuple();
+
+  /** Unpin the current page. */
+  void Release();
+
+  TableHeap *table_heap_;
+  // pinned page of the current tuple, nullptr at the end of the heap
+  TablePage *page_{nullptr};
+  RowId rid_{INVALID_ROWID};
+  page_id_t end_page_id_;
+  Txn *txn_;
+  // the current row, only loaded from the page when the iterator is dereferenced
+  Row row_;
+  bool row_loaded_{false};
+  RowView view_;
+  ReadAheadState read_ahead_;
 };
 
 #endif  // MINISQL_TABLE_ITERATOR_H
@@ -1,5 +1,6 @@
 #include "index/b_plus_tree.h"
 
+#include <algorithm>
 #include <string>
 
 #include "glog/logging.h"
@@ -37,14 +38,17 @@ BPlusTree::BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager
 }
 
 void BPlusTree::Destroy(page_id_t current_page_id) {
-  if (IsEmpty()) {
-    return;
-  }
   // buffer_pool_manager_->DeletePage(current_page_id); // no direct delete!!!
   if(current_page_id == INVALID_PAGE_ID) {
+    root_latch_.WLock();
+    if (IsEmpty()) {
+      root_latch_.WUnlock();
+      return;
+    }
     current_page_id = root_page_id_;
     root_page_id_ = INVALID_PAGE_ID;
     UpdateRootPageId(2);
+    root_latch_.WUnlock();
   }
   auto page = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(current_page_id)->GetData());
   if(!page->IsLeafPage()) { // recursively
@@ -73,22 +77,19 @@ bool BPlusTree::IsEmpty() const {
  * @return : true means key exists
  */
 bool BPlusTree::GetValue(const GenericKey *key, std::vector<RowId> &result, Txn *transaction) { 
-  if (IsEmpty()){
-    return false;
-  }
-  auto* Page = FindLeafPage(key);
+  auto* Page = FindLeafPageOptimistic(key, false, false);
   if (Page == nullptr){
     return false;
   }
   auto* leaf = reinterpret_cast<LeafPage*>(Page->GetData());
   RowId value;
-  if (leaf->Lookup(key, value, processor_)){
+  bool found = leaf->Lookup(key, value, processor_);
+  if (found){
     result.push_back(value);
-    buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
-    return true;
   }
+  Page->RUnlatch();
   buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
-  return false;
+  return found;
 }
 /*****************************************************************************
  * INSERTION
@@ -101,12 +102,36 @@ bool BPlusTree::GetValue(const GenericKey *key, std::vector<RowId> &result, Txn
  * keys return false, otherwise return true.
  */
 bool BPlusTree::Insert(GenericKey *key, const RowId &value, Txn *transaction) { 
+  // optimistic, only the leaf is write latched, which is enough unless it splits
+  Page *page = FindLeafPageOptimistic(key, false, true);
+  if (page != nullptr) {
+    auto *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+    RowId val;
+    bool exists = leaf_page->Lookup(key, val, processor_);
+    bool safe = exists || IsSafe(leaf_page, Operation::kInsert, false);
+    if (safe && !exists) {
+      leaf_page->Insert(key, value, processor_);
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), safe && !exists);
+    if (safe) {
+      return !exists;
+    }
+  }
+  // pessimistic, the pages that may change stay write latched
+  root_latch_.WLock();
+  bool root_latched = true;
   if (IsEmpty()){
     // LOG(INFO) << "BPlusTree::Insert first key" << std::endl;
     StartNewTree(key, value);
+    root_latch_.WUnlock();
     return true;
-  } 
-  return InsertIntoLeaf(key, value, transaction);
+  }
+  std::vector<Page *> latched_pages;
+  page = FindLeafPagePessimistic(key, Operation::kInsert, latched_pages, root_latched);
+  bool inserted = InsertIntoLeaf(reinterpret_cast<LeafPage *>(page->GetData()), key, value, transaction);
+  ReleaseLatchedPages(latched_pages, root_latched);
+  return inserted;
 }
 /*
  * Insert constant key & value pair into an empty tree
@@ -126,29 +151,23 @@ void BPlusTree::StartNewTree(GenericKey *key, const RowId &value) {
 
 /*
  * Insert constant key & value pair into leaf page
- * User needs to first find the right leaf page as insertion target, then look
+ * The leaf page is the write latched target found by the caller, look
  * through leaf page to see whether insert key exist or not. If exist, return
  * immediately, otherwise insert entry. Remember to deal with split if necessary.
  * @return: since we only support unique key, if user try to insert duplicate
  * keys return false, otherwise return true.
  */
-bool BPlusTree::InsertIntoLeaf(GenericKey *key, const RowId &value, Txn *transaction) { 
-  auto* Page = FindLeafPage(key);
-  auto* leaf_page = reinterpret_cast<LeafPage*>(Page->GetData());
+bool BPlusTree::InsertIntoLeaf(LeafPage *leaf_page, GenericKey *key, const RowId &value, Txn *transaction) { 
   RowId val;
-  // cout << 666 << endl;
   if (leaf_page->Lookup(key, val, processor_)){
-    // cout << 777 << endl;
-    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
     return false;
   }
   leaf_page->Insert(key, value, processor_); // insert
   if (leaf_page->GetSize() >= leaf_max_size_){ // split
     auto* new_page = Split(leaf_page, transaction);
     InsertIntoParent(leaf_page, new_page->KeyAt(0), new_page, transaction);
-    // buffer_pool_manager_->UnpinPage(new_page->GetPageId(), true);
+    buffer_pool_manager_->UnpinPage(new_page->GetPageId(), true);
   }
-  buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);
   return true; 
 }
 
@@ -158,6 +177,9 @@ bool BPlusTree::InsertIntoLeaf(GenericKey *key, const RowId &value, Txn *transac
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
  * an "out of memory" exception if returned value is nullptr), then move half
  * of key & value pairs from input page to newly created page
+ * The new page stays pinned until the caller has linked it into the parent, it
+ * needs no latch as no other thread can reach it before the latches of the
+ * split page are released.
  */
 BPlusTreeInternalPage *BPlusTree::Split(InternalPage *node, Txn *transaction) { 
   page_id_t new_page_id;
@@ -168,7 +190,6 @@ BPlusTreeInternalPage *BPlusTree::Split(InternalPage *node, Txn *transaction) {
   auto* new_page = reinterpret_cast<InternalPage*>(Page->GetData());
   new_page->Init(new_page_id, node->GetParentPageId(), node->GetKeySize(), node->GetMaxSize());
   node->MoveHalfTo(new_page, buffer_pool_manager_);
-  buffer_pool_manager_->UnpinPage(new_page_id, true);
   return new_page;
 }
 
@@ -183,7 +204,6 @@ BPlusTreeLeafPage *BPlusTree::Split(LeafPage *node, Txn *transaction) {
   new_page->SetNextPageId(node->GetNextPageId());
   node->SetNextPageId(new_page_id); // at leaf, need direct insert
   node->MoveHalfTo(new_page);
-  buffer_pool_manager_->UnpinPage(new_page_id, true);
   return new_page;
 }
 
@@ -213,11 +233,177 @@ void BPlusTree::InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlus
     if (size >= internal_max_size_) { // need father split
       auto *parent_sib = Split(parent_page, transaction); // father sibling
       InsertIntoParent(parent_page, parent_sib->KeyAt(0), parent_sib, transaction);
+      buffer_pool_manager_->UnpinPage(parent_sib->GetPageId(), true);
     }
     buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
   }
 }
 
+/*****************************************************************************
+ * BULK LOAD
+ *****************************************************************************/
+/*
+ * Build the empty tree bottom-up from entries in key order. The leaves are
+ * filled left to right and written once, and every full page is added to the
+ * internal page being filled one level up, so no page is ever split.
+ * The last page of a level is only added to its parent with the page after it,
+ * so that BulkLoadFinish can still even out the last two pages of each level.
+ */
+bool BPlusTree::BulkLoad(const std::function<bool(GenericKey *&, RowId &)> &next_entry, double fill_factor) {
+  root_latch_.WLock();
+  if (!IsEmpty()) {
+    root_latch_.WUnlock();
+    return false;
+  }
+  int leaf_fill = BulkLoadFill(leaf_max_size_, 1, fill_factor);
+  int internal_fill = BulkLoadFill(internal_max_size_, 2, fill_factor);
+  std::vector<BulkLoadLevel> levels(1);
+  GenericKey *key;
+  RowId value;
+  while (next_entry(key, value)) {
+    auto *leaf = levels[0].open == nullptr ? nullptr : reinterpret_cast<LeafPage *>(levels[0].open->GetData());
+    // unique keys, the first entry of a key wins like with Insert
+    if (leaf != nullptr && processor_.CompareKeys(leaf->KeyAt(leaf->GetSize() - 1), key) == 0) {
+      continue;
+    }
+    if (leaf == nullptr || leaf->GetSize() == leaf_fill) {
+      Page *page = BulkLoadNewPage(true);
+      if (leaf != nullptr) {
+        leaf->SetNextPageId(page->GetPageId());
+        if (levels[0].full != nullptr) {
+          BulkLoadAddChild(levels, 1, levels[0].full, internal_fill);
+        }
+        levels[0].full = levels[0].open;
+      }
+      levels[0].open = page;
+      leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    }
+    leaf->SetKeyAt(leaf->GetSize(), key);
+    leaf->SetValueAt(leaf->GetSize(), value);
+    leaf->IncreaseSize(1);
+  }
+  BulkLoadFinish(levels, internal_fill);
+  root_latch_.WUnlock();
+  return true;
+}
+
+/*
+ * A page is split once it reaches its max size, so it holds max size - 1
+ * entries at most, and a page filled below its min size would underflow.
+ */
+int BPlusTree::BulkLoadFill(int max_size, int min_entries, double fill_factor) const {
+  int capacity = max_size - 1;
+  int fill = static_cast<int>(fill_factor * capacity);
+  return std::min(capacity, std::max({fill, max_size / 2, min_entries}));
+}
+
+Page *BPlusTree::BulkLoadNewPage(bool is_leaf) {
+  page_id_t page_id;
+  Page *page = buffer_pool_manager_->NewPage(page_id);
+  ASSERT(page != nullptr, "Out of memory in bulk load.");
+  if (is_leaf) {
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    leaf->Init(page_id, INVALID_PAGE_ID, processor_.GetKeySize(), leaf_max_size_);
+  } else {
+    auto *internal = reinterpret_cast<InternalPage *>(page->GetData());
+    internal->Init(page_id, INVALID_PAGE_ID, processor_.GetKeySize(), internal_max_size_);
+  }
+  return page;
+}
+
+void BPlusTree::BulkLoadAddChild(std::vector<BulkLoadLevel> &levels, size_t level, Page *child, int internal_fill) {
+  if (levels.size() == level) {
+    levels.emplace_back();
+  }
+  auto *node = levels[level].open == nullptr ? nullptr : reinterpret_cast<InternalPage *>(levels[level].open->GetData());
+  if (node == nullptr || node->GetSize() == internal_fill) {
+    Page *page = BulkLoadNewPage(false);
+    if (node != nullptr) {
+      if (levels[level].full != nullptr) {
+        BulkLoadAddChild(levels, level + 1, levels[level].full, internal_fill);
+      }
+      levels[level].full = levels[level].open;
+    }
+    levels[level].open = page;
+    node = reinterpret_cast<InternalPage *>(page->GetData());
+  }
+  // the first key of an internal page is not searched, it keeps the smallest key below the page like after a split
+  auto *child_node = reinterpret_cast<BPlusTreePage *>(child->GetData());
+  GenericKey *first_key = child_node->IsLeafPage() ? reinterpret_cast<LeafPage *>(child_node)->KeyAt(0)
+                                                   : reinterpret_cast<InternalPage *>(child_node)->KeyAt(0);
+  int size = node->GetSize();
+  node->SetKeyAt(size, first_key);
+  node->SetValueAt(size, child->GetPageId());
+  node->IncreaseSize(1);
+  child_node->SetParentPageId(node->GetPageId());
+  buffer_pool_manager_->UnpinPage(child->GetPageId(), true);
+}
+
+/*
+ * Level by level from the leaves: the last page of a level may be below its
+ * min size, it is then merged into the page before it, or takes entries from
+ * it. Then both are added to their parents, and a level left with one page is
+ * the root.
+ */
+void BPlusTree::BulkLoadFinish(std::vector<BulkLoadLevel> &levels, int internal_fill) {
+  for (size_t level = 0; level < levels.size(); level++) {
+    Page *full = levels[level].full;
+    Page *open = levels[level].open;
+    if (open == nullptr) {
+      // no entry was loaded, the tree stays empty
+      return;
+    }
+    auto *open_node = reinterpret_cast<BPlusTreePage *>(open->GetData());
+    if (full != nullptr && open_node->GetSize() < open_node->GetMinSize()) {
+      auto *full_node = reinterpret_cast<BPlusTreePage *>(full->GetData());
+      bool merge = full_node->GetSize() + open_node->GetSize() < open_node->GetMaxSize();
+      if (open_node->IsLeafPage()) {
+        auto *full_leaf = reinterpret_cast<LeafPage *>(full_node);
+        auto *open_leaf = reinterpret_cast<LeafPage *>(open_node);
+        if (merge) {
+          open_leaf->MoveAllTo(full_leaf);
+        }
+        while (!merge && open_leaf->GetSize() < open_leaf->GetMinSize()) {
+          full_leaf->MoveLastToFrontOf(open_leaf);
+        }
+      } else {
+        // the children below are all unpinned, the moved ones are fetched to update their parent
+        auto *full_internal = reinterpret_cast<InternalPage *>(full_node);
+        auto *open_internal = reinterpret_cast<InternalPage *>(open_node);
+        GenericKey *middle_key = processor_.InitKey();
+        memcpy(middle_key, open_internal->KeyAt(0), processor_.GetKeySize());
+        if (merge) {
+          open_internal->MoveAllTo(full_internal, middle_key, buffer_pool_manager_);
+        }
+        while (!merge && open_internal->GetSize() < open_internal->GetMinSize()) {
+          full_internal->MoveLastToFrontOf(open_internal, middle_key, buffer_pool_manager_);
+          memcpy(middle_key, open_internal->KeyAt(0), processor_.GetKeySize());
+        }
+        free(middle_key);
+      }
+      if (merge) {
+        buffer_pool_manager_->UnpinPage(open->GetPageId(), false);
+        buffer_pool_manager_->DeletePage(open->GetPageId());
+        open = nullptr;
+      }
+    }
+    if (levels.size() == level + 1 && (full == nullptr || open == nullptr)) {
+      // a single page left at the top level is the root
+      Page *root = open == nullptr ? full : open;
+      root_page_id_ = root->GetPageId();
+      UpdateRootPageId(1);
+      buffer_pool_manager_->UnpinPage(root_page_id_, true);
+      return;
+    }
+    if (full != nullptr) {
+      BulkLoadAddChild(levels, level + 1, full, internal_fill);
+    }
+    if (open != nullptr) {
+      BulkLoadAddChild(levels, level + 1, open, internal_fill);
+    }
+  }
+}
+
 /*****************************************************************************
  * REMOVE
  *****************************************************************************/
@@ -229,20 +415,39 @@ void BPlusTree::InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlus
  * necessary.
  */
 void BPlusTree::Remove(const GenericKey *key, Txn *transaction) {
-  if (IsEmpty()){
+  // optimistic, only the leaf is write latched, which is enough unless it underflows
+  bool is_root;
+  auto* page = FindLeafPageOptimistic(key, false, true, &is_root);
+  if (page == nullptr){
     return;
   }
-  auto* page = FindLeafPage(key);
   auto* leaf_page = reinterpret_cast<LeafPage*>(page->GetData());
+  RowId val;
+  bool exists = leaf_page->Lookup(key, val, processor_);
+  bool safe = !exists || IsSafe(leaf_page, Operation::kRemove, is_root);
+  if (safe && exists) {
+    leaf_page->RemoveAndDeleteRecord(key, processor_);
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), safe && exists);
+  if (safe) {
+    return;
+  }
+  // pessimistic, the pages that may change stay write latched
+  root_latch_.WLock();
+  bool root_latched = true;
+  if (IsEmpty()){
+    root_latch_.WUnlock();
+    return;
+  }
+  std::vector<Page *> latched_pages;
+  page = FindLeafPagePessimistic(key, Operation::kRemove, latched_pages, root_latched);
+  leaf_page = reinterpret_cast<LeafPage*>(page->GetData());
   int now_siz = leaf_page->GetSize();
   if (now_siz > leaf_page->RemoveAndDeleteRecord(key, processor_)){
     CoalesceOrRedistribute(leaf_page, transaction); // need to redistribute or merge
-    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);
-  }
-  else{
-    // LOG(ERROR) << "Remove() : RemoveAndDeleteRecord() failed";
-    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
   }
+  ReleaseLatchedPages(latched_pages, root_latched);
 }
 
 /* todo
@@ -257,21 +462,25 @@ bool BPlusTree::CoalesceOrRedistribute(N *&node, Txn *transaction) {
   if (node->IsRootPage()){
     return AdjustRoot(node); //
   }
-  page_id_t parent_id = node->GetParentPageId();
-  auto* parent = reinterpret_cast<InternalPage*>(buffer_pool_manager_->FetchPage(node->GetParentPageId())->GetData());
-  int now_index = parent->ValueIndex(node->GetPageId());
-
+  // the node is still at least half full, the parent is not needed
   if (node->GetSize() >= node->GetMinSize()){
-    // buffer_pool_manager_->UnpinPage(parent_id, false);
     return false;
   }
+  page_id_t parent_id = node->GetParentPageId();
+  auto* parent = reinterpret_cast<InternalPage*>(buffer_pool_manager_->FetchPage(node->GetParentPageId())->GetData());
+  int now_index = parent->ValueIndex(node->GetPageId());
 
   int sibling_index = (now_index == 0) ? 1 : now_index - 1;
   page_id_t sibling_id = parent->ValueAt(sibling_index);
-  auto* sibling = reinterpret_cast<N*>(buffer_pool_manager_->FetchPage(sibling_id)->GetData()); // get sibling
+  // the sibling is latched after its parent, another writer in it does not hold the parent and waits for nothing here
+  Page *sibling_page = buffer_pool_manager_->FetchPage(sibling_id);
+  sibling_page->WLatch();
+  auto* sibling = reinterpret_cast<N*>(sibling_page->GetData()); // get sibling
   int flag = 0;
-  if (node->GetSize()+sibling->GetSize() > node->GetMaxSize()){
+  // a page is split once it reaches its max size, so a merged page must stay below it
+  if (node->GetSize()+sibling->GetSize() >= node->GetMaxSize()){
     Redistribute(sibling, node, now_index);
+    sibling_page->WUnlatch();
     buffer_pool_manager_->UnpinPage(sibling->GetPageId(), true);
     buffer_pool_manager_->UnpinPage(parent_id, true);
   }
@@ -282,7 +491,8 @@ bool BPlusTree::CoalesceOrRedistribute(N *&node, Txn *transaction) {
     else{
       Coalesce(sibling, node, parent, now_index, transaction);
     }
-    buffer_pool_manager_->UnpinPage(sibling->GetPageId(), false);
+    sibling_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(sibling->GetPageId(), true);
     buffer_pool_manager_->UnpinPage(parent_id, true);
     flag = 1;
   }
@@ -395,8 +605,12 @@ bool BPlusTree::AdjustRoot(BPlusTreePage *old_root_node) {
  * @return : index iterator
  */
 IndexIterator BPlusTree::Begin() {
-  auto* page = reinterpret_cast<LeafPage*>(FindLeafPage(nullptr, INVALID_PAGE_ID, true)->GetData());
-  page_id_t page_id = page->GetPageId();
+  Page *leaf = FindLeafPageOptimistic(nullptr, true, false);
+  if (leaf == nullptr) {
+    return End();
+  }
+  page_id_t page_id = leaf->GetPageId();
+  leaf->RUnlatch();
   buffer_pool_manager_->UnpinPage(page_id, false);
   return IndexIterator(page_id, buffer_pool_manager_, 0);
 }
@@ -407,11 +621,26 @@ IndexIterator BPlusTree::Begin() {
  * @return : index iterator
  */
 IndexIterator BPlusTree::Begin(const GenericKey *key) {
-   auto* page = reinterpret_cast<LeafPage*>(FindLeafPage(key, INVALID_PAGE_ID, false)->GetData());
-    page_id_t page_id = page->GetPageId();
-    int index = page->KeyIndex(key, processor_); // find index of the key
+  Page *leaf = FindLeafPageOptimistic(key, false, false);
+  if (leaf == nullptr) {
+    return End();
+  }
+  auto* page = reinterpret_cast<LeafPage*>(leaf->GetData());
+  page_id_t page_id = page->GetPageId();
+  int index = page->KeyIndex(key, processor_); // find index of the key
+  if (index == page->GetSize()) {
+    // every key of the leaf is smaller, the first larger one starts the next leaf
+    page_id_t next_page_id = page->GetNextPageId();
+    leaf->RUnlatch();
     buffer_pool_manager_->UnpinPage(page_id, false);
-    return IndexIterator(page_id, buffer_pool_manager_, index);
+    if (next_page_id == INVALID_PAGE_ID) {
+      return End();
+    }
+    return IndexIterator(next_page_id, buffer_pool_manager_, 0);
+  }
+  leaf->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  return IndexIterator(page_id, buffer_pool_manager_, index);
 }
 
 /*
@@ -434,23 +663,100 @@ IndexIterator BPlusTree::End() { // ??
  */
 Page *BPlusTree::FindLeafPage(const GenericKey *key, page_id_t page_id, bool leftMost) { // the use of page_id?
   // if(page_id == INVALID_PAGE_ID) page_id = root_page_id_;
+  Page *page = FindLeafPageOptimistic(key, leftMost, false);
+  if (page != nullptr) {
+    page->RUnlatch();
+  }
+  return page;
+}
 
+Page *BPlusTree::FindLeafPageOptimistic(const GenericKey *key, bool left_most, bool write_leaf, bool *is_root) {
+  root_latch_.RLock();
+  if (IsEmpty()) {
+    root_latch_.RUnlock();
+    return nullptr;
+  }
+  // the type of a page in the tree never changes, so it is read before latching the page
+  auto latch = [write_leaf](Page *page) {
+    if (write_leaf && reinterpret_cast<BPlusTreePage *>(page->GetData())->IsLeafPage()) {
+      page->WLatch();
+    } else {
+      page->RLatch();
+    }
+  };
   Page *page = buffer_pool_manager_->FetchPage(root_page_id_); // start from root page
+  latch(page);
+  root_latch_.RUnlock();
   auto* current_page = reinterpret_cast<BPlusTreePage*>(page->GetData());
-  page_id_t now_page_id = root_page_id_;
+  if (is_root != nullptr) {
+    // a leaf latched as the root cannot split before it is released, and another leaf cannot become the root while
+    // it is latched, as that merges it with its sibling
+    *is_root = current_page->IsLeafPage();
+  }
   while(!current_page->IsLeafPage()){
-    buffer_pool_manager_->UnpinPage(now_page_id, false);
     auto* internal_page = reinterpret_cast<InternalPage*>(current_page);
-    if (leftMost == true){
-      now_page_id = internal_page->ValueAt(0); // go left
+    page_id_t child_page_id = left_most ? internal_page->ValueAt(0) : internal_page->Lookup(key, processor_);
+    Page *child = buffer_pool_manager_->FetchPage(child_page_id);
+    latch(child);
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = child;
+    current_page = reinterpret_cast<BPlusTreePage*>(page->GetData());
+  }
+  return page;
+}
+
+Page *BPlusTree::FindLeafPagePessimistic(const GenericKey *key, Operation operation, std::vector<Page *> &latched_pages,
+                                         bool &root_latched) {
+  Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+  page->WLatch();
+  latched_pages.push_back(page);
+  auto* current_page = reinterpret_cast<BPlusTreePage*>(page->GetData());
+  while (true) {
+    // the parent of the page, or the root latch, is still held to read its parent page id
+    if (IsSafe(current_page, operation, current_page->IsRootPage())) {
+      // the ancestors are not changed by the operation
+      latched_pages.pop_back();
+      ReleaseLatchedPages(latched_pages, root_latched);
+      latched_pages.push_back(page);
     }
-    else{
-      now_page_id = internal_page->Lookup(key, processor_);
+    if (current_page->IsLeafPage()) {
+      return page;
     }
-    page = buffer_pool_manager_->FetchPage(now_page_id);
+    page_id_t child_page_id = reinterpret_cast<InternalPage*>(current_page)->Lookup(key, processor_);
+    page = buffer_pool_manager_->FetchPage(child_page_id);
+    page->WLatch();
+    latched_pages.push_back(page);
     current_page = reinterpret_cast<BPlusTreePage*>(page->GetData());
   }
-  return page;
+}
+
+void BPlusTree::ReleaseLatchedPages(std::vector<Page *> &latched_pages, bool &root_latched) {
+  if (root_latched) {
+    root_latch_.WUnlock();
+    root_latched = false;
+  }
+  for (auto page : latched_pages) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  }
+  latched_pages.clear();
+}
+
+bool BPlusTree::IsSafe(const BPlusTreePage *node, Operation operation, bool is_root) const {
+  switch (operation) {
+    case Operation::kInsert:
+      // a page splits once it reaches its max size
+      return node->GetSize() + 1 < (node->IsLeafPage() ? leaf_max_size_ : internal_max_size_);
+    case Operation::kRemove:
+      if (is_root) {
+        // a root leaf is only removed when it is emptied, a root internal page when one child is left
+        return node->GetSize() > (node->IsLeafPage() ? 1 : 2);
+      }
+      return node->GetSize() - 1 >= node->GetMinSize();
+    default:
+      return true;
+  }
 }
 
 /*
@@ -462,7 +768,10 @@ Page *BPlusTree::FindLeafPage(const GenericKey *key, page_id_t page_id, bool lef
  * updating it.
  */
 void BPlusTree::UpdateRootPageId(int insert_record) {
-  auto* rootpage = reinterpret_cast<IndexRootsPage*>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData());
+  // the page is shared by the roots of all indexes
+  Page *page = buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID);
+  page->WLatch();
+  auto* rootpage = reinterpret_cast<IndexRootsPage*>(page->GetData());
   if (insert_record == 1){
     rootpage->Insert(index_id_, root_page_id_); // insert instead of update
   } else if (insert_record == 0){
@@ -471,6 +780,7 @@ void BPlusTree::UpdateRootPageId(int insert_record) {
   else{
     rootpage->Delete(index_id_);
   }
+  page->WUnlatch();
   buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
 }
 
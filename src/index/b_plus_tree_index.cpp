@@ -1,13 +1,16 @@
 #include <algorithm>
+#include <memory>
+#include <thread>
 
 #include "index/b_plus_tree_index.h"
 
 #include "index/generic_key.h"
+#include "index/key_sorter.h"
 #include "utils/tree_file_mgr.h"
 BPlusTreeIndex::BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size,
-                               BufferPoolManager *buffer_pool_manager)
+                               BufferPoolManager *buffer_pool_manager, bool has_payload)
     : Index(index_id, key_schema),
-      processor_(key_schema_, key_size),
+      processor_(key_schema_, key_size, has_payload),
       container_(index_id, buffer_pool_manager, processor_) {}
 
 dberr_t BPlusTreeIndex::InsertEntry(const Row &key, RowId row_id, Txn *txn) {
@@ -87,6 +90,51 @@ dberr_t BPlusTreeIndex::Destroy() {
   return DB_SUCCESS;
 }
 
+dberr_t BPlusTreeIndex::BulkLoad(const std::vector<EntrySource> &sources, [[maybe_unused]] Txn *txn,
+                                 size_t sort_memory, double fill_factor) {
+  if (!container_.IsEmpty()) {
+    return DB_FAILED;
+  }
+  if (sources.empty()) {
+    return DB_SUCCESS;
+  }
+  std::vector<std::unique_ptr<KeySorter>> sorters;
+  for (size_t i = 0; i < sources.size(); i++) {
+    sorters.emplace_back(std::make_unique<KeySorter>(processor_, sort_memory / sources.size()));
+  }
+  auto extract = [&](size_t i) {
+    GenericKey *index_key = processor_.InitKey();
+    Row key;
+    RowId row_id;
+    while (sources[i](key, row_id)) {
+      processor_.SerializeFromKey(index_key, key, key_schema_);
+      sorters[i]->Add(index_key, row_id);
+    }
+    free(index_key);
+    sorters[i]->SortRun();
+  };
+  if (sources.size() == 1) {
+    extract(0);
+  } else {
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < sources.size(); i++) {
+      workers.emplace_back(extract, i);
+    }
+    for (auto &worker : workers) {
+      worker.join();
+    }
+  }
+  // the runs are merged in the order of their sources
+  KeySorter &sorter = *sorters[0];
+  for (size_t i = 1; i < sorters.size(); i++) {
+    sorter.TakeRuns(*sorters[i]);
+  }
+  sorter.Finish();
+  bool status = container_.BulkLoad([&sorter](GenericKey *&key, RowId &value) { return sorter.Next(key, value); },
+                                    fill_factor);
+  return status ? DB_SUCCESS : DB_FAILED;
+}
+
 IndexIterator BPlusTreeIndex::GetBeginIterator() {
   return container_.Begin();
 }
@@ -0,0 +1,87 @@
+#include "index/clustered_index.h"
+
+ClusteredIndex::ClusteredIndex(index_id_t index_id, IndexSchema *key_schema, Schema *table_schema,
+                               uint32_t key_column, BufferPoolManager *buffer_pool_manager)
+    : BPlusTreeIndex(index_id, key_schema, KeyManager::GetEncodedSize(key_schema) + GetMaxRowSize(table_schema),
+                     buffer_pool_manager, true),
+      table_schema_(table_schema),
+      key_column_(key_column),
+      row_offset_(KeyManager::GetEncodedSize(key_schema)) {}
+
+uint32_t ClusteredIndex::GetMaxRowSize(const Schema *schema) {
+  uint32_t column_count = schema->GetColumnCount();
+  // field count and null bitmap
+  uint32_t size = sizeof(uint32_t) + (column_count + 7) / 8;
+  for (auto column : schema->GetColumns()) {
+    size += column->GetType() == TypeId::kTypeChar ? sizeof(uint32_t) + column->GetLength()
+                                                   : Type::GetTypeSize(column->GetType());
+  }
+  return size;
+}
+
+dberr_t ClusteredIndex::InsertRow(const Row &row, Txn *txn) {
+  if (row.GetSerializedSize(table_schema_) > static_cast<uint32_t>(processor_.GetKeySize()) - row_offset_) {
+    return DB_FAILED;
+  }
+  GenericKey *entry = processor_.InitKey();
+  if (!MakeSearchKey(*row.GetField(key_column_), entry)) {
+    free(entry);
+    return DB_FAILED;
+  }
+  row.SerializeTo(KeyManager::GetKeyData(entry) + row_offset_, table_schema_);
+  bool inserted = container_.Insert(entry, INVALID_ROWID, txn);
+  free(entry);
+  return inserted ? DB_SUCCESS : DB_ALREADY_EXIST;
+}
+
+dberr_t ClusteredIndex::RemoveRow(const Row &row, Txn *txn) {
+  GenericKey *key = processor_.InitKey();
+  if (!MakeSearchKey(*row.GetField(key_column_), key)) {
+    free(key);
+    return DB_KEY_NOT_FOUND;
+  }
+  container_.Remove(key, txn);
+  free(key);
+  return DB_SUCCESS;
+}
+
+dberr_t ClusteredIndex::GetRow(const Field &key, Row *row) {
+  auto iter = GetBeginIterator(key);
+  if (iter == GetEndIterator()) {
+    return DB_KEY_NOT_FOUND;
+  }
+  RowView view;
+  GetRowView((*iter).first, &view);
+  Field found = view.GetField(key_column_);
+  if (!found.CheckComparable(key) || found.CompareEquals(key) != CmpBool::kTrue) {
+    return DB_KEY_NOT_FOUND;
+  }
+  view.ToRow(row);
+  return DB_SUCCESS;
+}
+
+IndexIterator ClusteredIndex::GetBeginIterator(const Field &key) {
+  GenericKey *search_key = processor_.InitKey();
+  if (!MakeSearchKey(key, search_key)) {
+    free(search_key);
+    return GetBeginIterator();
+  }
+  auto iter = container_.Begin(search_key);
+  free(search_key);
+  return iter;
+}
+
+void ClusteredIndex::GetRowView(const GenericKey *entry, RowView *view) const {
+  view->Reset(KeyManager::GetKeyData(entry) + row_offset_, table_schema_, INVALID_ROWID);
+}
+
+bool ClusteredIndex::MakeSearchKey(const Field &key, GenericKey *key_buf) const {
+  const Column *column = key_schema_->GetColumn(0);
+  if (key.IsNull() || key.GetTypeId() != column->GetType() ||
+      (column->GetType() == TypeId::kTypeChar && key.GetLength() > column->GetLength())) {
+    return false;
+  }
+  std::vector<Field> fields{Field(key)};
+  processor_.SerializeFromKey(key_buf, Row(fields), key_schema_);
+  return true;
+}
@@ -0,0 +1,112 @@
+#include "index/generic_key.h"
+
+namespace {
+
+constexpr uint32_t SIGN_BIT = 1U << 31;
+
+inline void WriteBigEndian(char *buf, uint32_t value) {
+  for (int i = 3; i >= 0; i--) {
+    buf[i] = static_cast<char>(value & 0xff);
+    value >>= 8;
+  }
+}
+
+inline uint32_t ReadBigEndian(const char *buf) {
+  uint32_t value = 0;
+  for (int i = 0; i < 4; i++) {
+    value = (value << 8) | static_cast<unsigned char>(buf[i]);
+  }
+  return value;
+}
+
+/** @return the raw bits of an int or float field */
+inline uint32_t GetBits(const Field &field) {
+  char buf[sizeof(uint32_t)];
+  field.SerializeTo(buf);
+  return MACH_READ_UINT32(buf);
+}
+
+/** @return the number of bytes of the value of a column in a key, after its null flag */
+inline uint32_t GetValueSize(const Column *column) {
+  return column->GetType() == TypeId::kTypeChar ? column->GetLength() + sizeof(uint32_t) : sizeof(uint32_t);
+}
+
+}  // namespace
+
+void KeyManager::SerializeFromKey(GenericKey *key_buf, const Row &key, Schema *schema) const {
+  ASSERT(key.GetFieldCount() == schema->GetColumnCount(), "field nums not match.");
+  ASSERT(GetEncodedSize(schema) <= static_cast<uint32_t>(key_size_), "Index key size exceed max key size.");
+  // initialize to 0, which is also the encoding of the value of a null
+  memset(key_buf->data, 0, key_size_);
+  char *buf = key_buf->data;
+  for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+    const Column *column = schema->GetColumn(i);
+    const Field *field = key.GetField(i);
+    *buf++ = field->IsNull() ? 0 : 1;
+    if (!field->IsNull()) {
+      switch (column->GetType()) {
+        case TypeId::kTypeInt:
+          WriteBigEndian(buf, GetBits(*field) ^ SIGN_BIT);
+          break;
+        case TypeId::kTypeFloat: {
+          uint32_t bits = GetBits(*field);
+          // -0.0 equals 0.0
+          bits = bits == SIGN_BIT ? 0 : bits;
+          WriteBigEndian(buf, (bits & SIGN_BIT) ? ~bits : bits | SIGN_BIT);
+          break;
+        }
+        default: {
+          uint32_t length = field->GetLength();
+          ASSERT(length <= column->GetLength(), "Index key size exceed max key size.");
+          memcpy(buf, field->GetData(), length);
+          WriteBigEndian(buf + column->GetLength(), length);
+          break;
+        }
+      }
+    }
+    buf += GetValueSize(column);
+  }
+}
+
+void KeyManager::DeserializeToKey(const GenericKey *key_buf, Row &key, Schema *schema) const {
+  key.destroy();
+  auto &fields = key.GetFields();
+  fields.reserve(schema->GetColumnCount());
+  const char *buf = key_buf->data;
+  for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+    const Column *column = schema->GetColumn(i);
+    bool is_null = *buf++ == 0;
+    if (is_null) {
+      fields.push_back(new Field(column->GetType()));
+    } else {
+      switch (column->GetType()) {
+        case TypeId::kTypeInt:
+          fields.push_back(new Field(TypeId::kTypeInt, static_cast<int32_t>(ReadBigEndian(buf) ^ SIGN_BIT)));
+          break;
+        case TypeId::kTypeFloat: {
+          uint32_t bits = ReadBigEndian(buf);
+          bits = (bits & SIGN_BIT) ? bits & ~SIGN_BIT : ~bits;
+          float value;
+          memcpy(&value, &bits, sizeof(float));
+          fields.push_back(new Field(TypeId::kTypeFloat, value));
+          break;
+        }
+        default:
+          fields.push_back(new Field(TypeId::kTypeChar, const_cast<char *>(buf), ReadBigEndian(buf + column->GetLength()),
+                                     true));
+          break;
+      }
+    }
+    buf += GetValueSize(column);
+  }
+  ASSERT(static_cast<uint32_t>(buf - key_buf->data) <= static_cast<uint32_t>(key_size_),
+         "Index key size exceed max key size.");
+}
+
+uint32_t KeyManager::GetEncodedSize(const Schema *key_schema) {
+  uint32_t size = 0;
+  for (auto column : key_schema->GetColumns()) {
+    size += 1 + GetValueSize(column);
+  }
+  return size;
+}
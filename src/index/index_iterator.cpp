@@ -7,7 +7,8 @@ IndexIterator::IndexIterator() = default;
 
 IndexIterator::IndexIterator(page_id_t page_id, BufferPoolManager *bpm, int index)
     : current_page_id(page_id), item_index(index), buffer_pool_manager(bpm) {
-  page = reinterpret_cast<LeafPage *>(buffer_pool_manager->FetchPage(current_page_id)->GetData());
+  frame = buffer_pool_manager->FetchPage(current_page_id);
+  page = reinterpret_cast<LeafPage *>(frame->GetData());
 }
 
 IndexIterator::~IndexIterator() {
@@ -15,23 +16,64 @@ IndexIterator::~IndexIterator() {
     buffer_pool_manager->UnpinPage(current_page_id, false);
 }
 
+IndexIterator::IndexIterator(IndexIterator &&other) noexcept
+    : current_page_id(other.current_page_id),
+      frame(other.frame),
+      page(other.page),
+      item_index(other.item_index),
+      buffer_pool_manager(other.buffer_pool_manager),
+      read_ahead_(other.read_ahead_) {
+  other.current_page_id = INVALID_PAGE_ID;
+  other.frame = nullptr;
+  other.page = nullptr;
+}
+
+IndexIterator &IndexIterator::operator=(IndexIterator &&other) noexcept {
+  if (this != &other) {
+    if (current_page_id != INVALID_PAGE_ID) {
+      buffer_pool_manager->UnpinPage(current_page_id, false);
+    }
+    current_page_id = other.current_page_id;
+    frame = other.frame;
+    page = other.page;
+    item_index = other.item_index;
+    buffer_pool_manager = other.buffer_pool_manager;
+    read_ahead_ = other.read_ahead_;
+    other.current_page_id = INVALID_PAGE_ID;
+    other.frame = nullptr;
+    other.page = nullptr;
+  }
+  return *this;
+}
+
 std::pair<GenericKey *, RowId> IndexIterator::operator*() {
   return page->GetItem(item_index);
 }
 
 IndexIterator &IndexIterator::operator++() {
-  if (item_index + 1 < page->GetSize()) {
+  // only one leaf is latched at a time, so a writer latching two siblings cannot wait for a scan
+  frame->RLatch();
+  int size = page->GetSize();
+  page_id_t next_page_id = page->GetNextPageId();
+  frame->RUnlatch();
+  if (item_index + 1 < size) {
     item_index++; // still this page
   } else { // next page
-    page_id_t next_page_id = page->GetNextPageId();
     buffer_pool_manager->UnpinPage(current_page_id, false);
     current_page_id = next_page_id;
     if (current_page_id != INVALID_PAGE_ID) {
-      page = reinterpret_cast<LeafPage *>(buffer_pool_manager->FetchPage(current_page_id)->GetData());
+      frame = buffer_pool_manager->FetchPage(current_page_id);
+      page = reinterpret_cast<LeafPage *>(frame->GetData());
       item_index = 0;
+      if (read_ahead_.OnPageHop()) {
+        buffer_pool_manager->PrefetchChain(page->GetNextPageId(), READ_AHEAD_PAGES, [](Page *leaf) {
+          return reinterpret_cast<LeafPage *>(leaf->GetData())->GetNextPageId();
+        });
+      }
     }
     else{ // end!!!
       item_index = 0;
+      frame = nullptr;
       page = nullptr;
       *this = IndexIterator();
     }
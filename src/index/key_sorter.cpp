@@ -0,0 +1,128 @@
+#include "index/key_sorter.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "common/macros.h"
+
+KeySorter::KeySorter(const KeyManager &KM, size_t memory_budget)
+    : processor_(KM), entry_size_(KM.GetKeySize() + sizeof(RowId)) {
+  max_buffered_ = std::max<size_t>(1, memory_budget / (2 * entry_size_ + sizeof(const char *)));
+  current_.resize(entry_size_);
+}
+
+KeySorter::~KeySorter() {
+  for (auto &run : runs_) {
+    if (run.file != nullptr) {
+      fclose(run.file);
+    }
+  }
+}
+
+void KeySorter::Add(const GenericKey *key, const RowId &row_id) {
+  if (buffer_.size() == max_buffered_ * entry_size_) {
+    SortBuffer(true);
+  }
+  size_t offset = buffer_.size();
+  buffer_.resize(offset + entry_size_);
+  memcpy(buffer_.data() + offset, key, processor_.GetKeySize());
+  memcpy(buffer_.data() + offset + processor_.GetKeySize(), &row_id, sizeof(RowId));
+  size_++;
+}
+
+void KeySorter::SortBuffer(bool spill) {
+  if (buffer_.empty()) {
+    return;
+  }
+  std::vector<const char *> sorted;
+  sorted.reserve(buffer_.size() / entry_size_);
+  for (size_t offset = 0; offset < buffer_.size(); offset += entry_size_) {
+    sorted.push_back(buffer_.data() + offset);
+  }
+  // stable, so that entries with equal keys keep the order they were added in
+  processor_.WithComparator([&sorted](auto comparator) {
+    std::stable_sort(sorted.begin(), sorted.end(), [comparator](const char *lhs, const char *rhs) {
+      return comparator(reinterpret_cast<const GenericKey *>(lhs), reinterpret_cast<const GenericKey *>(rhs)) < 0;
+    });
+    return 0;
+  });
+  Run run;
+  if (spill) {
+    run.file = tmpfile();
+    ASSERT(run.file != nullptr, "Cannot create a temporary file for a sorted run.");
+    for (auto entry : sorted) {
+      fwrite(entry, entry_size_, 1, run.file);
+    }
+    rewind(run.file);
+    run.entries.resize(entry_size_);
+  } else {
+    run.entries.resize(buffer_.size());
+    char *dest = run.entries.data();
+    for (auto entry : sorted) {
+      memcpy(dest, entry, entry_size_);
+      dest += entry_size_;
+    }
+  }
+  runs_.push_back(std::move(run));
+  buffer_.clear();
+}
+
+void KeySorter::SortRun() { SortBuffer(false); }
+
+void KeySorter::TakeRuns(KeySorter &other) {
+  ASSERT(other.buffer_.empty(), "The entries of the sorter are not sorted.");
+  std::move(other.runs_.begin(), other.runs_.end(), std::back_inserter(runs_));
+  other.runs_.clear();
+  size_ += other.size_;
+  other.size_ = 0;
+}
+
+void KeySorter::Finish() {
+  SortBuffer(false);
+  merge_heap_.clear();
+  auto after = [this](size_t lhs, size_t rhs) { return HeadAfter(lhs, rhs); };
+  for (size_t run = 0; run < runs_.size(); run++) {
+    // a spilled run reads its first entry, an in-memory run starts at it
+    if (runs_[run].file == nullptr ? !runs_[run].entries.empty() : ReadHead(runs_[run])) {
+      merge_heap_.push_back(run);
+      std::push_heap(merge_heap_.begin(), merge_heap_.end(), after);
+    }
+  }
+}
+
+bool KeySorter::Next(GenericKey *&key, RowId &row_id) {
+  if (merge_heap_.empty()) {
+    return false;
+  }
+  auto after = [this](size_t lhs, size_t rhs) { return HeadAfter(lhs, rhs); };
+  std::pop_heap(merge_heap_.begin(), merge_heap_.end(), after);
+  size_t run = merge_heap_.back();
+  memcpy(current_.data(), Head(run), entry_size_);
+  if (ReadHead(runs_[run])) {
+    std::push_heap(merge_heap_.begin(), merge_heap_.end(), after);
+  } else {
+    merge_heap_.pop_back();
+  }
+  key = reinterpret_cast<GenericKey *>(current_.data());
+  memcpy(&row_id, current_.data() + processor_.GetKeySize(), sizeof(RowId));
+  return true;
+}
+
+size_t KeySorter::GetSpilledRuns() const {
+  return std::count_if(runs_.begin(), runs_.end(), [](const Run &run) { return run.file != nullptr; });
+}
+
+bool KeySorter::ReadHead(Run &run) {
+  if (run.file == nullptr) {
+    run.offset += entry_size_;
+    return run.offset < run.entries.size();
+  }
+  return fread(run.entries.data(), entry_size_, 1, run.file) == 1;
+}
+
+bool KeySorter::HeadAfter(size_t lhs, size_t rhs) const {
+  int comp_res = processor_.CompareKeys(reinterpret_cast<const GenericKey *>(Head(lhs)),
+                                        reinterpret_cast<const GenericKey *>(Head(rhs)));
+  // equal keys come out in the order of their runs
+  return comp_res > 0 || (comp_res == 0 && lhs > rhs);
+}
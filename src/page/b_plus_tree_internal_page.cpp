@@ -59,7 +59,7 @@ void *InternalPage::PairPtrAt(int index) {
 }
 
 void InternalPage::PairCopy(void *dest, void *src, int pair_num) {
-  memcpy(dest, src, pair_num * (GetKeySize() + sizeof(page_id_t)));
+  memmove(dest, src, pair_num * (GetKeySize() + sizeof(page_id_t)));
 }
 /*****************************************************************************
  * LOOKUP
@@ -72,23 +72,24 @@ void InternalPage::PairCopy(void *dest, void *src, int pair_num) {
  */
 page_id_t InternalPage::Lookup(const GenericKey *key, const KeyManager &KM) {
   if (GetSize() == 1) return ValueAt(0);
-  int l = 1, r = GetSize() - 1, ans = 0;
-  while (l <= r){ // search from the second one
-    int mid = (l + r) >> 1;
-    int comp_res = KM.CompareKeys(key, KeyAt(mid));
-    if (comp_res == 0){ // equal then return
-      return ValueAt(mid);
+  // the search is compiled for each key width, see KeyManager::WithComparator
+  int index = KM.WithComparator([this, key](auto comparator) {
+    int l = 1, r = GetSize() - 1, ans = 0;
+    while (l <= r) {  // search from the second one
+      int mid = (l + r) >> 1;
+      int comp_res = comparator(key, KeyAt(mid));
+      if (comp_res == 0) {  // equal then return
+        return mid;
+      } else if (comp_res > 0) {
+        l = mid + 1;
+        ans = mid;  // ans >= mid
+      } else {
+        r = mid - 1;
+      }
     }
-    else if (comp_res > 0){
-      l = mid + 1;
-      ans = mid; // ans >= mid
-    }
-    else{
-      r = mid - 1;
-    }
-  }
-  // assert (1 == 0); // test
-  return ValueAt(ans);
+    return ans;
+  });
+  return ValueAt(index);
 }
 
 /*****************************************************************************
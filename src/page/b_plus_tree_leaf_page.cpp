@@ -54,21 +54,22 @@ void LeafPage::SetNextPageId(page_id_t next_page_id) {
  * 二分查找
  */
 int LeafPage::KeyIndex(const GenericKey *key, const KeyManager &KM) {
-  int l = 0, r = GetSize();
-  while (l < r){
-    int mid = (l + r) >> 1;
-    int comp_res = KM.CompareKeys(KeyAt(mid), key);
-    if (comp_res == 0){
-      return mid;
+  // the search is compiled for each key width, see KeyManager::WithComparator
+  return KM.WithComparator([this, key](auto comparator) {
+    int l = 0, r = GetSize();
+    while (l < r) {
+      int mid = (l + r) >> 1;
+      int comp_res = comparator(KeyAt(mid), key);
+      if (comp_res == 0) {
+        return mid;
+      } else if (comp_res < 0) {
+        l = mid + 1;
+      } else {
+        r = mid;
+      }
     }
-    else if (comp_res < 0){
-      l = mid + 1;
-    }
-    else{
-      r = mid;
-    }
-  }
-  return l;
+    return l;
+  });
 }
 
 /*
@@ -96,7 +97,7 @@ void *LeafPage::PairPtrAt(int index) {
 }
 
 void LeafPage::PairCopy(void *dest, void *src, int pair_num) {
-  memcpy(dest, src, pair_num * (GetKeySize() + sizeof(RowId)));
+  memmove(dest, src, pair_num * (GetKeySize() + sizeof(RowId)));
 }
 /*
  * Helper method to find and return the key & value pair associated with input
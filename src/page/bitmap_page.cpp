@@ -15,14 +15,8 @@ bool BitmapPage<PageSize>::AllocatePage(uint32_t &page_offset) {
   uint8_t bit_index = page_offset % 8;
   bytes[byte_index] |= (1 << bit_index);
   page_allocated_++;
-  for(uint32_t i = 0; i < this->GetMaxSupportedSize(); i++) {
-    byte_index = i / 8;
-    bit_index = i % 8;
-    if(IsPageFreeLow(byte_index, bit_index)) {
-      next_free_page_ = i;
-      break;
-    }
-  }
+  // every page before next_free_page_ is allocated, so the next free page can only be further on
+  next_free_page_ = FindFreePage(page_offset / BITS_PER_WORD);
   return true;
 }
 
@@ -61,6 +55,26 @@ bool BitmapPage<PageSize>::IsPageFree(uint32_t page_offset) const {
   return IsPageFreeLow(byte_index, bit_index);
 }
 
+template <size_t PageSize>
+uint32_t BitmapPage<PageSize>::FindFreePage(uint32_t word_index) const {
+  for (; word_index < NUM_WORDS; word_index++) {
+    uint64_t word = GetWord(word_index);
+    if (word != ~0ULL) {
+      return word_index * BITS_PER_WORD + __builtin_ctzll(~word);
+    }
+  }
+  return GetMaxSupportedSize();
+}
+
+template <size_t PageSize>
+uint32_t BitmapPage<PageSize>::CountAllocatedPages() const {
+  uint32_t count = 0;
+  for (uint32_t word_index = 0; word_index < NUM_WORDS; word_index++) {
+    count += __builtin_popcountll(GetWord(word_index));
+  }
+  return count;
+}
+
 template <size_t PageSize>
 bool BitmapPage<PageSize>::IsPageFreeLow(uint32_t byte_index, uint8_t bit_index) const {
   return (bytes[byte_index] & (1 << bit_index)) == 0;
@@ -0,0 +1,47 @@
+#include "page/free_space_map_page.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/macros.h"
+
+void FreeSpaceMapPage::Init(page_id_t next_page_id) {
+  next_page_id_ = next_page_id;
+  count_ = 0;
+  memset(tree_, 0, sizeof(tree_));
+}
+
+uint32_t FreeSpaceMapPage::Append(page_id_t page_id, uint32_t free_space) {
+  ASSERT(!IsFull(), "Free space map page is full.");
+  uint32_t slot = count_++;
+  page_ids_[slot] = page_id;
+  Update(slot, free_space);
+  return slot;
+}
+
+void FreeSpaceMapPage::Update(uint32_t slot, uint32_t free_space) {
+  ASSERT(slot < count_, "Invalid free space map slot.");
+  uint32_t node = MAX_ENTRIES + slot;
+  tree_[node] = ToCategory(free_space);
+  // stop as soon as an ancestor does not change
+  for (node /= 2; node >= 1; node /= 2) {
+    uint8_t max_category = std::max(tree_[2 * node], tree_[2 * node + 1]);
+    if (tree_[node] == max_category) {
+      break;
+    }
+    tree_[node] = max_category;
+  }
+}
+
+int FreeSpaceMapPage::Search(uint32_t free_space) const {
+  uint32_t category = ToRequiredCategory(free_space);
+  if (count_ == 0 || tree_[1] < category) {
+    return -1;
+  }
+  // go down to the leftmost leaf with enough room, so that inserts fill the older pages first
+  uint32_t node = 1;
+  while (node < MAX_ENTRIES) {
+    node = tree_[2 * node] >= category ? 2 * node : 2 * node + 1;
+  }
+  return node - MAX_ENTRIES;
+}
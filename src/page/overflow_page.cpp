@@ -0,0 +1,16 @@
+#include "page/overflow_page.h"
+
+#include <cstring>
+
+#include "common/macros.h"
+
+void OverflowPage::Init(page_id_t next_page_id) {
+  next_page_id_ = next_page_id;
+  data_size_ = 0;
+}
+
+void OverflowPage::SetData(const char *data, uint32_t size) {
+  ASSERT(size <= MAX_DATA_SIZE, "Data does not fit in an overflow page.");
+  memcpy(data_, data, size);
+  data_size_ = size;
+}
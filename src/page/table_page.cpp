@@ -13,9 +13,6 @@ void TablePage::Init(page_id_t page_id, page_id_t prev_id, LogManager *log_mgr,
 bool TablePage::InsertTuple(Row &row, Schema *schema, Txn *txn, LockManager *lock_manager, LogManager *log_manager) {
   uint32_t serialized_size = row.GetSerializedSize(schema);
   ASSERT(serialized_size > 0, "Can not have empty row.");
-  if (GetFreeSpaceRemaining() < serialized_size + SIZE_TUPLE) {
-    return false;
-  }
   // Try to find a free slot to reuse.
   uint32_t i;
   for (i = 0; i < GetTupleCount(); i++) {
@@ -25,7 +22,8 @@ bool TablePage::InsertTuple(Row &row, Schema *schema, Txn *txn, LockManager *loc
       break;
     }
   }
-  if (i == GetTupleCount() && GetFreeSpaceRemaining() < serialized_size + SIZE_TUPLE) {
+  // A reused slot takes no room of its own.
+  if (GetFreeSpaceRemaining() < serialized_size + (i == GetTupleCount() ? SIZE_TUPLE : 0)) {
     return false;
   }
   // Otherwise we claim available free space..
@@ -130,6 +128,39 @@ void TablePage::ApplyDelete(const RowId &rid, Txn *txn, LogManager *log_manager)
       SetTupleOffsetAtSlot(i, tuple_offset_i + tuple_size);
     }
   }
+  TrimSlots();
+}
+
+uint32_t TablePage::Compact([[maybe_unused]] Txn *txn, [[maybe_unused]] LogManager *log_manager) {
+  // Pack the live tuples against the end of the page in slot order, so that the slots keep their numbers.
+  char buffer[PAGE_SIZE];
+  uint32_t free_space_pointer = PAGE_SIZE;
+  uint32_t live_count = 0;
+  for (uint32_t i = 0; i < GetTupleCount(); i++) {
+    uint32_t tuple_size = GetTupleSize(i);
+    // A tuple marked as deleted is dropped and its slot becomes free.
+    if (IsDeleted(tuple_size)) {
+      SetTupleSize(i, 0);
+      SetTupleOffsetAtSlot(i, 0);
+      continue;
+    }
+    free_space_pointer -= tuple_size;
+    memcpy(buffer + free_space_pointer, GetData() + GetTupleOffsetAtSlot(i), tuple_size);
+    SetTupleOffsetAtSlot(i, free_space_pointer);
+    live_count++;
+  }
+  memcpy(GetData() + free_space_pointer, buffer + free_space_pointer, PAGE_SIZE - free_space_pointer);
+  SetFreeSpacePointer(free_space_pointer);
+  TrimSlots();
+  return live_count;
+}
+
+void TablePage::TrimSlots() {
+  uint32_t tuple_count = GetTupleCount();
+  while (tuple_count > 0 && GetTupleSize(tuple_count - 1) == 0) {
+    tuple_count--;
+  }
+  SetTupleCount(tuple_count);
 }
 
 void TablePage::RollbackDelete(const RowId &rid, Txn *txn, LogManager *log_manager) {
@@ -164,6 +195,16 @@ bool TablePage::GetTuple(Row *row, Schema *schema, Txn *txn, LockManager *lock_m
   return true;
 }
 
+bool TablePage::GetTupleView(const RowId &rid, Schema *schema, RowView *view, bool include_deleted) {
+  uint32_t slot_num = rid.GetSlotNum();
+  if (slot_num >= GetTupleCount() || GetTupleSize(slot_num) == 0 ||
+      (!include_deleted && IsDeleted(GetTupleSize(slot_num)))) {
+    return false;
+  }
+  view->Reset(GetData() + GetTupleOffsetAtSlot(slot_num), schema, rid);
+  return true;
+}
+
 bool TablePage::GetFirstTupleRid(RowId *first_rid) {
   // Find and return the first valid tuple.
   for (uint32_t i = 0; i < GetTupleCount(); i++) {
@@ -0,0 +1,98 @@
+#include "page/zone_map_page.h"
+
+#include <cstring>
+
+#include "common/macros.h"
+
+ZoneMapLayout::ZoneMapLayout(const Schema *schema) {
+  zone_index_.assign(schema->GetColumnCount(), -1);
+  for (uint32_t i = 0; i < schema->GetColumnCount() && columns_.size() < MAX_COLUMNS; i++) {
+    TypeId type = schema->GetColumn(i)->GetType();
+    if (type == TypeId::kTypeInt || type == TypeId::kTypeFloat) {
+      zone_index_[i] = static_cast<int>(columns_.size());
+      columns_.push_back(i);
+      types_.push_back(type);
+    }
+  }
+}
+
+bool ZoneMapEntry::HasValues(uint32_t column) const {
+  int zone_index = layout_->GetZoneIndex(column);
+  ASSERT(zone_index >= 0, "Column has no zone map.");
+  return MACH_READ_UINT32(data_) & (1u << zone_index);
+}
+
+Field ZoneMapEntry::ReadBound(uint32_t column, bool is_max) const {
+  ASSERT(HasValues(column), "Zone map has no value.");
+  int zone_index = layout_->GetZoneIndex(column);
+  const char *bound = GetBound(zone_index, is_max);
+  if (layout_->GetType(zone_index) == TypeId::kTypeInt) {
+    return Field(TypeId::kTypeInt, MACH_READ_INT32(bound));
+  }
+  return Field(TypeId::kTypeFloat, MACH_READ_FROM(float, bound));
+}
+
+Field ZoneMapEntry::GetMin(uint32_t column) const { return ReadBound(column, false); }
+
+Field ZoneMapEntry::GetMax(uint32_t column) const { return ReadBound(column, true); }
+
+void ZoneMapEntry::Clear() { memset(data_, 0, layout_->GetEntrySize()); }
+
+void ZoneMapEntry::WidenZone(uint32_t zone_index, const char *min, const char *max) {
+  uint32_t mask = MACH_READ_UINT32(data_);
+  char *cur_min = GetBound(zone_index, false);
+  char *cur_max = GetBound(zone_index, true);
+  if (!(mask & (1u << zone_index))) {
+    memcpy(cur_min, min, sizeof(uint32_t));
+    memcpy(cur_max, max, sizeof(uint32_t));
+    MACH_WRITE_UINT32(data_, mask | (1u << zone_index));
+    return;
+  }
+  bool below, above;
+  if (layout_->GetType(zone_index) == TypeId::kTypeInt) {
+    below = MACH_READ_INT32(min) < MACH_READ_INT32(cur_min);
+    above = MACH_READ_INT32(max) > MACH_READ_INT32(cur_max);
+  } else {
+    below = MACH_READ_FROM(float, min) < MACH_READ_FROM(float, cur_min);
+    above = MACH_READ_FROM(float, max) > MACH_READ_FROM(float, cur_max);
+  }
+  if (below) {
+    memcpy(cur_min, min, sizeof(uint32_t));
+  }
+  if (above) {
+    memcpy(cur_max, max, sizeof(uint32_t));
+  }
+}
+
+void ZoneMapEntry::Widen(const Row &row) {
+  char value[sizeof(uint32_t)];
+  for (uint32_t i = 0; i < layout_->GetColumnCount(); i++) {
+    Field *field = row.GetField(layout_->GetTableColumn(i));
+    if (field->IsNull()) {
+      continue;
+    }
+    field->SerializeTo(value);
+    WidenZone(i, value, value);
+  }
+}
+
+void ZoneMapEntry::Widen(const ZoneMapEntry &other) {
+  uint32_t mask = MACH_READ_UINT32(other.data_);
+  for (uint32_t i = 0; i < layout_->GetColumnCount(); i++) {
+    if (mask & (1u << i)) {
+      WidenZone(i, other.GetBound(i, false), other.GetBound(i, true));
+    }
+  }
+}
+
+void ZoneMapPage::Init(page_id_t next_page_id) {
+  next_page_id_ = next_page_id;
+  count_ = 0;
+}
+
+uint32_t ZoneMapPage::Append(const ZoneMapLayout &layout) {
+  ASSERT(!IsFull(layout), "Zone map page is full.");
+  uint32_t slot = count_++;
+  GetEntry(slot, layout).Clear();
+  return slot;
+}
@@ -15,7 +15,8 @@ uint32_t Row::SerializeTo(char *buf, Schema *schema) const {
   cnt += sizeof(uint32_t);
   // write null bitmap
   uint32_t size = (fields_num + 7) / 8;
-  char *bitmap = new char[size];
+  // zeroed, so that equal rows serialize to equal bytes
+  char *bitmap = new char[size]();
   for(uint32_t i = 0; i < fields_num; i++) {
     if(fields_[i]->IsNull()) {
       bitmap[i / 8] &= ~(1 << (7 - i % 8));
@@ -25,6 +26,7 @@ uint32_t Row::SerializeTo(char *buf, Schema *schema) const {
     }
   }
   memcpy(buf + cnt, bitmap, size);
+  delete[] bitmap;
   cnt += size;
   // write fields
   for(uint32_t i = 0; i < fields_num; i++) {
@@ -58,6 +60,7 @@ uint32_t Row::DeserializeFrom(char *buf, Schema *schema) {
 
     fields_.push_back(field);
   }
+  delete[] bitmap;
   return cnt;
 }
 
@@ -75,7 +78,7 @@ uint32_t Row::GetSerializedSize(Schema *schema) const {
   return size;
 }
 
-void Row::GetKeyFromRow(const Schema *schema, const Schema *key_schema, Row &key_row) {
+void Row::GetKeyFromRow(const Schema *schema, const Schema *key_schema, Row &key_row) const {
   auto columns = key_schema->GetColumns();
   std::vector<Field> fields;
   uint32_t idx;
@@ -0,0 +1,115 @@
+#include "record/row_view.h"
+
+#include <memory>
+
+void RowView::Reset(const char *data, const Schema *schema, RowId rid) {
+  data_ = data;
+  schema_ = schema;
+  rid_ = rid;
+  field_count_ = MACH_READ_UINT32(data);
+  ASSERT(field_count_ == schema->GetColumnCount(), "Fields size do not match schema's column size.");
+  offsets_.clear();
+  // the first field follows the field count and the null bitmap
+  offsets_.push_back(sizeof(uint32_t) + (field_count_ + 7) / 8);
+}
+
+bool RowView::IsNull(uint32_t idx) const {
+  ASSERT(idx < field_count_, "Failed to access field");
+  const char *bitmap = data_ + sizeof(uint32_t);
+  return !(bitmap[idx / 8] & (1 << (7 - idx % 8)));
+}
+
+bool RowView::IsExternal(uint32_t idx) const {
+  return schema_->GetColumn(idx)->GetType() == TypeId::kTypeChar && !IsNull(idx) &&
+         (MACH_READ_UINT32(data_ + GetFieldOffset(idx)) & Field::EXTERNAL_FLAG);
+}
+
+ExternalValue RowView::GetExternalValue(uint32_t idx) const {
+  ASSERT(IsExternal(idx), "Field is not stored out of line.");
+  ExternalValue value;
+  memcpy(&value, data_ + GetFieldOffset(idx) + sizeof(uint32_t), sizeof(ExternalValue));
+  return value;
+}
+
+uint32_t RowView::GetFieldOffset(uint32_t idx) const {
+  while (offsets_.size() <= idx) {
+    uint32_t i = offsets_.size() - 1;
+    uint32_t offset = offsets_.back();
+    if (!IsNull(i)) {
+      TypeId type = schema_->GetColumn(i)->GetType();
+      offset += type == TypeId::kTypeChar ? sizeof(uint32_t) + (MACH_READ_UINT32(data_ + offset) & ~Field::EXTERNAL_FLAG)
+                                          : Type::GetTypeSize(type);
+    }
+    offsets_.push_back(offset);
+  }
+  return offsets_[idx];
+}
+
+Field RowView::GetField(uint32_t idx) const {
+  TypeId type = schema_->GetColumn(idx)->GetType();
+  if (IsNull(idx)) {
+    return Field(type);
+  }
+  const char *value = data_ + GetFieldOffset(idx);
+  switch (type) {
+    case TypeId::kTypeInt:
+      return Field(type, MACH_READ_FROM(int32_t, value));
+    case TypeId::kTypeFloat:
+      return Field(type, MACH_READ_FROM(float, value));
+    default:
+      if (MACH_READ_UINT32(value) & Field::EXTERNAL_FLAG) {
+        std::unique_ptr<Field> field(CopyExternalField(idx));
+        return Field(*field);
+      }
+      return Field(type, const_cast<char *>(value) + sizeof(uint32_t), MACH_READ_UINT32(value), false);
+  }
+}
+
+Field *RowView::CopyField(uint32_t idx) const {
+  TypeId type = schema_->GetColumn(idx)->GetType();
+  if (IsNull(idx)) {
+    return new Field(type);
+  }
+  const char *value = data_ + GetFieldOffset(idx);
+  switch (type) {
+    case TypeId::kTypeInt:
+      return new Field(type, MACH_READ_FROM(int32_t, value));
+    case TypeId::kTypeFloat:
+      return new Field(type, MACH_READ_FROM(float, value));
+    default:
+      if (MACH_READ_UINT32(value) & Field::EXTERNAL_FLAG) {
+        return CopyExternalField(idx);
+      }
+      return new Field(type, const_cast<char *>(value) + sizeof(uint32_t), MACH_READ_UINT32(value), true);
+  }
+}
+
+Field *RowView::CopyExternalField(uint32_t idx) const {
+  ExternalValue value = GetExternalValue(idx);
+  if (reader_ == nullptr) {
+    return new Field(TypeId::kTypeChar, value);
+  }
+  std::vector<char> buf(value.length_);
+  reader_->ReadExternalValue(value, buf.data());
+  return new Field(TypeId::kTypeChar, buf.data(), value.length_, true);
+}
+
+void RowView::ToRow(Row *row) const {
+  row->destroy();
+  row->SetRowId(rid_);
+  auto &fields = row->GetFields();
+  fields.reserve(field_count_);
+  for (uint32_t i = 0; i < field_count_; i++) {
+    fields.push_back(CopyField(i));
+  }
+}
+
+void RowView::ToRow(Row *row, const Schema *output_schema) const {
+  row->destroy();
+  row->SetRowId(rid_);
+  auto &fields = row->GetFields();
+  fields.reserve(output_schema->GetColumnCount());
+  for (const auto column : output_schema->GetColumns()) {
+    fields.push_back(CopyField(column->GetTableInd()));
+  }
+}
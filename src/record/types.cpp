@@ -228,7 +228,8 @@ CmpBool TypeFloat::CompareGreaterThanEquals(const Field &left, const Field &righ
 uint32_t TypeChar::SerializeTo(const Field &field, char *buf) const {
   if (!field.IsNull()) {
     uint32_t len = GetLength(field);
-    memcpy(buf, &len, sizeof(uint32_t));
+    uint32_t header = field.IsExternal() ? len | Field::EXTERNAL_FLAG : len;
+    memcpy(buf, &header, sizeof(uint32_t));
     memcpy(buf + sizeof(uint32_t), field.value_.chars_, len);
     return len + sizeof(uint32_t);
   }
@@ -240,8 +241,10 @@ uint32_t TypeChar::DeserializeFrom(char *storage, Field **field, bool is_null) c
     *field = new Field(TypeId::kTypeChar);
     return 0;
   }
-  uint32_t len = MACH_READ_UINT32(storage);
+  uint32_t header = MACH_READ_UINT32(storage);
+  uint32_t len = header & ~Field::EXTERNAL_FLAG;
   *field = new Field(TypeId::kTypeChar, storage + sizeof(uint32_t), len, true);
+  (*field)->is_external_ = (header & Field::EXTERNAL_FLAG) != 0;
   return len + sizeof(uint32_t);
 }
 
@@ -1,50 +1,137 @@
 #include "storage/disk_manager.h"
 
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
+#include <cerrno>
 #include <filesystem>
 #include <stdexcept>
 
 #include "glog/logging.h"
 #include "page/bitmap_page.h"
 
-DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
+DiskManager::DiskManager(const std::string &db_file, bool use_io_uring, bool direct_io)
+    : DiskManager(std::vector<std::string>{db_file}, use_io_uring, direct_io) {}
+
+DiskManager::DiskManager(const std::vector<std::string> &data_files, bool use_io_uring, bool direct_io) {
+  ASSERT(!data_files.empty() && data_files.size() <= MAX_DATA_FILES, "Invalid number of data files.");
   std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    std::filesystem::path p = db_file;
-    if (p.has_parent_path()) std::filesystem::create_directories(p.parent_path());
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-    db_io_.close();
-    // reopen with original mode
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-    if (!db_io_.is_open()) {
-      throw std::exception();
+  for (const auto &file_name : data_files) {
+    data_files_.emplace_back(OpenDataFile(file_name, direct_io));
+  }
+  // the layout of the pages depends on the number of files, a tablespace cannot be reopened with another one
+  auto *first_meta = reinterpret_cast<DiskFileMetaPage *>(data_files_[0]->meta_data_);
+  if (first_meta->GetDataFileNums() == 0) {
+    first_meta->SetDataFileNums(data_files_.size());
+  } else if (first_meta->GetDataFileNums() != data_files_.size()) {
+    LOG(ERROR) << data_files[0] << " belongs to a tablespace of " << first_meta->GetDataFileNums() << " data files, "
+               << data_files_.size() << " given";
+    for (auto &file : data_files_) {
+      close(file->fd_);
+    }
+    throw std::exception();
+  }
+  max_extents_ = MAX_EXTENTS_PER_FILE * data_files_.size();
+  // every extent has free pages, except the full ones
+  free_extents_.assign((max_extents_ + 63) / 64, 0);
+  for (uint32_t extent_id = 0; extent_id < max_extents_; extent_id++) {
+    SetExtentFree(extent_id, GetExtentMeta(extent_id)->GetExtentUsedPage(GetLocalExtentId(extent_id)) < BITMAP_SIZE);
+  }
+  if (use_io_uring) {
+    io_uring_ = IOUring::Create(IO_URING_QUEUE_DEPTH);
+    if (io_uring_ == nullptr) {
+      LOG(WARNING) << "io_uring is not available, asynchronous page I/O falls back to synchronous I/O";
+    }
+  }
+}
+
+std::unique_ptr<DiskManager::DataFile> DiskManager::OpenDataFile(const std::string &file_name, bool direct_io) {
+  auto file = std::make_unique<DataFile>();
+  file->file_name_ = file_name;
+  // create the directory if it does not exist
+  std::filesystem::path p = file_name;
+  if (p.has_parent_path()) std::filesystem::create_directories(p.parent_path());
+  if (direct_io) {
+    file->fd_ = open(file_name.c_str(), O_RDWR | O_CREAT | O_DIRECT, 0644);
+    if (file->fd_ >= 0) {
+      direct_io_ = true;
+    } else {
+      LOG(WARNING) << "O_DIRECT is not supported for " << file_name << ", falling back to buffered I/O";
+    }
+  }
+  if (file->fd_ < 0) {
+    file->fd_ = open(file_name.c_str(), O_RDWR | O_CREAT, 0644);
+  }
+  if (file->fd_ < 0) {
+    for (auto &opened : data_files_) {
+      close(opened->fd_);
+    }
+    throw std::exception();
+  }
+  file->file_size_ = GetFileSize(file->fd_);
+  ReadPhysicalPage(file.get(), META_PAGE_ID, file->meta_data_);
+  return file;
+}
+
+void DiskManager::Sync() {
+  for (auto &file : data_files_) {
+    if (fdatasync(file->fd_) != 0) {
+      LOG(ERROR) << "I/O error while syncing " << file->file_name_ << ": " << strerror(errno);
     }
   }
-  ReadPhysicalPage(META_PAGE_ID, meta_data_);
 }
 
 void DiskManager::Close() {
   std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
-  WritePhysicalPage(META_PAGE_ID, meta_data_);
   if (!closed) {
-    db_io_.close();
+    // waits for the I/O in flight
+    io_uring_.reset();
+    FlushMetadata();
+    Sync();
+    for (auto &file : data_files_) {
+      close(file->fd_);
+      file->fd_ = -1;
+    }
     closed = true;
   }
 }
 
 void DiskManager::ReadPage(page_id_t logical_page_id, char *page_data) {
   ASSERT(logical_page_id >= 0, "Invalid page id.");
-  ReadPhysicalPage(MapPageId(logical_page_id), page_data);
+  ReadPhysicalPage(data_files_[GetDataFileId(logical_page_id)].get(), MapPageId(logical_page_id), page_data);
 }
 
 void DiskManager::WritePage(page_id_t logical_page_id, const char *page_data) {
   ASSERT(logical_page_id >= 0, "Invalid page id.");
-  WritePhysicalPage(MapPageId(logical_page_id), page_data);
+  WritePhysicalPage(data_files_[GetDataFileId(logical_page_id)].get(), MapPageId(logical_page_id), page_data);
+}
+
+IOHandle DiskManager::ReadPageAsync(page_id_t logical_page_id, char *page_data) {
+  ASSERT(logical_page_id >= 0, "Invalid page id.");
+  DataFile *file = data_files_[GetDataFileId(logical_page_id)].get();
+  off_t offset = static_cast<off_t>(MapPageId(logical_page_id)) * PAGE_SIZE;
+  if (io_uring_ == nullptr || offset >= file->file_size_ || NeedsBounceBuffer(page_data)) {
+    ReadPhysicalPage(file, MapPageId(logical_page_id), page_data);
+    return IOHandle(PAGE_SIZE);
+  }
+  return io_uring_->Read(file->fd_, page_data, PAGE_SIZE, offset);
+}
+
+/**
+ * The file size is extended when the write is queued, a read of the page issued before the write completes is a
+ * race of the caller anyway.
+ */
+IOHandle DiskManager::WritePageAsync(page_id_t logical_page_id, const char *page_data) {
+  ASSERT(logical_page_id >= 0, "Invalid page id.");
+  DataFile *file = data_files_[GetDataFileId(logical_page_id)].get();
+  if (io_uring_ == nullptr || NeedsBounceBuffer(page_data)) {
+    WritePhysicalPage(file, MapPageId(logical_page_id), page_data);
+    return IOHandle(PAGE_SIZE);
+  }
+  off_t offset = static_cast<off_t>(MapPageId(logical_page_id)) * PAGE_SIZE;
+  ExtendFileSize(file, offset + PAGE_SIZE);
+  return io_uring_->Write(file->fd_, page_data, PAGE_SIZE, offset);
 }
 
 /**
@@ -52,32 +139,32 @@ void DiskManager::WritePage(page_id_t logical_page_id, const char *page_data) {
  */
 page_id_t DiskManager::AllocatePage() {
   //ASSERT(false, "Not implemented yet.");
-  //得到 meta_page
-  DiskFileMetaPage* meta_page = reinterpret_cast<DiskFileMetaPage *>(meta_data_); //meta_data_成员实际上是MetaPage在内存中的缓存
-  if(meta_page->GetAllocatedPages() >= MAX_VALID_PAGE_ID) return INVALID_PAGE_ID;
-
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
   //找 bitmap
-  uint32_t extenti = 0;
-  for(extenti = 0; extenti < meta_page->GetExtentNums(); extenti++) {
-    if(meta_page->extent_used_page_[extenti] < BITMAP_SIZE) {
-      break;
-    }
+  uint32_t extenti = FindFreeExtent();
+  if (extenti >= max_extents_) {
+    return INVALID_PAGE_ID;
   }
 
-  uint32_t physical_page_id = extenti * (BITMAP_SIZE + 1) + 1;
-  char data[PAGE_SIZE];
-  ReadPhysicalPage(physical_page_id, data);
-
   //找 bitmap中的空闲页
-  BitmapPage<PAGE_SIZE>* bitmap = reinterpret_cast<BitmapPage<PAGE_SIZE>*>(data);
+  BitmapPage<PAGE_SIZE>* bitmap = GetExtentBitmap(extenti);
   uint32_t page_offset = 0;
-  bitmap->AllocatePage(page_offset);
-  WritePhysicalPage(physical_page_id, data);
+  if (!bitmap->AllocatePage(page_offset)) {
+    LOG(ERROR) << "Bitmap of extent " << extenti << " is full but the meta page says otherwise";
+    SetExtentFree(extenti, false);
+    return INVALID_PAGE_ID;
+  }
+  bitmaps_[extenti]->dirty_ = true;
+  //meta_page 记录的是 extent 所在数据文件的信息
+  DiskFileMetaPage* meta_page = GetExtentMeta(extenti);
+  uint32_t local_extent = GetLocalExtentId(extenti);
   meta_page->num_allocated_pages_++;
-  meta_page->extent_used_page_[extenti]++;
-  meta_page->num_extents_ = std::max(meta_page->num_extents_, extenti + 1);
+  meta_page->extent_used_page_[local_extent]++;
+  meta_page->num_extents_ = std::max(meta_page->num_extents_, local_extent + 1);
+  if (meta_page->extent_used_page_[local_extent] >= BITMAP_SIZE) {
+    SetExtentFree(extenti, false);
+  }
   return extenti * BITMAP_SIZE + page_offset;
-
 }
 
 /**
@@ -85,77 +172,161 @@ page_id_t DiskManager::AllocatePage() {
  */
 void DiskManager::DeAllocatePage(page_id_t logical_page_id) {
   //ASSERT(false, "Not implemented yet.");
-  DiskFileMetaPage* meta_page = reinterpret_cast<DiskFileMetaPage*>(meta_data_);
-
-  uint32_t physical_page_id;
-  physical_page_id = 1 + (logical_page_id / BITMAP_SIZE) * (BITMAP_SIZE + 1);;
-  char data[PAGE_SIZE];
-  ReadPhysicalPage(physical_page_id, data);
-  BitmapPage<PAGE_SIZE>* bitmap = reinterpret_cast<BitmapPage<PAGE_SIZE>*>(data);
-  bitmap->DeAllocatePage(physical_page_id % BITMAP_SIZE);
-  WritePhysicalPage(physical_page_id, data);
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  uint32_t extent_id = logical_page_id / BITMAP_SIZE;
+  DiskFileMetaPage* meta_page = GetExtentMeta(extent_id);
+  uint32_t local_extent = GetLocalExtentId(extent_id);
+  if (local_extent >= meta_page->GetExtentNums()) {
+    return;
+  }
+  BitmapPage<PAGE_SIZE>* bitmap = GetExtentBitmap(extent_id);
+  if (!bitmap->DeAllocatePage(logical_page_id % BITMAP_SIZE)) {
+    return;
+  }
+  bitmaps_[extent_id]->dirty_ = true;
   meta_page->num_allocated_pages_--;
-  meta_page->extent_used_page_[physical_page_id / BITMAP_SIZE]--;
-  
+  meta_page->extent_used_page_[local_extent]--;
+  SetExtentFree(extent_id, true);
 }
 
 /**
  * TODO: Student Implement
  */
-bool DiskManager::IsPageFree(page_id_t logical_page_id) {  
-  char data[PAGE_SIZE];
-  uint32_t physical_page_id = 1 + (logical_page_id / BITMAP_SIZE) * (BITMAP_SIZE + 1);
-  ReadPhysicalPage(physical_page_id, data);
-  BitmapPage<PAGE_SIZE>* bitmap = reinterpret_cast<BitmapPage<PAGE_SIZE>*>(data);
-  return bitmap->IsPageFree(physical_page_id % BITMAP_SIZE);
-} 
+bool DiskManager::IsPageFree(page_id_t logical_page_id) {
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  uint32_t extent_id = logical_page_id / BITMAP_SIZE;
+  // extents past the last one of the file have never been touched
+  if (GetLocalExtentId(extent_id) >= GetExtentMeta(extent_id)->GetExtentNums()) {
+    return true;
+  }
+  return GetExtentBitmap(extent_id)->IsPageFree(logical_page_id % BITMAP_SIZE);
+}
+
+void DiskManager::FlushMetadata() {
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  for (size_t extent_id = 0; extent_id < bitmaps_.size(); extent_id++) {
+    if (bitmaps_[extent_id] != nullptr && bitmaps_[extent_id]->dirty_) {
+      WritePhysicalPage(GetExtentFile(extent_id), GetBitmapPhysicalPageId(extent_id), bitmaps_[extent_id]->data_);
+      bitmaps_[extent_id]->dirty_ = false;
+    }
+  }
+  for (auto &file : data_files_) {
+    WritePhysicalPage(file.get(), META_PAGE_ID, file->meta_data_);
+  }
+}
+
+BitmapPage<PAGE_SIZE> *DiskManager::GetExtentBitmap(uint32_t extent_id) {
+  if (bitmaps_.size() <= extent_id) {
+    bitmaps_.resize(extent_id + 1);
+  }
+  if (bitmaps_[extent_id] == nullptr) {
+    bitmaps_[extent_id] = std::make_unique<ExtentBitmap>();
+    ReadPhysicalPage(GetExtentFile(extent_id), GetBitmapPhysicalPageId(extent_id), bitmaps_[extent_id]->data_);
+    auto *bitmap = reinterpret_cast<BitmapPage<PAGE_SIZE> *>(bitmaps_[extent_id]->data_);
+    if (bitmap->CountAllocatedPages() != GetExtentMeta(extent_id)->GetExtentUsedPage(GetLocalExtentId(extent_id))) {
+      LOG(WARNING) << "Bitmap of extent " << extent_id << " disagrees with the meta page";
+    }
+  }
+  return reinterpret_cast<BitmapPage<PAGE_SIZE> *>(bitmaps_[extent_id]->data_);
+}
+
+uint32_t DiskManager::FindFreeExtent() const {
+  for (size_t word_index = 0; word_index < free_extents_.size(); word_index++) {
+    if (free_extents_[word_index] != 0) {
+      return word_index * 64 + __builtin_ctzll(free_extents_[word_index]);
+    }
+  }
+  return max_extents_;
+}
+
+void DiskManager::SetExtentFree(uint32_t extent_id, bool has_free_page) {
+  if (has_free_page) {
+    free_extents_[extent_id / 64] |= 1ULL << (extent_id % 64);
+  } else {
+    free_extents_[extent_id / 64] &= ~(1ULL << (extent_id % 64));
+  }
+}
 
 /**
  * TODO: Student Implement
  */
 page_id_t DiskManager::MapPageId(page_id_t logical_page_id) {
-  return 2 + logical_page_id + logical_page_id / BITMAP_SIZE;
+  // the meta page, then the bitmap page and the pages of every extent of the file before this one
+  uint32_t extent_id = logical_page_id / BITMAP_SIZE;
+  return 2 + GetLocalExtentId(extent_id) * (BITMAP_SIZE + 1) + logical_page_id % BITMAP_SIZE;
 }
 
-int DiskManager::GetFileSize(const std::string &file_name) {
+off_t DiskManager::GetFileSize(int fd) {
   struct stat stat_buf;
-  int rc = stat(file_name.c_str(), &stat_buf);
+  int rc = fstat(fd, &stat_buf);
   return rc == 0 ? stat_buf.st_size : -1;
 }
 
-void DiskManager::ReadPhysicalPage(page_id_t physical_page_id, char *page_data) {
-  int offset = physical_page_id * PAGE_SIZE;
+void DiskManager::ReadPhysicalPage(DataFile *file, page_id_t physical_page_id, char *page_data) {
+  if (NeedsBounceBuffer(page_data)) {
+    alignas(PAGE_SIZE) char bounce[PAGE_SIZE];
+    ReadPhysicalPage(file, physical_page_id, bounce);
+    memcpy(page_data, bounce, PAGE_SIZE);
+    return;
+  }
+  off_t offset = static_cast<off_t>(physical_page_id) * PAGE_SIZE;
   // check if read beyond file length
-  if (offset >= GetFileSize(file_name_)) {
+  if (offset >= file->file_size_) {
 #ifdef ENABLE_BPM_DEBUG
     LOG(INFO) << "Read less than a page" << std::endl;
 #endif
     memset(page_data, 0, PAGE_SIZE);
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
+    return;
+  }
+  ssize_t read_count = 0;
+  while (read_count < PAGE_SIZE) {
+    ssize_t rc = pread(file->fd_, page_data + read_count, PAGE_SIZE - read_count, offset + read_count);
+    if (rc < 0 && errno == EINTR) {
+      continue;
+    }
+    if (rc < 0) {
+      LOG(ERROR) << "I/O error while reading: " << strerror(errno);
+    }
+    if (rc <= 0) {
+      break;
+    }
+    read_count += rc;
+  }
+  // if file ends before reading PAGE_SIZE
+  if (read_count < PAGE_SIZE) {
 #ifdef ENABLE_BPM_DEBUG
-      LOG(INFO) << "Read less than a page" << std::endl;
+    LOG(INFO) << "Read less than a page" << std::endl;
 #endif
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
-    }
+    memset(page_data + read_count, 0, PAGE_SIZE - read_count);
   }
 }
 
-void DiskManager::WritePhysicalPage(page_id_t physical_page_id, const char *page_data) {
-  size_t offset = static_cast<size_t>(physical_page_id) * PAGE_SIZE;
-  // set write cursor to offset
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
-    LOG(ERROR) << "I/O error while writing";
+void DiskManager::WritePhysicalPage(DataFile *file, page_id_t physical_page_id, const char *page_data) {
+  if (NeedsBounceBuffer(page_data)) {
+    alignas(PAGE_SIZE) char bounce[PAGE_SIZE];
+    memcpy(bounce, page_data, PAGE_SIZE);
+    WritePhysicalPage(file, physical_page_id, bounce);
     return;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
-}
\ No newline at end of file
+  off_t offset = static_cast<off_t>(physical_page_id) * PAGE_SIZE;
+  ssize_t write_count = 0;
+  while (write_count < PAGE_SIZE) {
+    ssize_t rc = pwrite(file->fd_, page_data + write_count, PAGE_SIZE - write_count, offset + write_count);
+    if (rc < 0 && errno == EINTR) {
+      continue;
+    }
+    // check for I/O error
+    if (rc < 0) {
+      LOG(ERROR) << "I/O error while writing: " << strerror(errno);
+      return;
+    }
+    write_count += rc;
+  }
+  ExtendFileSize(file, offset + PAGE_SIZE);
+}
+
+void DiskManager::ExtendFileSize(DataFile *file, off_t end) {
+  off_t file_size = file->file_size_;
+  while (file_size < end && !file->file_size_.compare_exchange_weak(file_size, end)) {
+  }
+}
@@ -0,0 +1,179 @@
+#include "storage/io_uring.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "glog/logging.h"
+
+namespace {
+
+int IOUringSetup(unsigned entries, io_uring_params *params) {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int IOUringEnter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+  return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+}  // namespace
+
+IOHandle::IOHandle(ssize_t result) : request_(std::make_shared<IORequest>()) {
+  request_->result_ = result;
+  request_->length_ = result > 0 ? result : 0;
+  request_->done_ = true;
+}
+
+IOHandle::IOHandle(std::shared_ptr<IORequest> request, IOUring *ring) : request_(std::move(request)), ring_(ring) {}
+
+bool IOHandle::Wait() {
+  if (!IsDone()) {
+    ring_->Wait(request_.get());
+  }
+  if (request_->result_ < 0) {
+    return false;
+  }
+  // a short read means the end of file was reached, a short write is a failure
+  return request_->read_buffer_ != nullptr || static_cast<size_t>(request_->result_) == request_->length_;
+}
+
+std::unique_ptr<IOUring> IOUring::Create(unsigned queue_depth) {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int ring_fd = IOUringSetup(queue_depth, &params);
+  if (ring_fd < 0) {
+    return nullptr;
+  }
+  // older kernels may drop completions or map the queues separately, they are not worth supporting
+  if (!(params.features & IORING_FEAT_NODROP) || !(params.features & IORING_FEAT_SINGLE_MMAP)) {
+    close(ring_fd);
+    return nullptr;
+  }
+  std::unique_ptr<IOUring> ring(new IOUring());
+  ring->ring_fd_ = ring_fd;
+  ring->sq_entries_ = params.sq_entries;
+  ring->ring_size_ = std::max(params.sq_off.array + params.sq_entries * sizeof(unsigned),
+                              params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+  ring->ring_ptr_ =
+      mmap(nullptr, ring->ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+  if (ring->ring_ptr_ == MAP_FAILED) {
+    ring->ring_ptr_ = nullptr;
+    return nullptr;
+  }
+  ring->sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  void *sqes =
+      mmap(nullptr, ring->sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    return nullptr;
+  }
+  ring->sqes_ = reinterpret_cast<io_uring_sqe *>(sqes);
+  auto *base = reinterpret_cast<char *>(ring->ring_ptr_);
+  ring->sq_head_ = reinterpret_cast<unsigned *>(base + params.sq_off.head);
+  ring->sq_tail_ = reinterpret_cast<unsigned *>(base + params.sq_off.tail);
+  ring->sq_mask_ = reinterpret_cast<unsigned *>(base + params.sq_off.ring_mask);
+  ring->sq_array_ = reinterpret_cast<unsigned *>(base + params.sq_off.array);
+  ring->cq_head_ = reinterpret_cast<unsigned *>(base + params.cq_off.head);
+  ring->cq_tail_ = reinterpret_cast<unsigned *>(base + params.cq_off.tail);
+  ring->cq_mask_ = reinterpret_cast<unsigned *>(base + params.cq_off.ring_mask);
+  ring->cqes_ = reinterpret_cast<io_uring_cqe *>(base + params.cq_off.cqes);
+  return ring;
+}
+
+IOUring::~IOUring() {
+  {
+    std::scoped_lock<std::mutex> lock(complete_latch_);
+    while (true) {
+      {
+        std::scoped_lock<std::mutex> submit_lock(submit_latch_);
+        if (in_flight_.empty()) {
+          break;
+        }
+      }
+      ReapCompletions();
+      IOUringEnter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS);
+    }
+  }
+  if (sqes_ != nullptr) {
+    munmap(sqes_, sqes_size_);
+  }
+  if (ring_ptr_ != nullptr) {
+    munmap(ring_ptr_, ring_size_);
+  }
+  close(ring_fd_);
+}
+
+IOHandle IOUring::Read(int fd, char *buffer, size_t length, off_t offset) {
+  return Submit(IORING_OP_READ, fd, buffer, length, offset);
+}
+
+IOHandle IOUring::Write(int fd, const char *buffer, size_t length, off_t offset) {
+  return Submit(IORING_OP_WRITE, fd, const_cast<char *>(buffer), length, offset);
+}
+
+IOHandle IOUring::Submit(uint8_t opcode, int fd, char *buffer, size_t length, off_t offset) {
+  auto request = std::make_shared<IORequest>();
+  request->length_ = length;
+  if (opcode == IORING_OP_READ) {
+    request->read_buffer_ = buffer;
+  }
+  std::scoped_lock<std::mutex> lock(submit_latch_);
+  unsigned tail = *sq_tail_;
+  // every entry is handed to the kernel right away, so the queue is only full if the kernel is short of resources
+  while (tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= sq_entries_) {
+    IOUringEnter(ring_fd_, tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE), 0, 0);
+  }
+  unsigned index = tail & *sq_mask_;
+  io_uring_sqe *sqe = &sqes_[index];
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = opcode;
+  sqe->fd = fd;
+  sqe->addr = reinterpret_cast<uint64_t>(buffer);
+  sqe->len = static_cast<uint32_t>(length);
+  sqe->off = static_cast<uint64_t>(offset);
+  sqe->user_data = reinterpret_cast<uint64_t>(request.get());
+  sq_array_[index] = index;
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  in_flight_.emplace(request.get(), request);
+  int rc;
+  do {
+    rc = IOUringEnter(ring_fd_, tail + 1 - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE), 0, 0);
+  } while (rc < 0 && errno == EINTR);
+  if (rc < 0) {
+    // the entry stays in the queue and goes with the next submission
+    LOG(WARNING) << "io_uring submission deferred: " << strerror(errno);
+  }
+  return IOHandle(request, this);
+}
+
+void IOUring::Wait(IORequest *request) {
+  std::scoped_lock<std::mutex> lock(complete_latch_);
+  ReapCompletions();
+  while (!request->done_.load(std::memory_order_acquire)) {
+    int rc = IOUringEnter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS);
+    if (rc < 0 && errno != EINTR) {
+      LOG(ERROR) << "io_uring wait failed: " << strerror(errno);
+    }
+    ReapCompletions();
+  }
+}
+
+void IOUring::ReapCompletions() {
+  unsigned head = *cq_head_;
+  unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+  for (; head != tail; head++) {
+    io_uring_cqe *cqe = &cqes_[head & *cq_mask_];
+    auto *request = reinterpret_cast<IORequest *>(cqe->user_data);
+    request->result_ = cqe->res;
+    if (request->read_buffer_ != nullptr && cqe->res >= 0 && static_cast<size_t>(cqe->res) < request->length_) {
+      memset(request->read_buffer_ + cqe->res, 0, request->length_ - cqe->res);
+    }
+    request->done_.store(true, std::memory_order_release);
+    std::scoped_lock<std::mutex> lock(submit_latch_);
+    in_flight_.erase(request);
+  }
+  __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+}
@@ -1,38 +1,112 @@
 #include "storage/table_heap.h"
 
+#include <algorithm>
+
 /**
  * TODO: Student Implement
  */
 bool TableHeap::InsertTuple(Row &row, Txn *txn) { 
-  if(row.GetSerializedSize(schema_) >= PAGE_SIZE) return false;
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
-  if(page == nullptr) return false;
-  page->WLatch();
-  while(!page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_)){
+  Row stored_row;
+  Row *tuple = StoreExternalValues(row, &stored_row, txn);
+  if (tuple == nullptr) return false;
+  std::vector<ExternalValue> values;
+  GetExternalValues(*tuple, &values);
+  uint32_t serialized_size = tuple->GetSerializedSize(schema_);
+  if (serialized_size > TablePage::SIZE_MAX_ROW) {
+    FreeExternalValues(values);
+    return false;
+  }
+  while (true) {
+    page_id_t page_id = GetPageForInsert(serialized_size + TablePage::SIZE_TUPLE, txn);
+    auto page = page_id == INVALID_PAGE_ID ? nullptr
+                                           : reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (page == nullptr) {
+      FreeExternalValues(values);
+      return false;
+    }
+    page->WLatch();
+    bool inserted = page->InsertTuple(*tuple, schema_, txn, lock_manager_, log_manager_);
+    row.SetRowId(tuple->GetRowId());
+    uint32_t free_space = page->GetFreeSpaceRemaining();
     page->WUnlatch();
-    buffer_pool_manager_->UnpinPage(page->GetTablePageId(), false);
-    page_id_t next_id = page->GetNextPageId();
-    if(next_id == INVALID_PAGE_ID){
-      page_id_t new_page_id;
-      buffer_pool_manager_->NewPage(new_page_id);
-      auto new_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(new_page_id));
-      new_page->Init(new_page_id, page->GetPageId(), log_manager_, txn);
-      new_page->WLatch();
-      new_page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_);
-      new_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(new_page_id, true);///////
-      page->SetNextPageId(new_page_id);
-      buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);///////
-      return true;
-    }
-    else{
-      page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_id));
-      page->WLatch();
+    buffer_pool_manager_->UnpinPage(page_id, inserted);
+    // a concurrent insert may have taken the room, the page is then recorded as it is and another one is tried
+    UpdateFreeSpace(page_id, free_space, inserted ? &row : nullptr);
+    if (inserted) return true;
+  }
+}
+
+size_t TableHeap::InsertBatch(std::vector<Row> &rows, Txn *txn) {
+  // the values going out of line are stored first, the rows given keep theirs
+  std::vector<Row> stored_rows;
+  stored_rows.reserve(rows.size());
+  std::vector<Row *> tuples;
+  tuples.reserve(rows.size());
+  std::vector<ExternalValue> values;
+  for (auto &row : rows) {
+    stored_rows.emplace_back();
+    tuples.push_back(StoreExternalValues(row, &stored_rows.back(), txn));
+    if (tuples.back() == nullptr || tuples.back()->GetSerializedSize(schema_) > TablePage::SIZE_MAX_ROW) {
+      for (auto tuple : tuples) {
+        if (tuple != nullptr) GetExternalValues(*tuple, &values);
+      }
+      FreeExternalValues(values);
+      return 0;
+    }
+  }
+  // the tail of the heap stays the same while the batch is appended
+  std::scoped_lock<std::mutex> lock(fsm_latch_);
+  LoadFreeSpaceMap();
+  page_id_t page_id = last_page_id_;
+  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+  if (page == nullptr) {
+    for (auto tuple : tuples) {
+      GetExternalValues(*tuple, &values);
     }
+    FreeExternalValues(values);
+    return 0;
+  }
+  page->WLatch();
+  // the zone map of the page being filled is gathered here and written once the page is done
+  std::vector<char> zone_data(zone_layout_.GetEntrySize());
+  ZoneMapEntry zone(zone_data.data(), &zone_layout_);
+  zone.Clear();
+  auto write_zone = [&](page_id_t zone_page_id) {
+    UpdateZoneMap(zone_page_id, [&](ZoneMapEntry &entry) { entry.Widen(zone); });
+    zone.Clear();
+  };
+  size_t i = 0;
+  while (true) {
+    while (i < rows.size() && page->InsertTuple(*tuples[i], schema_, txn, lock_manager_, log_manager_)) {
+      rows[i].SetRowId(tuples[i]->GetRowId());
+      zone.Widen(rows[i]);
+      i++;
+    }
+    if (i == rows.size()) break;
+    // the page is full, chain a fresh one to it
+    page_id_t new_page_id;
+    auto new_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(new_page_id));
+    if (new_page == nullptr) break;
+    new_page->Init(new_page_id, page_id, log_manager_, txn);
+    new_page->WLatch();
+    page->SetNextPageId(new_page_id);
+    SetFreeSpace(page_id, page->GetFreeSpaceRemaining());
+    write_zone(page_id);
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    RegisterPage(new_page_id, new_page->GetFreeSpaceRemaining());
+    page = new_page;
+    page_id = new_page_id;
   }
+  SetFreeSpace(page_id, page->GetFreeSpaceRemaining());
+  write_zone(page_id);
   page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
-  return true;
+  buffer_pool_manager_->UnpinPage(page_id, true);
+  for (size_t j = i; j < rows.size(); j++) {
+    GetExternalValues(*tuples[j], &values);
+  }
+  FreeExternalValues(values);
+  return i;
 }
 
 bool TableHeap::MarkDelete(const RowId &rid, Txn *txn) {
@@ -58,11 +132,23 @@ bool TableHeap::UpdateTuple(Row &row, const RowId &rid, Txn *txn) {
   if (old_page == nullptr) {
     return false;
   }
+  Row stored_row;
+  Row *tuple = StoreExternalValues(row, &stored_row, txn);
+  if (tuple == nullptr) {
+    buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
+    return false;
+  }
   old_page->WLatch();
   Row old_row(rid);
-  bool result = old_page->UpdateTuple(row, &old_row, schema_, txn, lock_manager_, log_manager_);
+  bool result = old_page->UpdateTuple(*tuple, &old_row, schema_, txn, lock_manager_, log_manager_);
+  uint32_t free_space = old_page->GetFreeSpaceRemaining();
   old_page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(old_page->GetTablePageId(), true);
+  buffer_pool_manager_->UnpinPage(rid.GetPageId(), true);
+  UpdateFreeSpace(rid.GetPageId(), free_space, result ? &row : nullptr);
+  // the values stored out of line by the old version go with it, the new ones go if the new version did not fit
+  std::vector<ExternalValue> values;
+  GetExternalValues(result ? old_row : *tuple, &values);
+  FreeExternalValues(values);
   return result;
 
  }
@@ -76,9 +162,21 @@ void TableHeap::ApplyDelete(const RowId &rid, Txn *txn) {
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   ASSERT(page!= nullptr,"page not found.");
   page->WLatch();
+  std::vector<ExternalValue> values;
+  RowView view;
+  if (page->GetTupleView(rid, schema_, &view, true)) {
+    for (uint32_t i = 0; i < view.GetFieldCount(); i++) {
+      if (view.IsExternal(i)) values.push_back(view.GetExternalValue(i));
+    }
+  }
   page->ApplyDelete(rid, txn, log_manager_);
+  uint32_t free_space = page->GetFreeSpaceRemaining();
+  RowId first_rid;
+  bool is_empty = !page->GetFirstTupleRid(&first_rid);
   page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  buffer_pool_manager_->UnpinPage(rid.GetPageId(), true);
+  UpdateFreeSpace(rid.GetPageId(), free_space, nullptr, is_empty);
+  FreeExternalValues(values);
 }
 
 void TableHeap::RollbackDelete(const RowId &rid, Txn *txn) {
@@ -95,41 +193,134 @@ void TableHeap::RollbackDelete(const RowId &rid, Txn *txn) {
 /**
  * TODO: Student Implement
  */
-bool TableHeap::GetTuple(Row *row, Txn *txn) { 
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(row->GetRowId().GetPageId()));
+bool TableHeap::GetTuple(Row *row, Txn *txn, AccessType access_type) {
+  auto page =
+      reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(row->GetRowId().GetPageId(), access_type));
   if (page == nullptr) {
     return false;
   }
   page->RLatch();
   bool result = page->GetTuple(row, schema_, txn,lock_manager_);
+  if (result) {
+    // read while the tuple is latched, an update frees the values of the old version
+    LoadExternalValues(row);
+  }
   page->RUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), false);
   return result;
  }
 
+size_t TableHeap::Vacuum(Txn *txn, const std::function<void(const Row &, const RowId &)> &on_move) {
+  std::scoped_lock<std::mutex> lock(fsm_latch_);
+  LoadFreeSpaceMap();
+  // compact every page of the list, counting the tuples left
+  std::vector<page_id_t> page_ids;
+  std::vector<uint32_t> tuple_counts;
+  std::vector<ExternalValue> values;
+  for (page_id_t page_id = first_page_id_; page_id != INVALID_PAGE_ID;) {
+    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    ASSERT(page != nullptr, "page not found.");
+    page->WLatch();
+    page_ids.push_back(page_id);
+    GetExternalValues(page, true, &values);
+    tuple_counts.push_back(page->Compact(txn, log_manager_));
+    page_id_t next_page_id = page->GetNextPageId();
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_ids.back(), true);
+    page_id = next_page_id;
+  }
+  FreeExternalValues(values);
+  // move the tuples of the last pages to the first pages with room, until the two meet
+  size_t target = 0;
+  TablePage *target_page = nullptr;
+  auto release_target = [&]() {
+    target_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_ids[target], true);
+    target_page = nullptr;
+  };
+  for (size_t source = page_ids.size() - 1; source > target; source--) {
+    auto source_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_ids[source]));
+    ASSERT(source_page != nullptr, "page not found.");
+    source_page->WLatch();
+    RowId rid;
+    bool has_tuple = source_page->GetFirstTupleRid(&rid);
+    while (has_tuple && target < source) {
+      if (target_page == nullptr) {
+        target_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_ids[target]));
+        ASSERT(target_page != nullptr, "page not found.");
+        target_page->WLatch();
+      }
+      Row row(rid);
+      source_page->GetTuple(&row, schema_, txn, lock_manager_);
+      if (!target_page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_)) {
+        release_target();
+        target++;
+        continue;
+      }
+      tuple_counts[target]++;
+      source_page->ApplyDelete(rid, txn, log_manager_);
+      tuple_counts[source]--;
+      if (on_move != nullptr) {
+        // the moved tuple keeps the pointers to its values, the callback is given the values
+        LoadExternalValues(&row);
+        on_move(row, rid);
+      }
+      has_tuple = source_page->GetNextTupleRid(rid, &rid);
+    }
+    source_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_ids[source], true);
+  }
+  if (target_page != nullptr) {
+    release_target();
+  }
+  // unlink the empty pages, the first page stays as the table is found by it
+  std::vector<page_id_t> kept_page_ids;
+  std::vector<page_id_t> empty_page_ids;
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    (i == 0 || tuple_counts[i] > 0 ? kept_page_ids : empty_page_ids).push_back(page_ids[i]);
+  }
+  if (!empty_page_ids.empty()) {
+    for (size_t i = 0; i < kept_page_ids.size(); i++) {
+      auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(kept_page_ids[i]));
+      page->WLatch();
+      page->SetPrevPageId(i == 0 ? INVALID_PAGE_ID : kept_page_ids[i - 1]);
+      page->SetNextPageId(i + 1 == kept_page_ids.size() ? INVALID_PAGE_ID : kept_page_ids[i + 1]);
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(kept_page_ids[i], true);
+    }
+    for (page_id_t page_id : empty_page_ids) {
+      buffer_pool_manager_->DeletePage(page_id);
+    }
+  }
+  // the maps record the pages by their position in the list, which changed
+  RebuildFreeSpaceMap(kept_page_ids, txn);
+  return empty_page_ids.size();
+}
+
 void TableHeap::DeleteTable(page_id_t page_id) {
   if (page_id != INVALID_PAGE_ID) {
     auto temp_table_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));  // 删除table_heap
     if (temp_table_page->GetNextPageId() != INVALID_PAGE_ID)
       DeleteTable(temp_table_page->GetNextPageId());
+    std::vector<ExternalValue> values;
+    GetExternalValues(temp_table_page, false, &values);
     buffer_pool_manager_->UnpinPage(page_id, false);
     buffer_pool_manager_->DeletePage(page_id);
+    FreeExternalValues(values);
   } else {
     DeleteTable(first_page_id_);
+    FreeFreeSpaceMap();
   }
 }
 
 /**
  * TODO: Student Implement
  */
-TableIterator TableHeap::Begin(Txn *txn) { 
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
-  RowId row_id;
-  page->RLatch();
-  page->GetFirstTupleRid(&row_id);
-  page->RUnlatch();
-  return TableIterator(this, row_id, txn);
- }
+TableIterator TableHeap::Begin(Txn *txn) { return TableIterator(this, RowId(first_page_id_, 0), txn); }
+
+TableIterator TableHeap::Begin(Txn *txn, page_id_t begin_page_id, page_id_t end_page_id) {
+  return TableIterator(this, RowId(begin_page_id, 0), txn, end_page_id);
+}
 
 /**
  * TODO: Student Implement
@@ -137,3 +328,376 @@ TableIterator TableHeap::Begin(Txn *txn) {
 TableIterator TableHeap::End() { 
   return TableIterator(this,INVALID_ROWID,nullptr);
  }
+
+void TableHeap::LoadFreeSpaceMap() {
+  if (fsm_loaded_) {
+    return;
+  }
+  for (page_id_t fsm_page_id = fsm_page_id_; fsm_page_id != INVALID_PAGE_ID;) {
+    auto fsm_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(fsm_page_id)->GetData());
+    uint32_t base = fsm_pages_.size() * FreeSpaceMapPage::MAX_ENTRIES;
+    for (uint32_t slot = 0; slot < fsm_page->GetEntryCount(); slot++) {
+      fsm_slots_[fsm_page->GetPageId(slot)] = base + slot;
+      last_page_id_ = fsm_page->GetPageId(slot);
+    }
+    fsm_pages_.push_back(fsm_page_id);
+    fsm_max_category_.push_back(fsm_page->GetMaxCategory());
+    page_id_t next_page_id = fsm_page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(fsm_page_id, false);
+    fsm_page_id = next_page_id;
+  }
+  for (page_id_t zone_map_page_id = zone_map_page_id_; zone_map_page_id != INVALID_PAGE_ID;) {
+    auto zone_map_page =
+        reinterpret_cast<ZoneMapPage *>(buffer_pool_manager_->FetchPage(zone_map_page_id)->GetData());
+    zone_map_pages_.push_back(zone_map_page_id);
+    page_id_t next_page_id = zone_map_page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(zone_map_page_id, false);
+    zone_map_page_id = next_page_id;
+  }
+  fsm_loaded_ = true;
+}
+
+page_id_t TableHeap::GetPageForInsert(uint32_t free_space, Txn *txn) {
+  std::scoped_lock<std::mutex> lock(fsm_latch_);
+  LoadFreeSpaceMap();
+  uint32_t category = FreeSpaceMapPage::ToRequiredCategory(free_space);
+  for (size_t i = 0; i < fsm_pages_.size(); i++) {
+    if (fsm_max_category_[i] < category) {
+      continue;
+    }
+    auto fsm_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(fsm_pages_[i])->GetData());
+    int slot = fsm_page->Search(free_space);
+    page_id_t page_id = slot >= 0 ? fsm_page->GetPageId(slot) : INVALID_PAGE_ID;
+    buffer_pool_manager_->UnpinPage(fsm_pages_[i], false);
+    if (page_id != INVALID_PAGE_ID) {
+      return page_id;
+    }
+  }
+  // no page has enough room, append a new one to the end of the list
+  page_id_t new_page_id;
+  auto new_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(new_page_id));
+  if (new_page == nullptr) {
+    return INVALID_PAGE_ID;
+  }
+  new_page->Init(new_page_id, last_page_id_, log_manager_, txn);
+  uint32_t new_page_free_space = new_page->GetFreeSpaceRemaining();
+  buffer_pool_manager_->UnpinPage(new_page_id, true);
+  auto last_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(last_page_id_));
+  last_page->WLatch();
+  last_page->SetNextPageId(new_page_id);
+  last_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(last_page_id_, true);
+  RegisterPage(new_page_id, new_page_free_space);
+  return new_page_id;
+}
+
+void TableHeap::RegisterPage(page_id_t page_id, uint32_t free_space) {
+  page_id_t fsm_page_id = fsm_pages_.empty() ? fsm_page_id_ : fsm_pages_.back();
+  auto fsm_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(fsm_page_id)->GetData());
+  if (fsm_pages_.empty()) {
+    fsm_pages_.push_back(fsm_page_id);
+    fsm_max_category_.push_back(fsm_page->GetMaxCategory());
+  }
+  if (fsm_page->IsFull()) {
+    page_id_t next_fsm_page_id;
+    auto next_fsm_page =
+        reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->NewPage(next_fsm_page_id)->GetData());
+    next_fsm_page->Init();
+    fsm_page->SetNextPageId(next_fsm_page_id);
+    buffer_pool_manager_->UnpinPage(fsm_page_id, true);
+    fsm_page_id = next_fsm_page_id;
+    fsm_page = next_fsm_page;
+    fsm_pages_.push_back(fsm_page_id);
+    fsm_max_category_.push_back(0);
+  }
+  uint32_t slot = fsm_page->Append(page_id, free_space);
+  fsm_slots_[page_id] = (fsm_pages_.size() - 1) * FreeSpaceMapPage::MAX_ENTRIES + slot;
+  fsm_max_category_.back() = fsm_page->GetMaxCategory();
+  last_page_id_ = page_id;
+  buffer_pool_manager_->UnpinPage(fsm_page_id, true);
+  if (zone_map_page_id_ == INVALID_PAGE_ID) {
+    return;
+  }
+  if (zone_map_pages_.empty()) {
+    zone_map_pages_.push_back(zone_map_page_id_);
+  }
+  page_id_t zone_map_page_id = zone_map_pages_.back();
+  auto zone_map_page = reinterpret_cast<ZoneMapPage *>(buffer_pool_manager_->FetchPage(zone_map_page_id)->GetData());
+  if (zone_map_page->IsFull(zone_layout_)) {
+    page_id_t next_zone_map_page_id;
+    auto next_zone_map_page =
+        reinterpret_cast<ZoneMapPage *>(buffer_pool_manager_->NewPage(next_zone_map_page_id)->GetData());
+    next_zone_map_page->Init();
+    zone_map_page->SetNextPageId(next_zone_map_page_id);
+    buffer_pool_manager_->UnpinPage(zone_map_page_id, true);
+    zone_map_page_id = next_zone_map_page_id;
+    zone_map_page = next_zone_map_page;
+    zone_map_pages_.push_back(zone_map_page_id);
+  }
+  zone_map_page->Append(zone_layout_);
+  buffer_pool_manager_->UnpinPage(zone_map_page_id, true);
+}
+
+void TableHeap::UpdateFreeSpace(page_id_t page_id, uint32_t free_space, const Row *row, bool is_empty) {
+  std::scoped_lock<std::mutex> lock(fsm_latch_);
+  LoadFreeSpaceMap();
+  SetFreeSpace(page_id, free_space);
+  if (is_empty) {
+    UpdateZoneMap(page_id, [](ZoneMapEntry &zone) { zone.Clear(); });
+  } else if (row != nullptr) {
+    UpdateZoneMap(page_id, [row](ZoneMapEntry &zone) { zone.Widen(*row); });
+  }
+}
+
+void TableHeap::UpdateZoneMap(page_id_t page_id, const std::function<void(ZoneMapEntry &)> &update) {
+  auto iter = fsm_slots_.find(page_id);
+  if (iter == fsm_slots_.end()) {
+    return;
+  }
+  uint32_t entries_per_page = ZoneMapPage::GetMaxEntries(zone_layout_);
+  uint32_t index = iter->second / entries_per_page;
+  if (index >= zone_map_pages_.size()) {
+    return;
+  }
+  auto zone_map_page =
+      reinterpret_cast<ZoneMapPage *>(buffer_pool_manager_->FetchPage(zone_map_pages_[index])->GetData());
+  if (iter->second % entries_per_page < zone_map_page->GetEntryCount()) {
+    ZoneMapEntry zone = zone_map_page->GetEntry(iter->second % entries_per_page, zone_layout_);
+    update(zone);
+  }
+  buffer_pool_manager_->UnpinPage(zone_map_pages_[index], true);
+}
+
+void TableHeap::SetFreeSpace(page_id_t page_id, uint32_t free_space) {
+  auto iter = fsm_slots_.find(page_id);
+  if (iter == fsm_slots_.end()) {
+    return;
+  }
+  uint32_t index = iter->second / FreeSpaceMapPage::MAX_ENTRIES;
+  auto fsm_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(fsm_pages_[index])->GetData());
+  fsm_page->Update(iter->second % FreeSpaceMapPage::MAX_ENTRIES, free_space);
+  fsm_max_category_[index] = fsm_page->GetMaxCategory();
+  buffer_pool_manager_->UnpinPage(fsm_pages_[index], true);
+}
+
+std::vector<page_id_t> TableHeap::GetPageDirectory(const std::function<bool(const ZoneMapEntry &)> &filter,
+                                                   std::vector<bool> *may_match) {
+  std::scoped_lock<std::mutex> lock(fsm_latch_);
+  LoadFreeSpaceMap();
+  std::vector<page_id_t> page_ids;
+  page_ids.reserve(fsm_slots_.size());
+  for (page_id_t fsm_page_id : fsm_pages_) {
+    auto fsm_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(fsm_page_id)->GetData());
+    for (uint32_t slot = 0; slot < fsm_page->GetEntryCount(); slot++) {
+      page_ids.push_back(fsm_page->GetPageId(slot));
+    }
+    buffer_pool_manager_->UnpinPage(fsm_page_id, false);
+  }
+  if (may_match == nullptr) {
+    return page_ids;
+  }
+  // the zone maps are in the order of the directory, a page without one may always match
+  may_match->assign(page_ids.size(), true);
+  if (filter == nullptr) {
+    return page_ids;
+  }
+  size_t position = 0;
+  for (page_id_t zone_map_page_id : zone_map_pages_) {
+    auto zone_map_page =
+        reinterpret_cast<ZoneMapPage *>(buffer_pool_manager_->FetchPage(zone_map_page_id)->GetData());
+    for (uint32_t slot = 0; slot < zone_map_page->GetEntryCount() && position < page_ids.size(); slot++, position++) {
+      (*may_match)[position] = filter(zone_map_page->GetEntry(slot, zone_layout_));
+    }
+    buffer_pool_manager_->UnpinPage(zone_map_page_id, false);
+  }
+  return page_ids;
+}
+
+void TableHeap::RebuildFreeSpaceMap(const std::vector<page_id_t> &page_ids, Txn *txn) {
+  // keep the first page of each map, its id is recorded in the table metadata
+  auto reset_chain = [this](page_id_t head_page_id, const std::vector<page_id_t> &chain) {
+    for (page_id_t page_id : chain) {
+      if (page_id != head_page_id) {
+        buffer_pool_manager_->DeletePage(page_id);
+      }
+    }
+  };
+  reset_chain(fsm_page_id_, fsm_pages_);
+  auto fsm_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(fsm_page_id_)->GetData());
+  fsm_page->Init();
+  buffer_pool_manager_->UnpinPage(fsm_page_id_, true);
+  fsm_pages_.clear();
+  fsm_max_category_.clear();
+  fsm_slots_.clear();
+  if (zone_map_page_id_ != INVALID_PAGE_ID) {
+    reset_chain(zone_map_page_id_, zone_map_pages_);
+    auto zone_map_page =
+        reinterpret_cast<ZoneMapPage *>(buffer_pool_manager_->FetchPage(zone_map_page_id_)->GetData());
+    zone_map_page->Init();
+    buffer_pool_manager_->UnpinPage(zone_map_page_id_, true);
+  }
+  zone_map_pages_.clear();
+  // the zone maps are rebuilt from the tuples left, so they are as tight as they can be
+  std::vector<char> zone_data(zone_layout_.GetEntrySize());
+  ZoneMapEntry zone(zone_data.data(), &zone_layout_);
+  for (page_id_t page_id : page_ids) {
+    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    page->RLatch();
+    zone.Clear();
+    RowId rid;
+    for (bool has_tuple = page->GetFirstTupleRid(&rid); has_tuple; has_tuple = page->GetNextTupleRid(rid, &rid)) {
+      Row row(rid);
+      page->GetTuple(&row, schema_, txn, lock_manager_);
+      zone.Widen(row);
+    }
+    uint32_t free_space = page->GetFreeSpaceRemaining();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    RegisterPage(page_id, free_space);
+    UpdateZoneMap(page_id, [&](ZoneMapEntry &entry) { entry.Widen(zone); });
+  }
+}
+
+void TableHeap::FreeFreeSpaceMap() {
+  std::scoped_lock<std::mutex> lock(fsm_latch_);
+  for (page_id_t fsm_page_id = fsm_page_id_; fsm_page_id != INVALID_PAGE_ID;) {
+    auto fsm_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(fsm_page_id)->GetData());
+    page_id_t next_page_id = fsm_page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(fsm_page_id, false);
+    buffer_pool_manager_->DeletePage(fsm_page_id);
+    fsm_page_id = next_page_id;
+  }
+  for (page_id_t zone_map_page_id = zone_map_page_id_; zone_map_page_id != INVALID_PAGE_ID;) {
+    auto zone_map_page =
+        reinterpret_cast<ZoneMapPage *>(buffer_pool_manager_->FetchPage(zone_map_page_id)->GetData());
+    page_id_t next_page_id = zone_map_page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(zone_map_page_id, false);
+    buffer_pool_manager_->DeletePage(zone_map_page_id);
+    zone_map_page_id = next_page_id;
+  }
+  fsm_page_id_ = INVALID_PAGE_ID;
+  fsm_pages_.clear();
+  fsm_max_category_.clear();
+  fsm_slots_.clear();
+  zone_map_page_id_ = INVALID_PAGE_ID;
+  zone_map_pages_.clear();
+}
+
+void TableHeap::ReadExternalValue(const ExternalValue &value, char *buf) const {
+  uint32_t offset = 0;
+  for (page_id_t page_id = value.first_page_id_; page_id != INVALID_PAGE_ID && offset < value.length_;) {
+    auto page = reinterpret_cast<OverflowPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+    memcpy(buf + offset, page->GetData(), page->GetDataSize());
+    offset += page->GetDataSize();
+    page_id_t next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  ASSERT(offset == value.length_, "Unexpected length of a value stored out of line.");
+}
+
+Row *TableHeap::StoreExternalValues(Row &row, Row *stored_row, Txn *txn) {
+  // a value shorter than the pointer to it stays in the row even if the row is too large
+  bool too_large = row.GetSerializedSize(schema_) > TablePage::SIZE_MAX_ROW;
+  auto goes_out_of_line = [&](const Field *field) {
+    return field->GetTypeId() == TypeId::kTypeChar && !field->IsNull() && !field->IsExternal() &&
+           field->GetLength() > sizeof(ExternalValue) && (too_large || field->GetLength() > external_threshold_);
+  };
+  uint32_t i = 0;
+  while (i < row.GetFieldCount() && !goes_out_of_line(row.GetField(i))) {
+    i++;
+  }
+  if (i == row.GetFieldCount()) {
+    return &row;
+  }
+  stored_row->destroy();
+  stored_row->SetRowId(row.GetRowId());
+  auto &fields = stored_row->GetFields();
+  for (i = 0; i < row.GetFieldCount(); i++) {
+    Field *field = row.GetField(i);
+    if (!goes_out_of_line(field)) {
+      fields.push_back(new Field(*field));
+      continue;
+    }
+    ExternalValue value = StoreExternalValue(field->GetData(), field->GetLength(), txn);
+    if (value.first_page_id_ == INVALID_PAGE_ID) {
+      std::vector<ExternalValue> values;
+      GetExternalValues(*stored_row, &values);
+      FreeExternalValues(values);
+      stored_row->destroy();
+      return nullptr;
+    }
+    fields.push_back(new Field(TypeId::kTypeChar, value));
+  }
+  return stored_row;
+}
+
+ExternalValue TableHeap::StoreExternalValue(const char *data, uint32_t length, [[maybe_unused]] Txn *txn) {
+  // the chain is written from its end, so that every page is written once with the id of the next one
+  page_id_t next_page_id = INVALID_PAGE_ID;
+  for (uint32_t pieces = (length + OverflowPage::MAX_DATA_SIZE - 1) / OverflowPage::MAX_DATA_SIZE; pieces > 0;
+       pieces--) {
+    page_id_t page_id;
+    auto page = buffer_pool_manager_->NewPage(page_id);
+    if (page == nullptr) {
+      FreeExternalValues({ExternalValue{next_page_id, length}});
+      return ExternalValue{INVALID_PAGE_ID, length};
+    }
+    auto overflow_page = reinterpret_cast<OverflowPage *>(page->GetData());
+    overflow_page->Init(next_page_id);
+    uint32_t offset = (pieces - 1) * OverflowPage::MAX_DATA_SIZE;
+    overflow_page->SetData(data + offset, std::min(length - offset, OverflowPage::MAX_DATA_SIZE));
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    next_page_id = page_id;
+  }
+  return ExternalValue{next_page_id, length};
+}
+
+void TableHeap::LoadExternalValues(Row *row) const {
+  for (auto &field : row->GetFields()) {
+    if (!field->IsExternal()) {
+      continue;
+    }
+    ExternalValue value = field->GetExternalValue();
+    std::vector<char> buf(value.length_);
+    ReadExternalValue(value, buf.data());
+    delete field;
+    field = new Field(TypeId::kTypeChar, buf.data(), value.length_, true);
+  }
+}
+
+void TableHeap::GetExternalValues(const Row &row, std::vector<ExternalValue> *values) {
+  for (uint32_t i = 0; i < row.GetFieldCount(); i++) {
+    if (row.GetField(i)->IsExternal()) {
+      values->push_back(row.GetField(i)->GetExternalValue());
+    }
+  }
+}
+
+void TableHeap::GetExternalValues(TablePage *page, bool deleted_only, std::vector<ExternalValue> *values) {
+  RowView view;
+  for (uint32_t slot = 0; slot < page->GetTupleCount(); slot++) {
+    RowId rid(page->GetTablePageId(), slot);
+    if (!page->GetTupleView(rid, schema_, &view, true) ||
+        (deleted_only && page->GetTupleView(rid, schema_, &view))) {
+      continue;
+    }
+    for (uint32_t i = 0; i < view.GetFieldCount(); i++) {
+      if (view.IsExternal(i)) {
+        values->push_back(view.GetExternalValue(i));
+      }
+    }
+  }
+}
+
+void TableHeap::FreeExternalValues(const std::vector<ExternalValue> &values) {
+  for (const auto &value : values) {
+    for (page_id_t page_id = value.first_page_id_; page_id != INVALID_PAGE_ID;) {
+      auto page = reinterpret_cast<OverflowPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+      page_id_t next_page_id = page->GetNextPageId();
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      buffer_pool_manager_->DeletePage(page_id);
+      page_id = next_page_id;
+    }
+  }
+}
@@ -3,88 +3,150 @@
 #include "common/macros.h"
 #include "storage/table_heap.h"
 
-/**
- * TODO: Student Implement
- */
-TableIterator::TableIterator(TableHeap *table_heap, RowId rid, Txn *txn) {
-  table_heap_ = table_heap;
-  if (rid.GetPageId() != INVALID_PAGE_ID) {
-    row_ = new Row(rid);
-    table_heap_->GetTuple(row_, txn);
-  } 
-  else {
-    row_ = new Row(INVALID_ROWID);
+TableIterator::TableIterator(TableHeap *table_heap, RowId rid, Txn *txn, page_id_t end_page_id)
+    : table_heap_(table_heap), rid_(rid), end_page_id_(end_page_id), txn_(txn) {
+  if (rid_.GetPageId() == INVALID_PAGE_ID || rid_.GetPageId() == end_page_id_) {
+    rid_ = INVALID_ROWID;
+    return;
+  }
+  page_ = reinterpret_cast<TablePage *>(
+      table_heap_->buffer_pool_manager_->FetchPage(rid_.GetPageId(), AccessType::SCAN_ACCESS));
+  page_->RLatch();
+  bool found = page_->GetTupleView(rid_, table_heap_->schema_, &view_);
+  page_->RUnlatch();
+  if (!found) {
+    MoveToNextTuple();
   }
 }
 
-TableIterator::TableIterator(const TableIterator &other) {
-  table_heap_ = other.table_heap_;
-  row_ = other.row_;
+TableIterator::TableIterator(const TableIterator &other)
+    : table_heap_(other.table_heap_),
+      rid_(other.rid_),
+      end_page_id_(other.end_page_id_),
+      txn_(other.txn_),
+      read_ahead_(other.read_ahead_) {
+  if (other.page_ != nullptr) {
+    page_ = reinterpret_cast<TablePage *>(
+        table_heap_->buffer_pool_manager_->FetchPage(rid_.GetPageId(), AccessType::SCAN_ACCESS));
+  }
 }
 
-TableIterator::~TableIterator() {
-  delete row_;
+TableIterator::TableIterator(TableIterator &&other) noexcept
+    : table_heap_(other.table_heap_),
+      page_(other.page_),
+      rid_(other.rid_),
+      end_page_id_(other.end_page_id_),
+      txn_(other.txn_),
+      read_ahead_(other.read_ahead_) {
+  other.page_ = nullptr;
+  other.rid_ = INVALID_ROWID;
+  other.row_loaded_ = false;
 }
 
-bool TableIterator::operator==(const TableIterator &itr) const {
-  return this->row_->GetRowId() == itr.row_->GetRowId() && this->table_heap_ == itr.table_heap_;
-}
+TableIterator::~TableIterator() { Release(); }
 
-bool TableIterator::operator!=(const TableIterator &itr) const {
-  return !this->operator==(itr);
+void TableIterator::Release() {
+  if (page_ != nullptr) {
+    table_heap_->buffer_pool_manager_->UnpinPage(page_->GetPageId(), false);
+    page_ = nullptr;
+  }
 }
 
-const Row &TableIterator::operator*() {
-  return *row_;
+bool TableIterator::operator==(const TableIterator &itr) const {
+  return rid_ == itr.rid_ && table_heap_ == itr.table_heap_;
 }
 
+bool TableIterator::operator!=(const TableIterator &itr) const { return !this->operator==(itr); }
+
+const Row &TableIterator::operator*() { return *operator->(); }
+
 Row *TableIterator::operator->() {
-  return row_;
+  ASSERT(page_ != nullptr, "Dereferencing the end of a table heap.");
+  if (!row_loaded_) {
+    row_.destroy();
+    row_.SetRowId(rid_);
+    page_->RLatch();
+    page_->GetTuple(&row_, table_heap_->schema_, txn_, table_heap_->lock_manager_);
+    table_heap_->LoadExternalValues(&row_);
+    page_->RUnlatch();
+    row_loaded_ = true;
+  }
+  return &row_;
 }
 
-TableIterator &TableIterator::operator=(const TableIterator &itr) noexcept {
-  this->table_heap_=itr.table_heap_;
-  this->row_=new Row(*itr.row_);
+TableIterator &TableIterator::operator=(const TableIterator &itr) {
+  if (this != &itr) {
+    *this = TableIterator(itr);
+  }
   return *this;
 }
 
-//++iter
-TableIterator &TableIterator::operator++() {
-  if (row_ == nullptr || row_->GetRowId().GetPageId() == INVALID_PAGE_ID) {
-    return *this;
+TableIterator &TableIterator::operator=(TableIterator &&itr) noexcept {
+  if (this != &itr) {
+    Release();
+    table_heap_ = itr.table_heap_;
+    page_ = itr.page_;
+    rid_ = itr.rid_;
+    end_page_id_ = itr.end_page_id_;
+    txn_ = itr.txn_;
+    row_loaded_ = false;
+    read_ahead_ = itr.read_ahead_;
+    itr.page_ = nullptr;
+    itr.rid_ = INVALID_ROWID;
+    itr.row_loaded_ = false;
   }
-  auto page = reinterpret_cast<TablePage *>(table_heap_->buffer_pool_manager_->FetchPage(row_->GetRowId().GetPageId()));
-  RowId next_rid;
-  page->RLatch();
-  if (!page->GetNextTupleRid(row_->GetRowId(), &next_rid)) {
-    page->RUnlatch();
-    if(page->GetNextPageId() != INVALID_PAGE_ID) {
-      page_id_t next_page_id = page->GetNextPageId();
-      
-      auto next_page = reinterpret_cast<TablePage *>(this->table_heap_->buffer_pool_manager_->FetchPage(next_page_id));
-      next_page->RLatch();
-      next_page->GetFirstTupleRid(&next_rid);
-      next_page->RUnlatch();
+  return *this;
+}
+
+void TableIterator::MoveToNextTuple() {
+  auto bpm = table_heap_->buffer_pool_manager_;
+  row_loaded_ = false;
+  page_->RLatch();
+  bool found = page_->GetNextTupleRid(rid_, &rid_);
+  while (!found) {
+    page_id_t next_page_id = page_->GetNextPageId();
+    page_->RUnlatch();
+    Release();
+    if (next_page_id == INVALID_PAGE_ID || next_page_id == end_page_id_) {
+      rid_ = INVALID_ROWID;
+      return;
     }
-    else {
-      next_rid = INVALID_ROWID;
+    page_ = reinterpret_cast<TablePage *>(bpm->FetchPage(next_page_id, AccessType::SCAN_ACCESS));
+    page_->RLatch();
+    if (read_ahead_.OnPageHop()) {
+      bpm->PrefetchChain(page_->GetNextPageId(), READ_AHEAD_PAGES,
+                         [](Page *page) { return reinterpret_cast<TablePage *>(page)->GetNextPageId(); });
     }
+    found = page_->GetFirstTupleRid(&rid_);
   }
-  else {
-    page->RUnlatch();
-    table_heap_->buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
-  }
-  delete row_;
-  row_ = new Row(next_rid);
-  if(next_rid.GetPageId()!=INVALID_PAGE_ID) {
-    table_heap_->GetTuple(row_, nullptr);
+  page_->RUnlatch();
+}
+
+// ++iter
+TableIterator &TableIterator::operator++() {
+  if (page_ != nullptr) {
+    MoveToNextTuple();
   }
   return *this;
 }
 
 // iter++
 TableIterator TableIterator::operator++(int) {
-  RowId rid=this->row_->GetRowId();
+  TableIterator old(*this);
   this->operator++();
-  return TableIterator(this->table_heap_,rid,nullptr);
+  return old;
+}
+
+bool TableIterator::SkipUntil(const std::function<bool(const RowView &)> &accept) {
+  view_.SetExternalValueReader(table_heap_);
+  while (page_ != nullptr) {
+    page_->RLatch();
+    bool accepted = page_->GetTupleView(rid_, table_heap_->schema_, &view_) && accept(view_);
+    page_->RUnlatch();
+    if (accepted) {
+      return true;
+    }
+    MoveToNextTuple();
+  }
+  return false;
 }
@@ -1,8 +1,11 @@
 #include "buffer/buffer_pool_manager.h"
 
+#include <chrono>
 #include <cstdio>
 #include <random>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -71,4 +74,164 @@ TEST(BufferPoolManagerTest, BinaryDataTest) {
 
   delete bpm;
   delete disk_manager;
-}
\ No newline at end of file
+}
+
+TEST(BufferPoolManagerTest, PageCleanerTest) {
+  const std::string db_name = "bpm_cleaner_test.db";
+  const size_t buffer_pool_size = 10;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  // Scenario: fill the pool with dirty pages, the one in the last frame stays pinned.
+  std::vector<Page *> pages;
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    pages.push_back(page);
+  }
+  for (size_t i = 0; i + 1 < buffer_pool_size; i++) {
+    EXPECT_TRUE(bpm->UnpinPage(pages[i]->GetPageId(), true));
+  }
+
+  // Scenario: the cleaner writes back every unpinned page.
+  bpm->StartPageCleaner(1.0);
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  auto all_clean = [&pages]() {
+    for (size_t i = 0; i + 1 < pages.size(); i++) {
+      if (pages[i]->IsDirty()) {
+        return false;
+      }
+    }
+    return true;
+  };
+  while (!all_clean() && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(PAGE_CLEANER_INTERVAL_MS));
+  }
+  bpm->StopPageCleaner();
+  EXPECT_TRUE(all_clean());
+
+  char buf[PAGE_SIZE];
+  for (size_t i = 0; i + 1 < buffer_pool_size; i++) {
+    disk_manager->ReadPage(pages[i]->GetPageId(), buf);
+    EXPECT_EQ(0, strcmp(buf, pages[i]->GetData()));
+  }
+
+  // Scenario: a miss now evicts a clean page and the pool keeps working.
+  page_id_t page_id;
+  EXPECT_NE(nullptr, bpm->NewPage(page_id));
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  EXPECT_TRUE(bpm->UnpinPage(pages.back()->GetPageId(), true));
+
+  // Scenario: dirty pages are deleted while the cleaner may be writing them, which does not keep them allocated.
+  bpm->StartPageCleaner(1.0);
+  std::vector<page_id_t> deleted;
+  for (int i = 0; i < 200; i++) {
+    Page *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    std::this_thread::sleep_for(std::chrono::microseconds(i % 10 * 500));
+    EXPECT_TRUE(bpm->DeletePage(page_id));
+    deleted.push_back(page_id);
+  }
+  bpm->StopPageCleaner();
+  for (auto deleted_id : deleted) {
+    EXPECT_TRUE(bpm->IsPageFree(deleted_id));
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, PrefetchTest) {
+  const std::string db_name = "bpm_prefetch_test.db";
+  const size_t buffer_pool_size = 10;
+  const int num_pages = 20;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  // Scenario: page i links to page i + 2. Creating twice as many pages as frames pushes the first ones out.
+  for (int i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    ASSERT_EQ(i, page_id);
+    *reinterpret_cast<page_id_t *>(page->GetData()) = page_id + 2 < num_pages ? page_id + 2 : INVALID_PAGE_ID;
+    snprintf(page->GetData() + sizeof(page_id_t), PAGE_SIZE - sizeof(page_id_t), "page %d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: prefetch a list of pages and a chain of pages, then wait for the requests to be served.
+  bpm->Prefetch({0, 1, 2});
+  bpm->PrefetchChain(3, 4, [](Page *page) { return *reinterpret_cast<page_id_t *>(page->GetData()); });
+  bpm->StopPrefetcher();
+
+  // Scenario: overwrite the pages on disk. The prefetched pages are served from the pool and keep their content.
+  char stale_data[PAGE_SIZE] = "stale";
+  std::vector<page_id_t> prefetched = {0, 1, 2, 3, 5, 7, 9};
+  for (auto page_id : prefetched) {
+    disk_manager->WritePage(page_id, stale_data);
+  }
+  char expected[PAGE_SIZE];
+  for (auto page_id : prefetched) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(0, strcmp(expected, page->GetData() + sizeof(page_id_t)));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, DirectIOTest) {
+  const std::string db_name = "bpm_direct_io_test.db";
+  const size_t buffer_pool_size = 10;
+  const int num_pages = 30;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name, true, true);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  // Scenario: every frame is page aligned, so that it can be handed to O_DIRECT as is.
+  for (int i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(page->GetData()) % PAGE_SIZE);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: pages evicted and read back through the cache bypass keep their content.
+  char expected[PAGE_SIZE];
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(0, strcmp(expected, page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: a buffer which is not page aligned still works.
+  bpm->FlushAllPages();
+  std::vector<char> buffer(PAGE_SIZE + 1);
+  disk_manager->ReadPage(num_pages - 1, buffer.data() + 1);
+  snprintf(expected, PAGE_SIZE, "page %d", num_pages - 1);
+  EXPECT_EQ(0, strcmp(expected, buffer.data() + 1));
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
@@ -0,0 +1,84 @@
+#include "buffer/lru_k_replacer.h"
+
+#include "gtest/gtest.h"
+
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer lru_k_replacer(7, 2);
+
+  // Scenario: unpin six elements, i.e. add them to the replacer. Every frame is seen once.
+  lru_k_replacer.Unpin(1);
+  lru_k_replacer.Unpin(2);
+  lru_k_replacer.Unpin(3);
+  lru_k_replacer.Unpin(4);
+  lru_k_replacer.Unpin(5);
+  lru_k_replacer.Unpin(6);
+  lru_k_replacer.Unpin(1);
+  EXPECT_EQ(6, lru_k_replacer.Size());
+
+  // Scenario: frames with less than k accesses are evicted by their earliest access.
+  int value;
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+
+  // Scenario: pin elements in the replacer.
+  // Note that 3 has already been victimized, so pinning 3 should have no effect.
+  lru_k_replacer.Pin(3);
+  lru_k_replacer.Pin(4);
+  EXPECT_EQ(2, lru_k_replacer.Size());
+
+  // Scenario: unpin 4. Its history is kept while it is pinned, so it is still the oldest frame.
+  lru_k_replacer.Unpin(4);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(4, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(5, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(6, value);
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(0, lru_k_replacer.Size());
+}
+
+TEST(LRUKReplacerTest, BackwardKDistanceTest) {
+  LRUKReplacer lru_k_replacer(7, 2);
+
+  // Scenario: access history is 1 2 3 4 2 3 5 1, frames 4 and 5 are seen only once.
+  for (frame_id_t frame_id : {1, 2, 3, 4, 2, 3, 5, 1}) {
+    lru_k_replacer.RecordAccess(frame_id);
+  }
+  for (frame_id_t frame_id = 1; frame_id <= 5; frame_id++) {
+    lru_k_replacer.Unpin(frame_id);
+  }
+  EXPECT_EQ(5, lru_k_replacer.Size());
+
+  // Scenario: frames with an infinite distance go first, even though 4 and 5 are more recent than 2 and 3.
+  int value;
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(4, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(5, value);
+
+  // Scenario: frame 1 was accessed last, but its second most recent access is the oldest one.
+  lru_k_replacer.RecordAccess(3);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+
+  // Scenario: a pinned frame is never victimized, and a removed frame starts over with an empty history.
+  lru_k_replacer.Pin(3);
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+  lru_k_replacer.Remove(3);
+  lru_k_replacer.RecordAccess(6);
+  lru_k_replacer.RecordAccess(6);
+  lru_k_replacer.RecordAccess(3);
+  lru_k_replacer.Unpin(3);
+  lru_k_replacer.Unpin(6);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(6, value);
+}
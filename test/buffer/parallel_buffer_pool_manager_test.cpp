@@ -0,0 +1,140 @@
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+TEST(ParallelBufferPoolManagerTest, BinaryDataTest) {
+  const std::string db_name = "parallel_bpm_test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t num_instances = 5;
+
+  std::random_device r;
+  std::default_random_engine rng(r());
+  std::uniform_int_distribution<unsigned> uniform_dist(0, 127);
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+  EXPECT_EQ(buffer_pool_size, bpm->GetPoolSize());
+  EXPECT_EQ(num_instances, bpm->GetNumInstances());
+
+  page_id_t page_id_temp;
+  auto *page0 = bpm->NewPage(page_id_temp);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, page_id_temp);
+
+  char random_binary_data[PAGE_SIZE];
+  for (char &i : random_binary_data) {
+    i = uniform_dist(rng);
+  }
+  random_binary_data[PAGE_SIZE / 2] = '\0';
+  random_binary_data[PAGE_SIZE - 1] = '\0';
+  std::memcpy(page0->GetData(), random_binary_data, PAGE_SIZE);
+  EXPECT_EQ(0, std::memcmp(page0->GetData(), random_binary_data, PAGE_SIZE));
+
+  // Scenario: consecutive page ids are spread over the instances, so the whole pool can be filled.
+  for (size_t i = 1; i < buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(page_id_temp));
+    EXPECT_EQ(i, page_id_temp);
+  }
+
+  // Scenario: once the pool is full, a failed new page must not leak the page id.
+  for (size_t i = buffer_pool_size; i < buffer_pool_size * 2; ++i) {
+    EXPECT_EQ(nullptr, bpm->NewPage(page_id_temp));
+  }
+  EXPECT_TRUE(bpm->IsPageFree(buffer_pool_size));
+
+  // Scenario: unpinning pages {0, 1, 2, 3, 4} frees one frame in every instance.
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(i, true));
+    EXPECT_TRUE(bpm->FlushPage(i));
+  }
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(page_id_temp));
+    EXPECT_EQ(buffer_pool_size + i, page_id_temp);
+    bpm->UnpinPage(page_id_temp, false);
+  }
+  page0 = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, memcmp(page0->GetData(), random_binary_data, PAGE_SIZE));
+  EXPECT_EQ(true, bpm->UnpinPage(0, true));
+  for (size_t i = 5; i < buffer_pool_size; ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  disk_manager->Close();
+  remove(db_name.c_str());
+
+  delete bpm;
+  delete disk_manager;
+}
+
+/**
+ * Fetch/unpin throughput of a pool with a single latch compared with a sharded pool of the same size. All the pages
+ * are cached, so the numbers only measure buffer pool latch contention.
+ */
+TEST(ParallelBufferPoolManagerTest, ThroughputBenchmark) {
+  const std::string db_name = "parallel_bpm_bench.db";
+  const size_t buffer_pool_size = 1024;
+  const int num_pages = 512;
+  const int ops_per_thread = 50000;
+  const size_t num_threads = std::max(4u, std::thread::hardware_concurrency());
+
+  for (size_t num_instances : {static_cast<size_t>(1), static_cast<size_t>(16)}) {
+    remove(db_name.c_str());
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+    for (int i = 0; i < num_pages; i++) {
+      page_id_t page_id;
+      Page *page = bpm->NewPage(page_id);
+      ASSERT_NE(nullptr, page);
+      memcpy(page->GetData(), &page_id, sizeof(page_id_t));
+      bpm->UnpinPage(page_id, true);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < num_threads; t++) {
+      threads.emplace_back([bpm, t]() {
+        std::default_random_engine rng(t);
+        std::uniform_int_distribution<page_id_t> page_dist(0, num_pages - 1);
+        for (int i = 0; i < ops_per_thread; i++) {
+          page_id_t page_id = page_dist(rng);
+          Page *page = bpm->FetchPage(page_id);
+          ASSERT_NE(nullptr, page);
+          // the frame holds the requested page, not one loaded into it by another thread
+          EXPECT_EQ(page_id, page->GetPageId());
+          EXPECT_EQ(0, memcmp(page->GetData(), &page_id, sizeof(page_id_t)));
+          bpm->UnpinPage(page_id, false);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "instances: " << num_instances << ", threads: " << num_threads
+              << ", fetch/unpin per second: " << static_cast<size_t>(num_threads * ops_per_thread / elapsed)
+              << std::endl;
+    EXPECT_TRUE(bpm->CheckAllUnpinned());
+    // Scenario: no page is lost or corrupted by the concurrent fetches.
+    for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+      Page *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(0, memcmp(page->GetData(), &page_id, sizeof(page_id_t)));
+      bpm->UnpinPage(page_id, false);
+    }
+
+    delete bpm;
+    delete disk_manager;
+    remove(db_name.c_str());
+  }
+}
@@ -0,0 +1,71 @@
+#include "buffer/two_queue_replacer.h"
+
+#include "gtest/gtest.h"
+
+TEST(TwoQueueReplacerTest, SampleTest) {
+  TwoQueueReplacer two_queue_replacer(7);
+
+  // Scenario: unpin six elements, i.e. add them to the replacer. Every frame is seen once.
+  two_queue_replacer.Unpin(1);
+  two_queue_replacer.Unpin(2);
+  two_queue_replacer.Unpin(3);
+  two_queue_replacer.Unpin(4);
+  two_queue_replacer.Unpin(5);
+  two_queue_replacer.Unpin(6);
+  two_queue_replacer.Unpin(1);
+  EXPECT_EQ(6, two_queue_replacer.Size());
+
+  // Scenario: frames seen once are evicted in FIFO order.
+  int value;
+  two_queue_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  two_queue_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  two_queue_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+
+  // Scenario: pin elements in the replacer.
+  // Note that 3 has already been victimized, so pinning 3 should have no effect.
+  two_queue_replacer.Pin(3);
+  two_queue_replacer.Pin(4);
+  EXPECT_EQ(2, two_queue_replacer.Size());
+
+  // Scenario: unpin 4. Pinning does not count as a reference, so 4 keeps its place.
+  two_queue_replacer.Unpin(4);
+  two_queue_replacer.Victim(&value);
+  EXPECT_EQ(4, value);
+  two_queue_replacer.Victim(&value);
+  EXPECT_EQ(5, value);
+  two_queue_replacer.Victim(&value);
+  EXPECT_EQ(6, value);
+  EXPECT_FALSE(two_queue_replacer.Victim(&value));
+}
+
+TEST(TwoQueueReplacerTest, ScanResistanceTest) {
+  // A1 may hold two frames before it is emptied first.
+  TwoQueueReplacer two_queue_replacer(8, 0.25);
+
+  // Scenario: 0 and 1 are hot, 2 and 3 are seen once, 4 to 7 are read by a sequential scan.
+  for (frame_id_t frame_id : {0, 1, 2, 3, 0, 1}) {
+    two_queue_replacer.RecordAccess(frame_id);
+  }
+  for (frame_id_t frame_id = 4; frame_id < 8; frame_id++) {
+    two_queue_replacer.RecordAccess(frame_id, AccessType::SCAN_ACCESS);
+  }
+
+  // Scenario: a scan touching a hot frame does not demote it, a lookup on a scanned frame moves it to A1.
+  two_queue_replacer.RecordAccess(0, AccessType::SCAN_ACCESS);
+  two_queue_replacer.RecordAccess(7);
+  for (frame_id_t frame_id = 0; frame_id < 8; frame_id++) {
+    two_queue_replacer.Unpin(frame_id);
+  }
+  EXPECT_EQ(8, two_queue_replacer.Size());
+
+  // Scenario: scanned frames go first, then A1 down to its share, then the hot frames.
+  int value;
+  for (frame_id_t expected : {4, 5, 6, 2, 0, 1, 3, 7}) {
+    ASSERT_TRUE(two_queue_replacer.Victim(&value));
+    EXPECT_EQ(expected, value);
+  }
+  EXPECT_FALSE(two_queue_replacer.Victim(&value));
+}
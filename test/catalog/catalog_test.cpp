@@ -126,4 +126,100 @@ TEST(CatalogTest, CatalogIndexTest) {
     ASSERT_EQ(rid.Get(), ret_02[i].Get());
   }
   delete db_02;
-}
\ No newline at end of file
+}
+TEST(CatalogTest, IndexOrganizedTableTest) {
+  auto db_01 = new DBStorageEngine(db_file_name, true);
+  auto &catalog_01 = db_01->catalog_mgr_;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, true),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false),
+                                   new Column("account", TypeId::kTypeFloat, 2, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  Txn txn;
+  TableInfo *table_info = nullptr;
+  ASSERT_EQ(DB_COLUMN_NAME_NOT_EXIST,
+            catalog_01->CreateIndexOrganizedTable("iot", schema.get(), "age", "iot_primary", &txn, table_info));
+  ASSERT_EQ(DB_SUCCESS,
+            catalog_01->CreateIndexOrganizedTable("iot", schema.get(), "id", "iot_primary", &txn, table_info));
+  // Scenario: the table has no heap, its rows live in the clustered index, which is not one of its indexes.
+  ASSERT_TRUE(table_info->IsIndexOrganized());
+  ASSERT_EQ(nullptr, table_info->GetTableHeap());
+  ClusteredIndex *clustered_index = table_info->GetClusteredIndex();
+  ASSERT_NE(nullptr, clustered_index);
+  std::vector<IndexInfo *> indexes;
+  catalog_01->GetTableIndexes("iot", indexes);
+  ASSERT_TRUE(indexes.empty());
+  IndexInfo *index_info = nullptr;
+  ASSERT_EQ(DB_FAILED, catalog_01->CreateIndex("iot", "index-1", {"name"}, &txn, index_info, "bptree"));
+  for (int i = 9; i >= 0; i--) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i),
+                              Field(TypeId::kTypeChar, const_cast<char *>("minisql"), 7, true),
+                              Field(TypeId::kTypeFloat, static_cast<float>(i))};
+    ASSERT_EQ(DB_SUCCESS, clustered_index->InsertRow(Row(fields), &txn));
+    ASSERT_EQ(DB_ALREADY_EXIST, clustered_index->InsertRow(Row(fields), &txn));
+  }
+  delete db_01;
+  // Scenario: the table is loaded without a heap and its rows are read back in key order.
+  auto db_02 = new DBStorageEngine(db_file_name, false);
+  auto &catalog_02 = db_02->catalog_mgr_;
+  ASSERT_EQ(DB_SUCCESS, catalog_02->GetTable("iot", table_info));
+  ASSERT_TRUE(table_info->IsIndexOrganized());
+  clustered_index = table_info->GetClusteredIndex();
+  ASSERT_NE(nullptr, clustered_index);
+  int i = 0;
+  RowView view;
+  for (auto iter = clustered_index->GetBeginIterator(); iter != clustered_index->GetEndIterator(); ++iter) {
+    clustered_index->GetRowView((*iter).first, &view);
+    ASSERT_TRUE(view.GetField(0).CompareEquals(Field(TypeId::kTypeInt, i)));
+    ASSERT_TRUE(view.GetField(2).CompareEquals(Field(TypeId::kTypeFloat, static_cast<float>(i))));
+    i++;
+  }
+  ASSERT_EQ(10, i);
+  Row row;
+  ASSERT_EQ(DB_SUCCESS, clustered_index->GetRow(Field(TypeId::kTypeInt, 7), &row));
+  ASSERT_TRUE(row.GetField(1)->CompareEquals(Field(TypeId::kTypeChar, const_cast<char *>("minisql"), 7, false)));
+  ASSERT_EQ(DB_SUCCESS, clustered_index->RemoveRow(row, &txn));
+  ASSERT_EQ(DB_KEY_NOT_FOUND, clustered_index->GetRow(Field(TypeId::kTypeInt, 7), &row));
+  delete db_02;
+}
+
+TEST(CatalogTest, ParallelIndexBuildTest) {
+  auto db_01 = new DBStorageEngine(db_file_name, true);
+  auto &catalog_01 = db_01->catalog_mgr_;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  Txn txn;
+  TableInfo *table_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateTable("table-1", schema.get(), &txn, table_info));
+  // the second half of the rows repeats the keys of the first half, which lie in other page ranges
+  const int row_nums = 20000;
+  std::vector<RowId> rids;
+  for (int i = 0; i < row_nums; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i % (row_nums / 2)),
+                              Field(TypeId::kTypeChar, const_cast<char *>("minisql"), 7, true)};
+    Row row(fields);
+    ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, &txn));
+    rids.push_back(row.GetRowId());
+  }
+  ASSERT_GE(table_info->GetTableHeap()->GetPageDirectory().size(), INDEX_BUILD_MIN_PAGES);
+  // Scenario: the keys of a large table are extracted by several workers, even on a single core.
+  catalog_01->SetIndexBuildWorkers(4);
+  IndexInfo *index_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateIndex("table-1", "index-1", {"id"}, &txn, index_info, "bptree"));
+  // Scenario: every key is found once, pointing to its first row in heap order, whichever range holds the duplicate.
+  auto *index = static_cast<BPlusTreeIndex *>(index_info->GetIndex());
+  int entries = 0;
+  for (auto iter = index->GetBeginIterator(); iter != index->GetEndIterator(); ++iter) {
+    entries++;
+  }
+  ASSERT_EQ(row_nums / 2, entries);
+  for (int i = 0; i < row_nums / 2; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    Row key(fields);
+    std::vector<RowId> ret;
+    ASSERT_EQ(DB_SUCCESS, index->ScanKey(key, ret, &txn));
+    ASSERT_EQ(1, ret.size());
+    ASSERT_EQ(rids[i].Get(), ret[0].Get());
+  }
+  delete db_01;
+}
@@ -1,12 +1,15 @@
 //
 // Created by njz on 2023/1/26.
 //
+#include <numeric>
+
 #include "executor/plans/delete_plan.h"
 #include "executor/plans/insert_plan.h"
 #include "executor/plans/seq_scan_plan.h"
 #include "executor/plans/update_plan.h"
 #include "executor/plans/values_plan.h"
 #include "executor_test_util.h"  // NOLINT
+#include "planner/expressions/logic_expression.h"
 
 // SELECT id FROM table-1 WHERE id < 500
 TEST_F(ExecutorTest, SimpleSeqScanTest) {
@@ -112,6 +115,42 @@ TEST_F(ExecutorTest, SimpleRawInsertTest) {
   ASSERT_TRUE(result_set[0].GetField(2)->CompareEquals(Field(kTypeFloat, static_cast<float>(2.33))));
 }
 
+// INSERT INTO table-1 VALUES (2001, "a", 1.0), (2002, "b", 2.0), (2001, "c", 3.0), (2003, "d", 4.0);
+TEST_F(ExecutorTest, MultiRowInsertTest) {
+  TableInfo *table_info;
+  GetExecutorContext()->GetCatalog()->GetTable("table-1", table_info);
+  IndexInfo *index_info = nullptr;
+  std::vector<std::string> index_keys{"id"};
+  ASSERT_EQ(DB_SUCCESS, GetExecutorContext()->GetCatalog()->CreateIndex("table-1", "index-multi", index_keys, GetTxn(),
+                                                                        index_info, "bptree"));
+  std::vector<std::vector<AbstractExpressionRef>> raw_values;
+  std::vector<int> ids{2001, 2002, 2001, 2003};
+  for (size_t i = 0; i < ids.size(); i++) {
+    char *name = const_cast<char *>(i % 2 == 0 ? "a" : "b");
+    raw_values.push_back({MakeConstantValueExpression(Field(kTypeInt, ids[i])),
+                          MakeConstantValueExpression(Field(kTypeChar, name, 1, false)),
+                          MakeConstantValueExpression(Field(kTypeFloat, static_cast<float>(i)))});
+  }
+  auto value_plan = std::make_shared<ValuesPlanNode>(nullptr, raw_values);
+  auto insert_plan = std::make_shared<InsertPlanNode>(nullptr, value_plan, "table-1");
+
+  // Scenario: the rows before the duplicate key within the batch are inserted and indexed, the rest is not.
+  std::vector<Row> result_set{};
+  GetExecutionEngine()->ExecutePlan(insert_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(2, result_set.size());
+  for (int id : {2001, 2002, 2003}) {
+    std::vector<Field> key_fields{Field(kTypeInt, id)};
+    std::vector<RowId> rids;
+    index_info->GetIndex()->ScanKey(Row(key_fields), rids, GetTxn());
+    ASSERT_EQ(id == 2003 ? 0 : 1, rids.size());
+    if (!rids.empty()) {
+      Row row(rids[0]);
+      ASSERT_TRUE(table_info->GetTableHeap()->GetTuple(&row, GetTxn()));
+      ASSERT_TRUE(row.GetField(0)->CompareEquals(Field(kTypeInt, id)));
+    }
+  }
+}
+
 // UPDATE table-1 SET name = "minisql" where id = 500;
 TEST_F(ExecutorTest, SimpleUpdateTest) {
   // Construct a sequential scan of the table
@@ -155,3 +194,232 @@ TEST_F(ExecutorTest, SimpleUpdateTest) {
     ASSERT_TRUE(row.GetField(1)->CompareEquals(Field(kTypeChar, const_cast<char *>("minisql"), 7, false)));
   }
 }
+
+// SELECT id, name FROM table-1 WHERE id < 10000; DELETE FROM table-1 WHERE id >= 5000; on four scan workers
+TEST_F(ExecutorTest, ParallelSeqScanTest) {
+  TableInfo *table_info;
+  GetExecutorContext()->GetCatalog()->GetTable("table-1", table_info);
+  char characters[32];
+  memset(characters, 'p', sizeof(characters));
+  for (int i = 1000; i < 20000; i++) {
+    Fields fields{Field(kTypeInt, i), Field(kTypeChar, characters, i % 32, true), Field(kTypeFloat, 1.0f)};
+    Row row(fields);
+    ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, nullptr));
+  }
+  ASSERT_GE(table_info->GetTableHeap()->GetPageDirectory().size(), PARALLEL_SCAN_MIN_PAGES);
+  const Schema *schema = table_info->GetSchema();
+  auto col_id = MakeColumnValueExpression(*schema, 0, "id");
+  auto col_name = MakeColumnValueExpression(*schema, 0, "name");
+  auto out_schema = MakeOutputSchema({{"id", col_id}, {"name", col_name}});
+  auto const10000 = MakeConstantValueExpression(Field(kTypeInt, 10000));
+  auto scan_plan = make_shared<SeqScanPlanNode>(
+      out_schema, table_info->GetTableName(), MakeComparisonExpression(col_id, const10000, "<"));
+
+  // Scenario: the workers together produce every matching row exactly once, in any order.
+  GetExecutorContext()->SetScanWorkers(4);
+  std::vector<Row> result_set;
+  ASSERT_EQ(DB_SUCCESS, GetExecutionEngine()->ExecutePlan(scan_plan, &result_set, GetTxn(), GetExecutorContext()));
+  ASSERT_EQ(10000, result_set.size());
+  std::vector<bool> seen(10000, false);
+  for (const auto &row : result_set) {
+    ASSERT_EQ(2, row.GetFieldCount());
+    char buf[sizeof(int32_t)];
+    row.GetField(0)->SerializeTo(buf);
+    int id = MACH_READ_INT32(buf);
+    ASSERT_TRUE(id >= 0 && id < 10000);
+    ASSERT_FALSE(seen[id]);
+    seen[id] = true;
+    if (id >= 1000) {
+      ASSERT_EQ(id % 32, row.GetField(1)->GetLength());
+    }
+  }
+
+  // Scenario: a delete fed by a parallel scan removes every matching row.
+  auto const5000 = MakeConstantValueExpression(Field(kTypeInt, 5000));
+  auto delete_scan_plan = make_shared<SeqScanPlanNode>(schema, table_info->GetTableName(),
+                                                       MakeComparisonExpression(col_id, const5000, ">="));
+  auto delete_plan = std::make_shared<DeletePlanNode>(schema, delete_scan_plan, table_info->GetTableName());
+  ASSERT_EQ(DB_SUCCESS, GetExecutionEngine()->ExecutePlan(delete_plan, nullptr, GetTxn(), GetExecutorContext()));
+  GetExecutorContext()->SetScanWorkers(1);
+  auto all_plan = make_shared<SeqScanPlanNode>(schema, table_info->GetTableName());
+  result_set.clear();
+  ASSERT_EQ(DB_SUCCESS, GetExecutionEngine()->ExecutePlan(all_plan, &result_set, GetTxn(), GetExecutorContext()));
+  ASSERT_EQ(5000, result_set.size());
+  for (const auto &row : result_set) {
+    ASSERT_TRUE(row.GetField(0)->CompareLessThan(Field(kTypeInt, 5000)));
+  }
+}
+
+// UPDATE table-1 SET name = "hhh...", account = 1.0; with indexes on id and on (id, account)
+TEST_F(ExecutorTest, HotUpdateTest) {
+  TableInfo *table_info;
+  GetExecutorContext()->GetCatalog()->GetTable("table-1", table_info);
+  const Schema *schema = table_info->GetSchema();
+  std::vector<IndexInfo *> indexes(2, nullptr);
+  std::vector<std::string> id_keys{"id"};
+  std::vector<std::string> id_account_keys{"id", "account"};
+  auto catalog = GetExecutorContext()->GetCatalog();
+  ASSERT_EQ(DB_SUCCESS, catalog->CreateIndex("table-1", "index-id", id_keys, GetTxn(), indexes[0], "bptree"));
+  ASSERT_EQ(DB_SUCCESS,
+            catalog->CreateIndex("table-1", "index-id-account", id_account_keys, GetTxn(), indexes[1], "bptree"));
+  auto scan_plan = make_shared<SeqScanPlanNode>(schema, table_info->GetTableName());
+  std::vector<Row> before;
+  GetExecutionEngine()->ExecutePlan(scan_plan, &before, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(1000, before.size());
+  auto get_id = [](const Row &row) {
+    char buf[sizeof(int32_t)];
+    row.GetField(0)->SerializeTo(buf);
+    return MACH_READ_INT32(buf);
+  };
+  // every index finds every row at its current rid
+  auto check_indexes = [&](const std::vector<Row> &rows) {
+    for (const auto &row : rows) {
+      for (auto index : indexes) {
+        Row key;
+        row.GetKeyFromRow(schema, index->GetIndexKeySchema(), key);
+        std::vector<RowId> rids;
+        ASSERT_EQ(DB_SUCCESS, index->GetIndex()->ScanKey(key, rids, GetTxn()));
+        ASSERT_EQ(1, rids.size());
+        ASSERT_EQ(row.GetRowId(), rids[0]);
+      }
+    }
+  };
+
+  // Scenario: the longest name does not fit in the pages of most rows, these rows move and are updated only once.
+  char characters[64];
+  memset(characters, 'h', sizeof(characters));
+  std::unordered_map<uint32_t, AbstractExpressionRef> update_attrs{};
+  update_attrs.emplace(1, MakeConstantValueExpression(Field(kTypeChar, characters, 64, true)));
+  update_attrs.emplace(2, MakeConstantValueExpression(Field(kTypeFloat, 1.0f)));
+  auto update_plan = std::make_shared<UpdatePlanNode>(schema, scan_plan, "table-1", update_attrs);
+  std::vector<Row> updated;
+  ASSERT_EQ(DB_SUCCESS, GetExecutionEngine()->ExecutePlan(update_plan, &updated, GetTxn(), GetExecutorContext()));
+  ASSERT_EQ(1000, updated.size());
+  std::vector<Row> after;
+  GetExecutionEngine()->ExecutePlan(scan_plan, &after, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(1000, after.size());
+  size_t moved = 0;
+  for (const auto &row : after) {
+    ASSERT_EQ(64, row.GetField(1)->GetLength());
+    ASSERT_TRUE(row.GetField(2)->CompareEquals(Field(kTypeFloat, 1.0f)));
+    moved += before[get_id(row)].GetRowId() == row.GetRowId() ? 0 : 1;
+  }
+  ASSERT_GT(moved, 0);
+  ASSERT_LT(moved, 1000);
+  check_indexes(after);
+
+  // Scenario: once the rows are as large as they get, an update keeps every rid.
+  std::vector<Row> again;
+  ASSERT_EQ(DB_SUCCESS, GetExecutionEngine()->ExecutePlan(update_plan, &again, GetTxn(), GetExecutorContext()));
+  ASSERT_EQ(1000, again.size());
+  std::vector<Row> last;
+  GetExecutionEngine()->ExecutePlan(scan_plan, &last, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(after.size(), last.size());
+  for (size_t i = 0; i < last.size(); i++) {
+    ASSERT_EQ(after[i].GetRowId(), last[i].GetRowId());
+  }
+  check_indexes(last);
+}
+
+// CREATE TABLE iot(id int, name char(16), account float, primary key(id)) organization index;
+TEST_F(ExecutorTest, IndexOrganizedTableTest) {
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, true),
+                                   new Column("name", TypeId::kTypeChar, 16, 1, true, false),
+                                   new Column("account", TypeId::kTypeFloat, 2, true, false)};
+  Schema table_schema(columns);
+  TableInfo *table_info;
+  ASSERT_EQ(DB_SUCCESS, GetExecutorContext()->GetCatalog()->CreateIndexOrganizedTable(
+                            "iot", &table_schema, "id", "iot_primary", GetTxn(), table_info));
+  const Schema *schema = table_info->GetSchema();
+  auto col_id = MakeColumnValueExpression(*schema, 0, "id");
+  auto col_name = MakeColumnValueExpression(*schema, 0, "name");
+  auto get_id = [](const Row &row) {
+    char buf[sizeof(int32_t)];
+    row.GetField(0)->SerializeTo(buf);
+    return MACH_READ_INT32(buf);
+  };
+  auto scan = [&](const AbstractExpressionRef &predicate) {
+    auto scan_plan = make_shared<SeqScanPlanNode>(schema, "iot", predicate);
+    std::vector<Row> result_set;
+    GetExecutionEngine()->ExecutePlan(scan_plan, &result_set, GetTxn(), GetExecutorContext());
+    std::vector<int> ids;
+    for (const auto &row : result_set) {
+      ids.push_back(get_id(row));
+    }
+    return ids;
+  };
+  auto insert = [&](const std::vector<int> &ids) {
+    std::vector<std::vector<AbstractExpressionRef>> raw_values;
+    for (int id : ids) {
+      std::string name = "name-" + std::to_string(id);
+      raw_values.push_back({MakeConstantValueExpression(Field(kTypeInt, id)),
+                            MakeConstantValueExpression(Field(kTypeChar, name.data(), name.size(), true)),
+                            MakeConstantValueExpression(Field(kTypeFloat, static_cast<float>(id)))});
+    }
+    auto value_plan = std::make_shared<ValuesPlanNode>(nullptr, raw_values);
+    auto insert_plan = std::make_shared<InsertPlanNode>(nullptr, value_plan, "iot");
+    std::vector<Row> result_set;
+    GetExecutionEngine()->ExecutePlan(insert_plan, &result_set, GetTxn(), GetExecutorContext());
+    return result_set.size();
+  };
+  auto compare = [&](const AbstractExpressionRef &column, int value, const std::string &comp_type) {
+    return MakeComparisonExpression(column, MakeConstantValueExpression(Field(kTypeInt, value)), comp_type);
+  };
+
+  // Scenario: rows inserted in any order over several leaves come back in key order, a duplicate key stops the insert.
+  std::vector<int> ids;
+  for (int i = 0; i < 1000; i++) {
+    ids.push_back(i * 7 % 1000);
+  }
+  ASSERT_EQ(1000, insert(ids));
+  ASSERT_EQ(1, insert({1000, 5, 1001}));
+  std::vector<int> all = scan(nullptr);
+  ASSERT_EQ(1001, all.size());
+  for (int i = 0; i <= 1000; i++) {
+    ASSERT_EQ(i, all[i]);
+  }
+
+  // Scenario: comparisons of the key with constants narrow the scan to a key range, other predicates still filter.
+  auto range = std::make_shared<LogicExpression>(compare(col_id, 100, ">="), compare(col_id, 110, "<"), LogicType::And);
+  std::vector<int> expected(10);
+  std::iota(expected.begin(), expected.end(), 100);
+  ASSERT_EQ(expected, scan(range));
+  auto point = std::make_shared<LogicExpression>(compare(col_id, 500, "="), compare(col_id, 400, ">"), LogicType::And);
+  ASSERT_EQ(std::vector<int>{500}, scan(point));
+  auto either = std::make_shared<LogicExpression>(compare(col_id, 3, "<"), compare(col_id, 998, ">"), LogicType::Or);
+  ASSERT_EQ((std::vector<int>{0, 1, 2, 999, 1000}), scan(either));
+  auto name = MakeConstantValueExpression(Field(kTypeChar, const_cast<char *>("name-42"), 7, false));
+  auto by_name = std::make_shared<LogicExpression>(compare(col_id, 50, "<="),
+                                                   MakeComparisonExpression(col_name, name, "="), LogicType::And);
+  ASSERT_EQ(std::vector<int>{42}, scan(by_name));
+  ASSERT_TRUE(scan(compare(col_id, 2000, ">")).empty());
+
+  // Scenario: an update which moves a row onto an existing key is undone, one which moves it to a new key succeeds.
+  auto update = [&](int from, int to) {
+    std::unordered_map<uint32_t, AbstractExpressionRef> update_attrs{};
+    update_attrs.emplace(0, MakeConstantValueExpression(Field(kTypeInt, to)));
+    auto scan_plan = make_shared<SeqScanPlanNode>(schema, "iot", compare(col_id, from, "="));
+    auto update_plan = std::make_shared<UpdatePlanNode>(schema, scan_plan, "iot", update_attrs);
+    std::vector<Row> result_set;
+    GetExecutionEngine()->ExecutePlan(update_plan, &result_set, GetTxn(), GetExecutorContext());
+    return result_set.size();
+  };
+  ASSERT_EQ(0, update(10, 20));
+  ASSERT_EQ(std::vector<int>{10}, scan(compare(col_id, 10, "=")));
+  ASSERT_EQ(1, update(10, 2000));
+  ASSERT_TRUE(scan(compare(col_id, 10, "=")).empty());
+  Row row;
+  ASSERT_EQ(DB_SUCCESS, table_info->GetClusteredIndex()->GetRow(Field(kTypeInt, 2000), &row));
+  ASSERT_TRUE(row.GetField(1)->CompareEquals(Field(kTypeChar, const_cast<char *>("name-10"), 7, false)));
+
+  // Scenario: a delete removes the rows its own scan of the clustered index finds.
+  auto delete_plan = std::make_shared<DeletePlanNode>(
+      nullptr, make_shared<SeqScanPlanNode>(schema, "iot", compare(col_id, 500, "<")), "iot");
+  std::vector<Row> deleted;
+  GetExecutionEngine()->ExecutePlan(delete_plan, &deleted, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(499, deleted.size());
+  all = scan(nullptr);
+  ASSERT_EQ(502, all.size());
+  ASSERT_EQ(500, all.front());
+  ASSERT_EQ(2000, all.back());
+}
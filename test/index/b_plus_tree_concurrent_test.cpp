@@ -0,0 +1,138 @@
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+
+#include "common/instance.h"
+#include "gtest/gtest.h"
+#include "index/b_plus_tree.h"
+#include "utils/utils.h"
+
+static const std::string db_name = "bp_tree_concurrent_test.db";
+
+TEST(BPlusTreeTests, ConcurrentInsertLookupRemoveTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {
+      new Column("int", TypeId::kTypeInt, 0, false, false),
+  };
+  Schema *table_schema = new Schema(columns);
+  KeyManager KP(table_schema, 8);
+  // small pages, so that the threads split and merge pages all the time
+  BPlusTree tree(0, engine.bpm_, KP, 16, 16);
+  const int num_writers = 4;
+  const int num_readers = 2;
+  const int n = 40000;
+  std::vector<GenericKey *> keys;
+  for (int i = 0; i < n; i++) {
+    GenericKey *key = KP.InitKey();
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    KP.SerializeFromKey(key, Row(fields), table_schema);
+    keys.push_back(key);
+  }
+  // each writer owns the keys equal to its number modulo the number of writers, in a random order
+  std::vector<std::vector<int>> writer_keys(num_writers);
+  for (int i = 0; i < n; i++) {
+    writer_keys[i % num_writers].push_back(i);
+  }
+  for (auto &owned : writer_keys) {
+    ShuffleArray(owned);
+  }
+  std::atomic<bool> writing{true};
+  std::atomic<int> mismatches{0};
+  // a reader looks up random keys, a key found must have its own value
+  auto reader = [&](int seed) {
+    std::mt19937 rng(seed);
+    while (writing) {
+      int i = static_cast<int>(rng() % n);
+      std::vector<RowId> result;
+      if (tree.GetValue(keys[i], result) && result[0].Get() != RowId(i).Get()) {
+        mismatches++;
+      }
+    }
+  };
+
+  // Scenario: writers insert disjoint keys while readers look keys up.
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_readers; t++) {
+    threads.emplace_back(reader, t);
+  }
+  std::vector<std::thread> writers;
+  for (int t = 0; t < num_writers; t++) {
+    writers.emplace_back([&, t]() {
+      for (int i : writer_keys[t]) {
+        if (!tree.Insert(keys[i], RowId(i))) {
+          mismatches++;
+        }
+      }
+    });
+  }
+  for (auto &thread : writers) {
+    thread.join();
+  }
+  auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::cout << "concurrent insert: " << num_writers << " writers, " << num_readers << " readers, "
+            << static_cast<int>(n / elapsed) << " inserts/s" << std::endl;
+  writing = false;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  threads.clear();
+  ASSERT_EQ(0, mismatches);
+  ASSERT_TRUE(tree.Check());
+  // every key is in the tree, in order
+  int count = 0;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+    ASSERT_EQ(RowId(count).Get(), (*iter).second.Get());
+    count++;
+  }
+  ASSERT_EQ(n, count);
+
+  // Scenario: writers remove the even keys while readers check that the odd ones stay.
+  writing = true;
+  for (int t = 0; t < num_readers; t++) {
+    threads.emplace_back([&, t]() {
+      std::mt19937 rng(t);
+      while (writing) {
+        int i = static_cast<int>(rng() % n) | 1;
+        std::vector<RowId> result;
+        if (!tree.GetValue(keys[i], result) || result[0].Get() != RowId(i).Get()) {
+          mismatches++;
+        }
+      }
+    });
+  }
+  writers.clear();
+  start = std::chrono::steady_clock::now();
+  for (int t = 0; t < num_writers; t++) {
+    writers.emplace_back([&, t]() {
+      for (int i : writer_keys[t]) {
+        if (i % 2 == 0) {
+          tree.Remove(keys[i]);
+        }
+      }
+    });
+  }
+  for (auto &thread : writers) {
+    thread.join();
+  }
+  elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::cout << "concurrent remove: " << num_writers << " writers, " << num_readers << " readers, "
+            << static_cast<int>(n / 2 / elapsed) << " removes/s" << std::endl;
+  writing = false;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(0, mismatches);
+  ASSERT_TRUE(tree.Check());
+  count = 0;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+    ASSERT_EQ(RowId(2 * count + 1).Get(), (*iter).second.Get());
+    count++;
+  }
+  ASSERT_EQ(n / 2, count);
+  for (auto key : keys) {
+    free(key);
+  }
+  delete table_schema;
+}
@@ -5,6 +5,7 @@
 #include "common/instance.h"
 #include "gtest/gtest.h"
 #include "index/generic_key.h"
+#include "utils/utils.h"
 
 static const std::string db_name = "bp_tree_index_test.db";
 
@@ -27,6 +28,69 @@ TEST(BPlusTreeTests, BPlusTreeIndexGenericKeyTest) {
   ASSERT_EQ(0, KP.CompareKeys(k1, k2));
 }
 
+TEST(BPlusTreeTests, KeyEncodingOrderTest) {
+  std::vector<Column *> columns = {new Column("i", TypeId::kTypeInt, 0, true, false),
+                                   new Column("f", TypeId::kTypeFloat, 1, true, false),
+                                   new Column("c", TypeId::kTypeChar, 8, 2, true, false)};
+  const TableSchema table_schema(columns);
+  std::vector<uint32_t> key_map{0, 1, 2};
+  auto *key_schema = Schema::ShallowCopySchema(&table_schema, key_map);
+  KeyManager KP(key_schema, 64);
+  // compares the encoding only, instead of the 64 bytes of the fixed width
+  KeyManager payload_KP(key_schema, 64, true);
+  std::vector<std::string> strings{"", "a", std::string("a\0", 2), "ab", "abc", "b", "\xff"};
+  std::vector<Row> rows;
+  for (int i : {INT32_MIN, -7, -1, 0, 1, 42, INT32_MAX}) {
+    for (float f : {-1e30f, -2.5f, -0.0f, 0.0f, 1e-30f, 2.5f}) {
+      for (auto &str : strings) {
+        std::vector<Field> fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeFloat, f),
+                                  Field(TypeId::kTypeChar, str.data(), str.size(), true)};
+        rows.emplace_back(fields);
+      }
+    }
+  }
+  std::vector<Field> null_fields{Field(TypeId::kTypeInt), Field(TypeId::kTypeFloat), Field(TypeId::kTypeChar)};
+  rows.emplace_back(null_fields);
+  auto compare_rows = [](const Row &lhs, const Row &rhs) {
+    for (uint32_t i = 0; i < lhs.GetFieldCount(); i++) {
+      Field *l = lhs.GetField(i);
+      Field *r = rhs.GetField(i);
+      if (l->IsNull() || r->IsNull()) {
+        if (l->IsNull() != r->IsNull()) {
+          return l->IsNull() ? -1 : 1;
+        }
+      } else if (l->CompareLessThan(*r) == CmpBool::kTrue) {
+        return -1;
+      } else if (l->CompareGreaterThan(*r) == CmpBool::kTrue) {
+        return 1;
+      }
+    }
+    return 0;
+  };
+  std::vector<GenericKey *> keys;
+  for (auto &row : rows) {
+    keys.push_back(KP.InitKey());
+    KP.SerializeFromKey(keys.back(), row, key_schema);
+  }
+  auto sign = [](int res) { return res < 0 ? -1 : (res > 0 ? 1 : 0); };
+  // Scenario: the bytes of the keys compare like their fields, nulls first, and decode back to the same fields.
+  // Scenario: the fixed-width comparator agrees with the comparison of the encoding alone.
+  for (size_t i = 0; i < rows.size(); i++) {
+    for (size_t j = 0; j < rows.size(); j++) {
+      int expected = compare_rows(rows[i], rows[j]);
+      ASSERT_EQ(expected, sign(KP.CompareKeys(keys[i], keys[j]))) << i << " " << j;
+      ASSERT_EQ(expected, sign(payload_KP.CompareKeys(keys[i], keys[j]))) << i << " " << j;
+    }
+    Row decoded;
+    KP.DeserializeToKey(keys[i], decoded, key_schema);
+    ASSERT_EQ(0, compare_rows(rows[i], decoded));
+  }
+  for (auto key : keys) {
+    free(key);
+  }
+  delete key_schema;
+}
+
 TEST(BPlusTreeTests, BPlusTreeIndexSimpleTest) {
   auto disk_mgr_ = new DiskManager(db_name);
   auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
@@ -80,4 +144,59 @@ TEST(BPlusTreeTests, BPlusTreeIndexSimpleTest) {
   delete bpm_;
   delete disk_mgr_;
 
-}
\ No newline at end of file
+}
+TEST(BPlusTreeTests, BPlusTreeIndexParallelBulkLoadTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 16, 1, true, false)};
+  std::vector<uint32_t> index_key_map{0};
+  const TableSchema table_schema(columns);
+  auto *key_schema = Schema::ShallowCopySchema(&table_schema, index_key_map);
+  BPlusTreeIndex index(0, key_schema, 8, engine.bpm_);
+  const int num_sources = 4;
+  const int n = 20000;
+  // each source reads a range of the keys in a random order, the last one also repeats keys of the first one
+  std::vector<std::vector<int>> source_keys(num_sources);
+  for (int i = 0; i < n; i++) {
+    source_keys[i * num_sources / n].push_back(i);
+  }
+  for (int i = 0; i < n / num_sources; i += 7) {
+    source_keys[num_sources - 1].push_back(i);
+  }
+  for (auto &keys : source_keys) {
+    ShuffleArray(keys);
+  }
+  std::vector<size_t> cursors(num_sources, 0);
+  std::vector<BPlusTreeIndex::EntrySource> sources;
+  for (int s = 0; s < num_sources; s++) {
+    sources.emplace_back([&, s](Row &key, RowId &row_id) {
+      if (cursors[s] == source_keys[s].size()) {
+        return false;
+      }
+      int i = source_keys[s][cursors[s]++];
+      std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+      key = Row(fields);
+      row_id = RowId(i, s == num_sources - 1 && i < n / num_sources ? 1 : 0);
+      return true;
+    });
+  }
+
+  // Scenario: the sources are sorted by a thread each, with spilled runs, and merged into one tree.
+  ASSERT_EQ(DB_SUCCESS, index.BulkLoad(sources, nullptr, 64 * 1024));
+  // the entry of a duplicate key comes from the first source
+  for (int i = 0; i < n; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    std::vector<RowId> ret;
+    ASSERT_EQ(DB_SUCCESS, index.ScanKey(Row(fields), ret, nullptr));
+    ASSERT_EQ(RowId(i, 0).Get(), ret[0].Get());
+  }
+  int count = 0;
+  for (auto iter = index.GetBeginIterator(); iter != index.GetEndIterator(); ++iter) {
+    ASSERT_EQ(count, (*iter).second.GetPageId());
+    count++;
+  }
+  ASSERT_EQ(n, count);
+  // only an empty index is bulk loaded
+  ASSERT_EQ(DB_FAILED, index.BulkLoad(sources, nullptr));
+  delete key_schema;
+}
@@ -3,6 +3,7 @@
 #include "common/instance.h"
 #include "gtest/gtest.h"
 #include "index/comparator.h"
+#include "index/key_sorter.h"
 #include "utils/tree_file_mgr.h"
 #include "utils/utils.h"
 
@@ -69,4 +70,74 @@ TEST(BPlusTreeTests, SampleTest) {
     ASSERT_TRUE(tree.GetValue(delete_seq[i], ans));
     ASSERT_EQ(kv_map[delete_seq[i]], ans[ans.size() - 1]);
   }
-}
\ No newline at end of file
+}
+TEST(BPlusTreeTests, BulkLoadTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {
+      new Column("int", TypeId::kTypeInt, 0, false, false),
+  };
+  Schema *table_schema = new Schema(columns);
+  KeyManager KP(table_schema, 8);
+  index_id_t index_id = 0;
+  // sizes with an underfull last leaf or internal page, which is merged or evened out
+  for (int n : {1, 15, 16, 17, 180, 231, 5000}) {
+    BPlusTree tree(index_id++, engine.bpm_, KP, 16, 16);
+    vector<GenericKey *> keys;
+    vector<int> order;
+    for (int i = 0; i < 2 * n; i++) {
+      GenericKey *key = KP.InitKey();
+      std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+      KP.SerializeFromKey(key, Row(fields), table_schema);
+      keys.push_back(key);
+      order.push_back(i);
+    }
+    ShuffleArray(order);
+
+    // Scenario: the first n keys are added in a random order with duplicates, and sorted in runs of 64 entries.
+    KeySorter sorter(KP, 64 * (KP.GetKeySize() + sizeof(RowId)));
+    for (int i : order) {
+      if (i < n) {
+        sorter.Add(keys[i], RowId(i));
+      }
+    }
+    // a duplicate added later is skipped
+    for (int i = 0; i < n; i += 3) {
+      sorter.Add(keys[i], RowId(2 * n + i));
+    }
+    sorter.Finish();
+    if (n > 64) {
+      ASSERT_LT(0, sorter.GetSpilledRuns());
+    }
+    ASSERT_TRUE(tree.BulkLoad([&sorter](GenericKey *&key, RowId &value) { return sorter.Next(key, value); }));
+    ASSERT_TRUE(tree.Check());
+    int count = 0;
+    for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+      ASSERT_EQ(RowId(count).Get(), (*iter).second.Get());
+      count++;
+    }
+    ASSERT_EQ(n, count);
+    for (int i = 0; i < n; i++) {
+      vector<RowId> result;
+      ASSERT_TRUE(tree.GetValue(keys[i], result));
+      ASSERT_EQ(RowId(i).Get(), result[0].Get());
+    }
+    // only an empty tree is bulk loaded
+    ASSERT_FALSE(tree.BulkLoad([](GenericKey *&, RowId &) { return false; }));
+
+    // Scenario: the loaded tree splits and merges its pages like one built by inserts.
+    for (int i = n; i < 2 * n; i++) {
+      ASSERT_TRUE(tree.Insert(keys[i], RowId(i)));
+    }
+    for (int i : order) {
+      tree.Remove(keys[i]);
+      vector<RowId> result;
+      ASSERT_FALSE(tree.GetValue(keys[i], result));
+    }
+    ASSERT_TRUE(tree.IsEmpty());
+    ASSERT_TRUE(tree.Check());
+    for (auto key : keys) {
+      free(key);
+    }
+  }
+  delete table_schema;
+}
@@ -0,0 +1,32 @@
+#include "page/free_space_map_page.h"
+
+#include "gtest/gtest.h"
+
+TEST(PageTests, FreeSpaceMapPageTest) {
+  char *buf = new char[PAGE_SIZE];
+  memset(buf, 0, PAGE_SIZE);
+  auto *page = reinterpret_cast<FreeSpaceMapPage *>(buf);
+  page->Init();
+  ASSERT_EQ(-1, page->Search(1));
+  // Scenario: fill the page, the table page of slot i has 8 * i bytes left.
+  for (uint32_t i = 0; i < FreeSpaceMapPage::MAX_ENTRIES; i++) {
+    ASSERT_EQ(i, page->Append(i + 1000, 8 * i));
+  }
+  ASSERT_TRUE(page->IsFull());
+  ASSERT_EQ(FreeSpaceMapPage::ToCategory(8 * (FreeSpaceMapPage::MAX_ENTRIES - 1)), page->GetMaxCategory());
+  // Scenario: the first page which surely has enough room is found, free space is rounded to whole categories.
+  ASSERT_EQ(2, page->Search(1));
+  ASSERT_EQ(2, page->Search(16));
+  ASSERT_EQ(4, page->Search(17));
+  ASSERT_EQ(100, page->Search(800));
+  ASSERT_EQ(-1, page->Search(8 * FreeSpaceMapPage::MAX_ENTRIES));
+  // Scenario: updates move the search result both ways.
+  page->Update(50, 4000);
+  ASSERT_EQ(50, page->Search(800));
+  ASSERT_EQ(50, page->Search(4000));
+  ASSERT_EQ(1050, page->GetPageId(50));
+  page->Update(50, 0);
+  ASSERT_EQ(100, page->Search(800));
+  ASSERT_EQ(500, page->Search(4000));
+  delete[] buf;
+}
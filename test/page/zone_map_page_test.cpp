@@ -0,0 +1,68 @@
+#include "page/zone_map_page.h"
+
+#include "common/instance.h"
+#include "gtest/gtest.h"
+#include "planner/expressions/comparison_expression.h"
+#include "planner/expressions/logic_expression.h"
+
+TEST(PageTests, ZoneMapPageTest) {
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false),
+                                   new Column("account", TypeId::kTypeFloat, 2, true, false)};
+  Schema schema(columns);
+  ZoneMapLayout layout(&schema);
+  ASSERT_EQ(2, layout.GetColumnCount());
+  ASSERT_EQ(-1, layout.GetZoneIndex(1));
+  char *buf = new char[PAGE_SIZE];
+  auto *page = reinterpret_cast<ZoneMapPage *>(buf);
+  page->Init();
+  for (uint32_t i = 0; i < ZoneMapPage::GetMaxEntries(layout); i++) {
+    ASSERT_EQ(i, page->Append(layout));
+  }
+  ASSERT_TRUE(page->IsFull(layout));
+
+  // Scenario: the bounds widen with the rows, nulls are left out.
+  ZoneMapEntry zone = page->GetEntry(3, layout);
+  ASSERT_FALSE(zone.HasZone(1));
+  ASSERT_FALSE(zone.HasValues(0));
+  for (int id : {10, 20, 15}) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, id), Field(TypeId::kTypeChar), Field(TypeId::kTypeFloat)};
+    zone.Widen(Row(fields));
+  }
+  ASSERT_TRUE(zone.HasValues(0));
+  ASSERT_FALSE(zone.HasValues(2));
+  ASSERT_EQ(CmpBool::kTrue, zone.GetMin(0).CompareEquals(Field(TypeId::kTypeInt, 10)));
+  ASSERT_EQ(CmpBool::kTrue, zone.GetMax(0).CompareEquals(Field(TypeId::kTypeInt, 20)));
+  ASSERT_FALSE(page->GetEntry(2, layout).HasValues(0));
+
+  // Scenario: predicates on the column are checked against the bounds.
+  auto id = std::make_shared<ColumnValueExpression>(0, 0, TypeId::kTypeInt);
+  auto account = std::make_shared<ColumnValueExpression>(0, 2, TypeId::kTypeFloat);
+  auto constant = [](int value) { return std::make_shared<ConstantValueExpression>(Field(TypeId::kTypeInt, value)); };
+  ASSERT_TRUE(ComparisonExpression(id, constant(10), "=").MayMatch(zone));
+  ASSERT_FALSE(ComparisonExpression(id, constant(21), "=").MayMatch(zone));
+  ASSERT_FALSE(ComparisonExpression(id, constant(10), "<").MayMatch(zone));
+  ASSERT_TRUE(ComparisonExpression(id, constant(10), "<=").MayMatch(zone));
+  ASSERT_FALSE(ComparisonExpression(id, constant(20), ">").MayMatch(zone));
+  ASSERT_TRUE(ComparisonExpression(constant(20), id, "<=").MayMatch(zone));
+  ASSERT_FALSE(ComparisonExpression(constant(20), id, "<").MayMatch(zone));
+  auto in_range = std::make_shared<ComparisonExpression>(id, constant(12), ">");
+  auto out_of_range = std::make_shared<ComparisonExpression>(id, constant(5), "<");
+  ASSERT_FALSE(LogicExpression(in_range, out_of_range, LogicType::And).MayMatch(zone));
+  ASSERT_TRUE(LogicExpression(in_range, out_of_range, LogicType::Or).MayMatch(zone));
+  // the column only has nulls in the page
+  auto value = std::make_shared<ConstantValueExpression>(Field(TypeId::kTypeFloat, 1.0f));
+  ASSERT_FALSE(ComparisonExpression(account, value, ">").MayMatch(zone));
+  ASSERT_TRUE(ComparisonExpression(account, value, "is").MayMatch(zone));
+
+  // Scenario: zone maps merge, and an empty zone map matches no comparison.
+  ZoneMapEntry other = page->GetEntry(4, layout);
+  std::vector<Field> fields{Field(TypeId::kTypeInt, -5), Field(TypeId::kTypeChar), Field(TypeId::kTypeFloat, 2.5f)};
+  other.Widen(Row(fields));
+  zone.Widen(other);
+  ASSERT_EQ(CmpBool::kTrue, zone.GetMin(0).CompareEquals(Field(TypeId::kTypeInt, -5)));
+  ASSERT_EQ(CmpBool::kTrue, zone.GetMax(2).CompareEquals(Field(TypeId::kTypeFloat, 2.5f)));
+  zone.Clear();
+  ASSERT_FALSE(ComparisonExpression(id, constant(0), "<>").MayMatch(zone));
+  delete[] buf;
+}
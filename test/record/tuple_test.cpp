@@ -5,6 +5,7 @@
 #include "page/table_page.h"
 #include "record/field.h"
 #include "record/row.h"
+#include "record/row_view.h"
 #include "record/schema.h"
 
 char *chars[] = {const_cast<char *>(""), const_cast<char *>("hello"), const_cast<char *>("world!"),
@@ -193,4 +194,100 @@ TEST(TupleTest, RowTest) {
   }
   ASSERT_TRUE(table_page.MarkDelete(row.GetRowId(), nullptr, nullptr, nullptr));
   table_page.ApplyDelete(row.GetRowId(), nullptr, nullptr);
-}
\ No newline at end of file
+}
+TEST(TupleTest, RowViewTest) {
+  TablePage table_page;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false),
+                                   new Column("nick", TypeId::kTypeChar, 64, 2, true, false),
+                                   new Column("account", TypeId::kTypeFloat, 3, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  // Scenario: a null char column in the middle must not shift the offsets of the columns after it.
+  std::vector<Field> fields = {Field(TypeId::kTypeInt, 188), Field(TypeId::kTypeChar),
+                               Field(TypeId::kTypeChar, const_cast<char *>("minisql"), strlen("minisql"), false),
+                               Field(TypeId::kTypeFloat, 19.99f)};
+  Row row(fields);
+  table_page.Init(0, INVALID_PAGE_ID, nullptr, nullptr);
+  ASSERT_TRUE(table_page.InsertTuple(row, schema.get(), nullptr, nullptr, nullptr));
+  RowView view;
+  ASSERT_TRUE(table_page.GetTupleView(row.GetRowId(), schema.get(), &view));
+  ASSERT_EQ(row.GetRowId(), view.GetRowId());
+  ASSERT_EQ(4, view.GetFieldCount());
+  ASSERT_FALSE(view.IsNull(0));
+  ASSERT_TRUE(view.IsNull(1));
+  // fields are decoded out of order, the char field points into the page
+  Field account = view.GetField(3);
+  ASSERT_EQ(CmpBool::kTrue, account.CompareEquals(fields[3]));
+  Field nick = view.GetField(2);
+  ASSERT_EQ(CmpBool::kTrue, nick.CompareEquals(fields[2]));
+  ASSERT_GE(nick.GetData(), table_page.GetData());
+  ASSERT_LT(nick.GetData(), table_page.GetData() + PAGE_SIZE);
+  ASSERT_TRUE(view.GetField(1).IsNull());
+  ASSERT_EQ(CmpBool::kTrue, view.GetField(0).CompareEquals(fields[0]));
+  // Scenario: the copy of the row owns its fields and keeps only the projected columns.
+  Row copy;
+  view.ToRow(&copy);
+  ASSERT_EQ(4, copy.GetFieldCount());
+  for (uint32_t i = 0; i < fields.size(); i++) {
+    ASSERT_EQ(fields[i].IsNull(), copy.GetField(i)->IsNull());
+    if (!fields[i].IsNull()) {
+      ASSERT_EQ(CmpBool::kTrue, copy.GetField(i)->CompareEquals(fields[i]));
+    }
+  }
+  std::unique_ptr<Schema> projection(Schema::ShallowCopySchema(schema.get(), {3, 2}));
+  Row projected;
+  view.ToRow(&projected, projection.get());
+  ASSERT_EQ(row.GetRowId(), projected.GetRowId());
+  ASSERT_EQ(2, projected.GetFieldCount());
+  ASSERT_EQ(CmpBool::kTrue, projected.GetField(0)->CompareEquals(fields[3]));
+  ASSERT_EQ(CmpBool::kTrue, projected.GetField(1)->CompareEquals(fields[2]));
+  // Scenario: a deleted tuple has no view.
+  ASSERT_TRUE(table_page.MarkDelete(row.GetRowId(), nullptr, nullptr, nullptr));
+  ASSERT_FALSE(table_page.GetTupleView(row.GetRowId(), schema.get(), &view));
+  table_page.ApplyDelete(row.GetRowId(), nullptr, nullptr);
+}
+
+TEST(TupleTest, TablePageCompactTest) {
+  TablePage table_page;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  char characters[64];
+  memset(characters, 'x', sizeof(characters));
+  auto make_row = [&](int id) {
+    std::vector<Field> fields = {Field(TypeId::kTypeInt, id), Field(TypeId::kTypeChar, characters, 64, false)};
+    return Row(fields);
+  };
+  table_page.Init(0, INVALID_PAGE_ID, nullptr, nullptr);
+  std::vector<RowId> rids;
+  for (Row row = make_row(0); table_page.InsertTuple(row, schema.get(), nullptr, nullptr, nullptr);
+       row = make_row(static_cast<int>(rids.size()))) {
+    rids.push_back(row.GetRowId());
+  }
+  ASSERT_GT(rids.size(), 2);
+  // Scenario: the tuples marked as deleted are dropped, the others keep their rids and their values.
+  uint32_t deleted = 0;
+  for (size_t i = 0; i < rids.size(); i += 2, deleted++) {
+    ASSERT_TRUE(table_page.MarkDelete(rids[i], nullptr, nullptr, nullptr));
+  }
+  uint32_t free_space = table_page.GetFreeSpaceRemaining();
+  ASSERT_EQ(rids.size() - deleted, table_page.Compact(nullptr, nullptr));
+  ASSERT_GT(table_page.GetFreeSpaceRemaining(), free_space);
+  for (size_t i = 0; i < rids.size(); i++) {
+    Row row(rids[i]);
+    ASSERT_EQ(i % 2 == 1, table_page.GetTuple(&row, schema.get(), nullptr, nullptr));
+    if (i % 2 == 1) {
+      ASSERT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, static_cast<int>(i))));
+    }
+  }
+  // Scenario: the free slots are reused, so the page takes as many tuples again as were dropped.
+  Row row = make_row(-1);
+  ASSERT_TRUE(table_page.InsertTuple(row, schema.get(), nullptr, nullptr, nullptr));
+  ASSERT_EQ(rids[0], row.GetRowId());
+  for (uint32_t i = 1; i < deleted; i++) {
+    row = make_row(-1);
+    ASSERT_TRUE(table_page.InsertTuple(row, schema.get(), nullptr, nullptr, nullptr));
+  }
+  row = make_row(-1);
+  ASSERT_FALSE(table_page.InsertTuple(row, schema.get(), nullptr, nullptr, nullptr));
+}
@@ -1,6 +1,8 @@
 #include "storage/disk_manager.h"
 
+#include <thread>
 #include <unordered_set>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -56,4 +58,192 @@ TEST(DiskManagerTest, FreePageAllocationTest) {
   EXPECT_EQ(extent_nums * DiskManager::BITMAP_SIZE - 5, meta_page->GetAllocatedPages());
   EXPECT_EQ(DiskManager::BITMAP_SIZE - 2, meta_page->GetExtentUsedPage(0));
   EXPECT_EQ(DiskManager::BITMAP_SIZE - 3, meta_page->GetExtentUsedPage(1));
-}
\ No newline at end of file
+}
+
+TEST(DiskManagerTest, BitmapWritebackTest) {
+  std::string db_name = "disk_test.db";
+  remove(db_name.c_str());
+  DiskManager *disk_mgr = new DiskManager(db_name);
+  for (uint32_t i = 0; i < DiskManager::BITMAP_SIZE + 10; i++) {
+    ASSERT_EQ(i, disk_mgr->AllocatePage());
+  }
+  disk_mgr->DeAllocatePage(3);
+  disk_mgr->DeAllocatePage(DiskManager::BITMAP_SIZE + 4);
+  disk_mgr->Close();
+  delete disk_mgr;
+
+  // Scenario: the bitmaps cached in memory are written back on close and read again on open.
+  disk_mgr = new DiskManager(db_name);
+  EXPECT_TRUE(disk_mgr->IsPageFree(3));
+  EXPECT_FALSE(disk_mgr->IsPageFree(4));
+  EXPECT_TRUE(disk_mgr->IsPageFree(DiskManager::BITMAP_SIZE + 4));
+  EXPECT_TRUE(disk_mgr->IsPageFree(DiskManager::BITMAP_SIZE + 10));
+  // Scenario: the first free page of the first extent with room is handed out first.
+  EXPECT_EQ(3, disk_mgr->AllocatePage());
+  EXPECT_EQ(DiskManager::BITMAP_SIZE + 4, disk_mgr->AllocatePage());
+  EXPECT_EQ(DiskManager::BITMAP_SIZE + 10, disk_mgr->AllocatePage());
+  disk_mgr->Close();
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, ConcurrentPageIOTest) {
+  std::string db_name = "disk_io_test.db";
+  const int num_threads = 4;
+  const int pages_per_thread = 64;
+  remove(db_name.c_str());
+  DiskManager *disk_mgr = new DiskManager(db_name);
+
+  // Scenario: reading past the end of the file returns a zeroed page.
+  char buf[PAGE_SIZE];
+  memset(buf, 1, PAGE_SIZE);
+  disk_mgr->ReadPage(0, buf);
+  for (char c : buf) {
+    ASSERT_EQ(0, c);
+  }
+
+  // Scenario: threads write and read back interleaved pages at the same time, extending the file concurrently.
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([disk_mgr, t]() {
+      char data[PAGE_SIZE];
+      char read_back[PAGE_SIZE];
+      for (int i = 0; i < pages_per_thread; i++) {
+        page_id_t page_id = i * num_threads + t;
+        memset(data, page_id % 128, PAGE_SIZE);
+        disk_mgr->WritePage(page_id, data);
+        disk_mgr->ReadPage(page_id, read_back);
+        ASSERT_EQ(0, memcmp(data, read_back, PAGE_SIZE));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Scenario: every page survives closing and reopening the file.
+  disk_mgr->Sync();
+  delete disk_mgr;
+  disk_mgr = new DiskManager(db_name);
+  for (page_id_t page_id = 0; page_id < num_threads * pages_per_thread; page_id++) {
+    disk_mgr->ReadPage(page_id, buf);
+    ASSERT_EQ(page_id % 128, buf[0]);
+    ASSERT_EQ(page_id % 128, buf[PAGE_SIZE - 1]);
+  }
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, AsyncPageIOTest) {
+  std::string db_name = "disk_async_test.db";
+  const int num_pages = 128;
+  for (bool use_io_uring : {true, false}) {
+    remove(db_name.c_str());
+    DiskManager *disk_mgr = new DiskManager(db_name, use_io_uring);
+    if (!use_io_uring) {
+      EXPECT_FALSE(disk_mgr->IsAsyncIOEnabled());
+    }
+
+    // Scenario: queue more writes than the queue depth, then wait for all of them.
+    std::vector<std::vector<char>> data(num_pages, std::vector<char>(PAGE_SIZE));
+    std::vector<IOHandle> handles;
+    for (int i = 0; i < num_pages; i++) {
+      memset(data[i].data(), i, PAGE_SIZE);
+      handles.push_back(disk_mgr->WritePageAsync(i, data[i].data()));
+    }
+    for (auto &handle : handles) {
+      EXPECT_TRUE(handle.Wait());
+      EXPECT_TRUE(handle.IsDone());
+    }
+
+    // Scenario: read everything back asynchronously, plus one page past the end of file which reads as zeros.
+    std::vector<std::vector<char>> read_back(num_pages + 1, std::vector<char>(PAGE_SIZE, 1));
+    handles.clear();
+    for (int i = 0; i <= num_pages; i++) {
+      handles.push_back(disk_mgr->ReadPageAsync(i, read_back[i].data()));
+    }
+    for (int i = 0; i <= num_pages; i++) {
+      EXPECT_TRUE(handles[i].Wait());
+      if (i < num_pages) {
+        EXPECT_EQ(0, memcmp(data[i].data(), read_back[i].data(), PAGE_SIZE));
+      } else {
+        EXPECT_EQ(std::vector<char>(PAGE_SIZE, 0), read_back[i]);
+      }
+    }
+    delete disk_mgr;
+  }
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, TablespaceTest) {
+  std::vector<std::string> data_files = {"tablespace_test.db", "tablespace_test.db.1", "tablespace_test.db.2"};
+  for (const auto &file_name : data_files) {
+    remove(file_name.c_str());
+  }
+  DiskManager *disk_mgr = new DiskManager(data_files);
+  ASSERT_EQ(3, disk_mgr->GetDataFileNums());
+
+  // Scenario: extents are spread over the data files round robin.
+  const uint32_t num_pages = 4 * DiskManager::BITMAP_SIZE + 10;
+  for (uint32_t i = 0; i < num_pages; i++) {
+    ASSERT_EQ(i, disk_mgr->AllocatePage());
+  }
+  EXPECT_EQ(0, disk_mgr->GetDataFileId(0));
+  EXPECT_EQ(1, disk_mgr->GetDataFileId(DiskManager::BITMAP_SIZE));
+  EXPECT_EQ(2, disk_mgr->GetDataFileId(2 * DiskManager::BITMAP_SIZE + 7));
+  EXPECT_EQ(0, disk_mgr->GetDataFileId(3 * DiskManager::BITMAP_SIZE));
+  auto *first_meta = reinterpret_cast<DiskFileMetaPage *>(disk_mgr->GetMetaData(0));
+  auto *second_meta = reinterpret_cast<DiskFileMetaPage *>(disk_mgr->GetMetaData(1));
+  EXPECT_EQ(2, first_meta->GetExtentNums());
+  EXPECT_EQ(2 * DiskManager::BITMAP_SIZE, first_meta->GetAllocatedPages());
+  EXPECT_EQ(DiskManager::BITMAP_SIZE + 10, second_meta->GetAllocatedPages());
+  EXPECT_EQ(3, first_meta->GetDataFileNums());
+
+  // Scenario: pages of different files do not overwrite each other.
+  char data[PAGE_SIZE];
+  std::vector<page_id_t> page_ids = {0, 5, static_cast<page_id_t>(DiskManager::BITMAP_SIZE) + 5,
+                                     static_cast<page_id_t>(3 * DiskManager::BITMAP_SIZE) + 5};
+  for (page_id_t page_id : page_ids) {
+    memset(data, page_id % 127 + 1, PAGE_SIZE);
+    disk_mgr->WritePage(page_id, data);
+  }
+  disk_mgr->DeAllocatePage(DiskManager::BITMAP_SIZE + 3);
+  delete disk_mgr;
+
+  // Scenario: a tablespace cannot be opened with another number of data files.
+  EXPECT_THROW(DiskManager(std::vector<std::string>(data_files.begin(), data_files.begin() + 2)), std::exception);
+
+  // Scenario: pages and free space survive reopening the tablespace.
+  disk_mgr = new DiskManager(data_files);
+  for (page_id_t page_id : page_ids) {
+    disk_mgr->ReadPage(page_id, data);
+    ASSERT_EQ(page_id % 127 + 1, data[0]);
+    ASSERT_EQ(page_id % 127 + 1, data[PAGE_SIZE - 1]);
+  }
+  EXPECT_TRUE(disk_mgr->IsPageFree(DiskManager::BITMAP_SIZE + 3));
+  EXPECT_EQ(DiskManager::BITMAP_SIZE + 3, disk_mgr->AllocatePage());
+  delete disk_mgr;
+  for (const auto &file_name : data_files) {
+    remove(file_name.c_str());
+  }
+}
+
+TEST(DiskManagerTest, LargeOffsetTest) {
+  std::string db_name = "disk_large_test.db";
+  remove(db_name.c_str());
+  DiskManager *disk_mgr = new DiskManager(db_name);
+
+  // Scenario: a page more than 4 GB into the file is written and read back, the file is sparse.
+  const page_id_t page_id = 1200000;
+  char data[PAGE_SIZE];
+  memset(data, 42, PAGE_SIZE);
+  disk_mgr->WritePage(page_id, data);
+  delete disk_mgr;
+  disk_mgr = new DiskManager(db_name);
+  memset(data, 0, PAGE_SIZE);
+  disk_mgr->ReadPage(page_id, data);
+  EXPECT_EQ(42, data[0]);
+  EXPECT_EQ(42, data[PAGE_SIZE - 1]);
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
@@ -1,10 +1,12 @@
 #include "storage/table_heap.h"
 
+#include <algorithm>
 #include <unordered_map>
 #include <vector>
 
 #include "common/instance.h"
 #include "gtest/gtest.h"
+#include "planner/expressions/comparison_expression.h"
 #include "record/field.h"
 #include "record/schema.h"
 #include "utils/utils.h"
@@ -61,3 +63,414 @@ TEST(TableHeapTest, TableHeapSampleTest) {
   }
   ASSERT_EQ(size, 0);
 }
+
+TEST(TableHeapTest, FreeSpaceMapTest) {
+  remove(db_file_name.c_str());
+  auto disk_mgr_ = new DiskManager(db_file_name);
+  auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  const int row_nums = 2000;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  char characters[64];
+  memset(characters, 'a', sizeof(characters));
+  TableHeap *table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr);
+  std::vector<RowId> rids;
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, 64, true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    rids.push_back(row.GetRowId());
+  }
+  // Scenario: the rows are appended in order, every page but the last one is full.
+  ASSERT_EQ(table_heap->GetFirstPageId(), rids.front().GetPageId());
+  ASSERT_NE(rids.front().GetPageId(), rids.back().GetPageId());
+
+  // Scenario: after a row of the first page is deleted, the next insert reuses its room instead of the last page.
+  ASSERT_TRUE(table_heap->MarkDelete(rids[3], nullptr));
+  table_heap->ApplyDelete(rids[3], nullptr);
+  Fields fields{Field(TypeId::kTypeInt, row_nums), Field(TypeId::kTypeChar, characters, 64, true)};
+  Row row(fields);
+  ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+  ASSERT_EQ(rids[3].GetPageId(), row.GetRowId().GetPageId());
+
+  // Scenario: the map is persistent, a heap opened again finds the same room and extends the same page chain.
+  ASSERT_TRUE(table_heap->MarkDelete(rids[5], nullptr));
+  table_heap->ApplyDelete(rids[5], nullptr);
+  TableHeap *reopened = TableHeap::Create(bpm_, table_heap->GetFirstPageId(), table_heap->GetFreeSpaceMapPageId(),
+                                          table_heap->GetZoneMapPageId(), schema.get(), nullptr, nullptr);
+  ASSERT_TRUE(reopened->InsertTuple(row, nullptr));
+  ASSERT_EQ(rids[5].GetPageId(), row.GetRowId().GetPageId());
+  ASSERT_TRUE(reopened->InsertTuple(row, nullptr));
+  ASSERT_EQ(rids.back().GetPageId(), row.GetRowId().GetPageId());
+  int count = 0;
+  for (page_id_t page_id = reopened->GetFirstPageId(); page_id != INVALID_PAGE_ID; count++) {
+    auto page = reinterpret_cast<TablePage *>(bpm_->FetchPage(page_id));
+    page_id_t next_page_id = page->GetNextPageId();
+    bpm_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  ASSERT_EQ(rids.back().GetPageId(), row.GetRowId().GetPageId());
+  ASSERT_GT(count, 1);
+  delete reopened;
+  delete table_heap;
+  delete bpm_;
+  delete disk_mgr_;
+  remove(db_file_name.c_str());
+}
+
+TEST(TableHeapTest, InsertBatchTest) {
+  remove(db_file_name.c_str());
+  auto disk_mgr_ = new DiskManager(db_file_name);
+  auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  const int row_nums = 5000;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  char characters[64];
+  memset(characters, 'b', sizeof(characters));
+  TableHeap *table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr);
+  Fields first_fields{Field(TypeId::kTypeInt, -1), Field(TypeId::kTypeChar, characters, 64, true)};
+  Row first_row(first_fields);
+  ASSERT_TRUE(table_heap->InsertTuple(first_row, nullptr));
+
+  // Scenario: a batch continues on the last page and assigns increasing rids in the order of the rows.
+  std::vector<Row> rows;
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, RandomUtils::RandomInt(1, 64), true)};
+    rows.emplace_back(fields);
+  }
+  ASSERT_EQ(row_nums, table_heap->InsertBatch(rows, nullptr));
+  ASSERT_EQ(first_row.GetRowId().GetPageId(), rows.front().GetRowId().GetPageId());
+  ASSERT_EQ(1, rows.front().GetRowId().GetSlotNum());
+  for (int i = 1; i < row_nums; i++) {
+    const RowId &prev = rows[i - 1].GetRowId();
+    const RowId &cur = rows[i].GetRowId();
+    ASSERT_TRUE(cur.GetPageId() != prev.GetPageId() || cur.GetSlotNum() == prev.GetSlotNum() + 1);
+  }
+
+  // Scenario: every row is read back and the pages follow each other in the page list.
+  std::vector<page_id_t> pages;
+  for (int i = 0; i < row_nums; i++) {
+    Row row(rows[i].GetRowId());
+    ASSERT_TRUE(table_heap->GetTuple(&row, nullptr));
+    ASSERT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, i)));
+    if (pages.empty() || pages.back() != rows[i].GetRowId().GetPageId()) {
+      pages.push_back(rows[i].GetRowId().GetPageId());
+    }
+  }
+  for (size_t i = 0; i + 1 < pages.size(); i++) {
+    auto page = reinterpret_cast<TablePage *>(bpm_->FetchPage(pages[i]));
+    ASSERT_EQ(pages[i + 1], page->GetNextPageId());
+    bpm_->UnpinPage(pages[i], false);
+  }
+
+  // Scenario: a single insert afterwards lands on the last page of the batch, which still has room.
+  ASSERT_TRUE(table_heap->InsertTuple(first_row, nullptr));
+  ASSERT_EQ(pages.back(), first_row.GetRowId().GetPageId());
+  delete table_heap;
+  delete bpm_;
+  delete disk_mgr_;
+  remove(db_file_name.c_str());
+}
+
+TEST(TableHeapTest, TableIteratorTest) {
+  remove(db_file_name.c_str());
+  auto disk_mgr_ = new DiskManager(db_file_name);
+  auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  const int row_nums = 3000;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  char characters[64];
+  memset(characters, 'c', sizeof(characters));
+  TableHeap *table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr);
+  std::vector<RowId> rids;
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, 64, true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    rids.push_back(row.GetRowId());
+  }
+  // Scenario: the first page is emptied and every other row is deleted, the scan skips them and crosses pages.
+  int deleted = 0;
+  for (int i = 0; i < row_nums; i++) {
+    if (rids[i].GetPageId() == table_heap->GetFirstPageId() || i % 2 == 1) {
+      ASSERT_TRUE(table_heap->MarkDelete(rids[i], nullptr));
+      table_heap->ApplyDelete(rids[i], nullptr);
+      deleted++;
+    }
+  }
+  {
+    int expected = 0;
+    for (auto itr = table_heap->Begin(nullptr); itr != table_heap->End(); ++itr) {
+      while (rids[expected].GetPageId() == table_heap->GetFirstPageId() || expected % 2 == 1) {
+        expected++;
+      }
+      ASSERT_EQ(rids[expected], itr->GetRowId());
+      ASSERT_EQ(CmpBool::kTrue, (*itr).GetField(0)->CompareEquals(Field(TypeId::kTypeInt, expected)));
+      expected++;
+    }
+  }
+  // Scenario: the tuples rejected by SkipUntil are never copied out, and the iterator stops at the accepted one.
+  {
+    auto itr = table_heap->Begin(nullptr);
+    int visited = 0;
+    ASSERT_TRUE(itr.SkipUntil([&](const RowView &view) {
+      visited++;
+      return view.GetField(0).CompareEquals(Field(TypeId::kTypeInt, row_nums - 2)) == CmpBool::kTrue;
+    }));
+    ASSERT_EQ(row_nums - deleted, visited);
+    ASSERT_EQ(rids[row_nums - 2], itr->GetRowId());
+    ++itr;
+    ASSERT_FALSE(itr.SkipUntil([](const RowView &) { return true; }));
+    ASSERT_TRUE(itr == table_heap->End());
+  }
+  // Scenario: no page is left pinned once the iterators are gone.
+  ASSERT_TRUE(bpm_->CheckAllUnpinned());
+  delete table_heap;
+  delete bpm_;
+  delete disk_mgr_;
+  remove(db_file_name.c_str());
+}
+
+TEST(TableHeapTest, ZoneMapTest) {
+  remove(db_file_name.c_str());
+  auto disk_mgr_ = new DiskManager(db_file_name);
+  auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  const int row_nums = 3000;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  char characters[64];
+  memset(characters, 'z', sizeof(characters));
+  TableHeap *table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr);
+  std::vector<RowId> rids;
+  for (int i = 0; i < row_nums / 2; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, 64, true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    rids.push_back(row.GetRowId());
+  }
+  std::vector<Row> rows;
+  for (int i = row_nums / 2; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, 64, true)};
+    rows.emplace_back(fields);
+  }
+  ASSERT_EQ(rows.size(), table_heap->InsertBatch(rows, nullptr));
+  for (auto &row : rows) {
+    rids.push_back(row.GetRowId());
+  }
+  auto id = std::make_shared<ColumnValueExpression>(0, 0, TypeId::kTypeInt);
+  auto less_than = [&](int value) {
+    return ComparisonExpression(id, std::make_shared<ConstantValueExpression>(Field(TypeId::kTypeInt, value)), "<");
+  };
+
+  // Scenario: the ids grow with the pages, only the pages holding small ids may match a small upper bound, whether
+  // the rows were inserted one by one or in a batch.
+  for (int bound : {100, row_nums - 100}) {
+    auto predicate = less_than(bound);
+    std::vector<bool> may_match;
+    auto pages =
+        table_heap->GetPageDirectory([&](const ZoneMapEntry &zone) { return predicate.MayMatch(zone); }, &may_match);
+    ASSERT_EQ(pages.size(), may_match.size());
+    for (size_t i = 0; i < pages.size(); i++) {
+      bool has_match = false;
+      for (int j = 0; j < bound; j++) {
+        has_match |= rids[j].GetPageId() == pages[i];
+      }
+      ASSERT_EQ(has_match, may_match[i]);
+    }
+  }
+
+  // Scenario: once its tuples are deleted, a page matches nothing, and the zone maps survive a reopen.
+  page_id_t first_page_id = table_heap->GetFirstPageId();
+  for (int i = 0; i < row_nums && rids[i].GetPageId() == first_page_id; i++) {
+    ASSERT_TRUE(table_heap->MarkDelete(rids[i], nullptr));
+    table_heap->ApplyDelete(rids[i], nullptr);
+  }
+  TableHeap *reopened = TableHeap::Create(bpm_, first_page_id, table_heap->GetFreeSpaceMapPageId(),
+                                          table_heap->GetZoneMapPageId(), schema.get(), nullptr, nullptr);
+  auto predicate = less_than(row_nums);
+  std::vector<bool> may_match;
+  auto pages =
+      reopened->GetPageDirectory([&](const ZoneMapEntry &zone) { return predicate.MayMatch(zone); }, &may_match);
+  ASSERT_EQ(first_page_id, pages[0]);
+  ASSERT_FALSE(may_match[0]);
+  ASSERT_TRUE(may_match[1]);
+  delete reopened;
+  delete table_heap;
+  delete bpm_;
+  delete disk_mgr_;
+  remove(db_file_name.c_str());
+}
+
+TEST(TableHeapTest, VacuumTest) {
+  remove(db_file_name.c_str());
+  auto disk_mgr_ = new DiskManager(db_file_name);
+  auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  const int row_nums = 3000;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  char characters[64];
+  memset(characters, 'v', sizeof(characters));
+  TableHeap *table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr);
+  std::unordered_map<int, RowId> rids;
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, 64, true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    rids[i] = row.GetRowId();
+  }
+  // the deletes are only marked, as a delete statement does
+  for (int i = 0; i < row_nums; i++) {
+    if (i % 4 != 0) {
+      ASSERT_TRUE(table_heap->MarkDelete(rids[i], nullptr));
+    }
+  }
+  auto pages = table_heap->GetPageDirectory();
+
+  // Scenario: the kept tuples are packed into the first pages, the pages emptied are returned to the disk manager and
+  // every moved tuple is reported with its old rid.
+  std::unordered_map<RowId, RowId> moves;
+  size_t freed = table_heap->Vacuum(nullptr, [&](const Row &row, const RowId &old_rid) {
+    ASSERT_EQ(0, moves.count(old_rid));
+    moves[old_rid] = row.GetRowId();
+  });
+  auto kept_pages = table_heap->GetPageDirectory();
+  ASSERT_GT(freed, 0);
+  ASSERT_EQ(pages.size(), kept_pages.size() + freed);
+  ASSERT_LE(kept_pages.size() * 3, pages.size());
+  ASSERT_EQ(table_heap->GetFirstPageId(), kept_pages[0]);
+  for (auto page_id : pages) {
+    bool kept = std::find(kept_pages.begin(), kept_pages.end(), page_id) != kept_pages.end();
+    ASSERT_EQ(!kept, bpm_->IsPageFree(page_id));
+  }
+  ASSERT_TRUE(bpm_->CheckAllUnpinned());
+
+  // Scenario: the relinked list holds exactly the kept tuples, at their new rids, in the order of the directory.
+  int count = 0;
+  size_t position = 0;
+  for (auto itr = table_heap->Begin(nullptr); itr != table_heap->End(); ++itr, count++) {
+    int32_t id;
+    char buffer[sizeof(int32_t)];
+    itr->GetField(0)->SerializeTo(buffer);
+    id = MACH_READ_INT32(buffer);
+    ASSERT_EQ(0, id % 4);
+    RowId rid = moves.count(rids[id]) ? moves[rids[id]] : rids[id];
+    ASSERT_EQ(rid, itr->GetRowId());
+    while (kept_pages[position] != rid.GetPageId()) {
+      ASSERT_LT(++position, kept_pages.size());
+    }
+  }
+  ASSERT_EQ(row_nums / 4, count);
+
+  // Scenario: the free space map is rebuilt, the room left is used again before the table grows.
+  Fields fields{Field(TypeId::kTypeInt, row_nums), Field(TypeId::kTypeChar, characters, 64, true)};
+  Row row(fields);
+  ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+  ASSERT_EQ(kept_pages.size(), table_heap->GetPageDirectory().size());
+  TableHeap *reopened = TableHeap::Create(bpm_, table_heap->GetFirstPageId(), table_heap->GetFreeSpaceMapPageId(),
+                                          table_heap->GetZoneMapPageId(), schema.get(), nullptr, nullptr);
+  ASSERT_EQ(kept_pages, reopened->GetPageDirectory());
+  delete reopened;
+  delete table_heap;
+  delete bpm_;
+  delete disk_mgr_;
+  remove(db_file_name.c_str());
+}
+
+TEST(TableHeapTest, ExternalValueTest) {
+  remove(db_file_name.c_str());
+  auto disk_mgr_ = new DiskManager(db_file_name);
+  auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  const int row_nums = 200;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("body", TypeId::kTypeChar, 4 * PAGE_SIZE, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr);
+  // a value of every fourth row is larger than a page, of the next one above the threshold, the others are short
+  auto body = [](int i) {
+    size_t len = i % 4 == 0 ? 3 * PAGE_SIZE + i : i % 4 == 1 ? EXTERNAL_THRESHOLD + i : 16;
+    return std::string(len, static_cast<char>('a' + i % 26));
+  };
+  auto is_external = [&](const RowId &rid, ExternalValue *value) {
+    auto page = reinterpret_cast<TablePage *>(bpm_->FetchPage(rid.GetPageId()));
+    RowView view;
+    bool external = page->GetTupleView(rid, schema.get(), &view) && view.IsExternal(1);
+    if (external && value != nullptr) {
+      *value = view.GetExternalValue(1);
+    }
+    bpm_->UnpinPage(rid.GetPageId(), false);
+    return external;
+  };
+  std::vector<RowId> rids;
+  for (int i = 0; i < row_nums; i++) {
+    std::string value = body(i);
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, value.data(), value.size(), true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    rids.push_back(row.GetRowId());
+  }
+
+  // Scenario: the long values are stored out of line, so that the table pages only hold the pointers to them, and
+  // the rows are read back whole.
+  ASSERT_LE(table_heap->GetPageDirectory().size(), 2);
+  for (int i = 0; i < row_nums; i++) {
+    ASSERT_EQ(i % 4 < 2, is_external(rids[i], nullptr));
+    Row row(rids[i]);
+    ASSERT_TRUE(table_heap->GetTuple(&row, nullptr));
+    ASSERT_EQ(body(i), row.GetField(1)->toString());
+  }
+  int count = 0;
+  for (auto itr = table_heap->Begin(nullptr); itr != table_heap->End(); ++itr, count++) {
+    ASSERT_EQ(body(count), itr->GetField(1)->toString());
+  }
+  ASSERT_EQ(row_nums, count);
+
+  // Scenario: a scan reading the tuples in place gets the values too.
+  count = 0;
+  auto itr = table_heap->Begin(nullptr);
+  ASSERT_FALSE(itr.SkipUntil([&](const RowView &view) {
+    EXPECT_EQ(body(count++).size(), view.GetField(1).GetLength());
+    return false;
+  }));
+  ASSERT_EQ(row_nums, count);
+
+  // Scenario: without a threshold, only the values of a row too large for a page go out of line.
+  table_heap->SetExternalThreshold(UINT32_MAX);
+  for (int i : {0, 1}) {
+    std::string value = body(i);
+    Fields fields{Field(TypeId::kTypeInt, row_nums + i), Field(TypeId::kTypeChar, value.data(), value.size(), true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    ASSERT_EQ(i == 0, is_external(row.GetRowId(), nullptr));
+  }
+
+  // Scenario: the overflow pages of a value are freed once no tuple points to it, whether it is updated in place,
+  // deleted, or dropped by a vacuum.
+  ExternalValue updated, deleted, vacuumed;
+  ASSERT_TRUE(is_external(rids[0], &updated));
+  ASSERT_TRUE(is_external(rids[4], &deleted));
+  ASSERT_TRUE(is_external(rids[5], &vacuumed));
+  Fields fields{Field(TypeId::kTypeInt, 0), Field(TypeId::kTypeChar, const_cast<char *>("short"), 5, true)};
+  Row row(fields);
+  ASSERT_TRUE(table_heap->UpdateTuple(row, rids[0], nullptr));
+  ASSERT_TRUE(bpm_->IsPageFree(updated.first_page_id_));
+  ASSERT_TRUE(table_heap->MarkDelete(rids[4], nullptr));
+  ASSERT_FALSE(bpm_->IsPageFree(deleted.first_page_id_));
+  table_heap->ApplyDelete(rids[4], nullptr);
+  ASSERT_TRUE(bpm_->IsPageFree(deleted.first_page_id_));
+  ASSERT_TRUE(table_heap->MarkDelete(rids[5], nullptr));
+  table_heap->Vacuum(nullptr);
+  ASSERT_TRUE(bpm_->IsPageFree(vacuumed.first_page_id_));
+  Row vacuumed_row(rids[8]);
+  ASSERT_TRUE(table_heap->GetTuple(&vacuumed_row, nullptr));
+  ASSERT_EQ(body(8), vacuumed_row.GetField(1)->toString());
+  ASSERT_TRUE(bpm_->CheckAllUnpinned());
+  delete table_heap;
+  delete bpm_;
+  delete disk_mgr_;
+  remove(db_file_name.c_str());
+}